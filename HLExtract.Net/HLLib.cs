@@ -27,6 +27,19 @@ public sealed class HLLib
     public const uint HL_DEFAULT_PACKAGE_TEST_BUFFER_SIZE = 8;
     public const uint HL_DEFAULT_VIEW_SIZE = 131072;
     public const uint HL_DEFAULT_COPY_BUFFER_SIZE = 131072;
+    public const uint HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE = 65536;
+    public const uint HL_DEFAULT_STREAM_MAPPING_CACHE_SIZE = 8388608;
+    public const uint HL_DEFAULT_FILE_MAPPING_WINDOW_SIZE = 67108864;
+    public const uint HL_DEFAULT_FILE_MAPPING_WINDOW_COUNT = 4;
+    public const uint HL_DEFAULT_IO_URING_DEPTH = 64;
+    public const uint HL_DEFAULT_DIRECT_IO_BUFFER_SIZE = 1048576;
+    public const uint HL_DEFAULT_DIRECT_IO_BUFFER_COUNT = 4;
+    public const uint HL_DEFAULT_BUFFERED_STREAM_READ_SIZE = 65536;
+    public const uint HL_DEFAULT_BUFFERED_STREAM_WRITE_SIZE = 65536;
+    public const uint HL_DEFAULT_GCF_STREAM_RUN_SIZE = 1048576;
+    public const uint HL_DEFAULT_INFLATE_STREAM_BUFFER_SIZE = 65536;
+    public const uint HL_DEFAULT_INFLATE_CHECKPOINT_SPACING = 1048576;
+    public const uint HL_DEFAULT_STREAM_POOL_SIZE = 64;
     #endregion
 
     #region Enumerations
@@ -61,7 +74,19 @@ public sealed class HLLib
         HL_PROC_DEFRAGMENT_PROGRESS_EX,
         HL_PROC_SEEK_EX,
         HL_PROC_TELL_EX,
-        HL_PROC_SIZE_EX
+        HL_PROC_SIZE_EX,
+        HL_STREAM_MAPPING_CACHE_SIZE,
+        HL_PACKAGE_CACHE_HITS,
+        HL_PACKAGE_CACHE_MISSES,
+        HL_MAPPING_MEMORY_BUDGET,
+        HL_MAPPING_MEMORY_USED,
+        HL_PACKAGE_EVICTIONS,
+        HL_GCF_STREAM_RUN_SIZE,
+        HL_INFLATE_CHECKPOINT_SPACING,
+        HL_PROC_READ_AT,
+        HL_PROC_READ_V,
+        HL_PROC_GET_POINTER,
+        HL_STREAM_POOL_SIZE
     }
 
     public enum HLFileMode : uint
@@ -72,7 +97,11 @@ public sealed class HLLib
         HL_MODE_CREATE = 0x04,
         HL_MODE_VOLATILE = 0x08,
         HL_MODE_NO_FILEMAPPING = 0x10,
-        HL_MODE_QUICK_FILEMAPPING = 0x20
+        HL_MODE_QUICK_FILEMAPPING = 0x20,
+        HL_MODE_ASYNC_IO = 0x40,
+        HL_MODE_PREFAULT = 0x80,
+        HL_MODE_HUGE_PAGES = 0x100,
+        HL_MODE_DIRECT_IO = 0x200
 	}
 
     public enum HLSeekMode : uint
@@ -110,6 +139,7 @@ public sealed class HLLib
         HL_FIND_MODE_STRING = 0x10,
         HL_FIND_MODE_SUBSTRING = 0x20,
         HL_FIND_MODE_WILDCARD = 0x00,
+        HL_FIND_BREADTH_FIRST = 0x40,
         HL_FIND_ALL = HL_FIND_FILES | HL_FIND_FOLDERS
     }
 
@@ -121,7 +151,9 @@ public sealed class HLLib
         HL_STREAM_MAPPING,
         HL_STREAM_MEMORY,
         HL_STREAM_PROC,
-        HL_STREAM_NULL
+        HL_STREAM_NULL,
+        HL_STREAM_BUFFERED,
+        HL_STREAM_INFLATE
     }
 
     public enum HLMappingType : uint
@@ -129,7 +161,8 @@ public sealed class HLLib
         HL_MAPPING_NONE = 0,
         HL_MAPPING_FILE,
         HL_MAPPING_MEMORY,
-        HL_MAPPING_STREAM
+        HL_MAPPING_STREAM,
+        HL_MAPPING_SUB
     }
 
     public enum HLPackageType : uint
@@ -344,6 +377,15 @@ public sealed class HLLib
             }
         }
     }
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct HLStreamSegment
+    {
+        public UInt64 uiOffset;
+        public IntPtr lpData;
+        public uint uiBytes;
+        public uint uiBytesRead;
+    }
     #endregion
 
     #region Callback Functions
@@ -375,6 +417,13 @@ public sealed class HLLib
     public delegate uint HLSizeProc(IntPtr pUserData);
     [UnmanagedFunctionPointerAttribute(CallingConvention.Cdecl)]
     public delegate ulong HLSizeExProc(IntPtr pUserData);
+    [UnmanagedFunctionPointerAttribute(CallingConvention.Cdecl)]
+    public delegate UInt64 HLReadAtProc(IntPtr lpData, UInt64 uiBytes, UInt64 uiOffset, IntPtr pUserData);
+    [UnmanagedFunctionPointerAttribute(CallingConvention.Cdecl)]
+    [return:MarshalAs(UnmanagedType.U1)]
+    public delegate bool HLReadVProc(IntPtr lpSegments, uint uiCount, IntPtr pUserData);
+    [UnmanagedFunctionPointerAttribute(CallingConvention.Cdecl)]
+    public delegate IntPtr HLGetPointerProc(IntPtr pUserData);
 
     [UnmanagedFunctionPointerAttribute(CallingConvention.Cdecl)]
     public delegate void HLExtractItemStartProc(IntPtr pItem);
@@ -664,6 +713,10 @@ public sealed class HLLib
     {
         if (IsWow64()) return x64.hlFolderFindNext(pFolder, pItem, lpSearch, eFind); else return x86.hlFolderFindNext(pFolder, pItem, lpSearch, eFind);
     }
+    public static uint hlFolderFindAll(IntPtr pFolder, string lpSearch, HLFindType eFind, IntPtr[] lpItems, uint uiItemCount)
+    {
+        if (IsWow64()) return x64.hlFolderFindAll(pFolder, lpSearch, eFind, lpItems, uiItemCount); else return x86.hlFolderFindAll(pFolder, lpSearch, eFind, lpItems, uiItemCount);
+    }
 
     public static uint hlFolderGetSize(IntPtr pItem, bool bRecurse)
     {
@@ -690,6 +743,37 @@ public sealed class HLLib
         if (IsWow64()) return x64.hlFolderGetFileCount(pItem, bRecurse); else return x86.hlFolderGetFileCount(pItem, bRecurse);
     }
 
+    //
+    // Directory Iterator
+    //
+
+    public static bool hlIteratorCreate(IntPtr pFolder, string lpSearch, HLFindType eFind, out IntPtr pIterator)
+    {
+        if (IsWow64()) return x64.hlIteratorCreate(pFolder, lpSearch, eFind, out pIterator); else return x86.hlIteratorCreate(pFolder, lpSearch, eFind, out pIterator);
+    }
+    public static void hlIteratorDelete(IntPtr pIterator)
+    {
+        if (IsWow64()) x64.hlIteratorDelete(pIterator); else x86.hlIteratorDelete(pIterator);
+    }
+
+    public static IntPtr hlIteratorGetItem(IntPtr pIterator)
+    {
+        if (IsWow64()) return x64.hlIteratorGetItem(pIterator); else return x86.hlIteratorGetItem(pIterator);
+    }
+
+    public static IntPtr hlIteratorNext(IntPtr pIterator)
+    {
+        if (IsWow64()) return x64.hlIteratorNext(pIterator); else return x86.hlIteratorNext(pIterator);
+    }
+    public static void hlIteratorSkipSubtree(IntPtr pIterator)
+    {
+        if (IsWow64()) x64.hlIteratorSkipSubtree(pIterator); else x86.hlIteratorSkipSubtree(pIterator);
+    }
+    public static void hlIteratorReset(IntPtr pIterator)
+    {
+        if (IsWow64()) x64.hlIteratorReset(pIterator); else x86.hlIteratorReset(pIterator);
+    }
+
     //
     // Directory File
     //
@@ -781,6 +865,14 @@ public sealed class HLLib
     {
         if (IsWow64()) return x64.hlStreamRead(pStream, lpData, uiBytes); else return x86.hlStreamRead(pStream, lpData, uiBytes);
     }
+    public static UInt64 hlStreamReadV(IntPtr pStream, HLStreamSegment[] lpSegments, uint uiCount)
+    {
+        if (IsWow64()) return x64.hlStreamReadV(pStream, lpSegments, uiCount); else return x86.hlStreamReadV(pStream, lpSegments, uiCount);
+    }
+    public static UInt64 hlStreamReadVAt(IntPtr pStream, UInt64 uiOffset, HLStreamSegment[] lpSegments, uint uiCount)
+    {
+        if (IsWow64()) return x64.hlStreamReadVAt(pStream, uiOffset, lpSegments, uiCount); else return x86.hlStreamReadVAt(pStream, uiOffset, lpSegments, uiCount);
+    }
 
     public static bool hlStreamWriteChar(IntPtr pStream, char iChar)
     {
@@ -860,6 +952,10 @@ public sealed class HLLib
     {
         if (IsWow64()) return x64.hlPackageOpenStream(pStream, uiMode); else return x86.hlPackageOpenStream(pStream, uiMode);
     }
+    public static bool hlPackageOpenItem(IntPtr pItem, uint uiMode)
+    {
+        if (IsWow64()) return x64.hlPackageOpenItem(pItem, uiMode); else return x86.hlPackageOpenItem(pItem, uiMode);
+    }
     public static void hlPackageClose()
     {
         if (IsWow64()) x64.hlPackageClose(); else x86.hlPackageClose();
@@ -1125,6 +1221,8 @@ public sealed class HLLib
         public static extern IntPtr hlFolderFindFirst(IntPtr pFolder, [MarshalAs(UnmanagedType.LPStr)]string lpSearch, HLFindType eFind);
         [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
         public static extern IntPtr hlFolderFindNext(IntPtr pFolder, IntPtr pItem, [MarshalAs(UnmanagedType.LPStr)]string lpSearch, HLFindType eFind);
+        [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern uint hlFolderFindAll(IntPtr pFolder, [MarshalAs(UnmanagedType.LPStr)]string lpSearch, HLFindType eFind, IntPtr[] lpItems, uint uiItemCount);
 
         [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
         public static extern uint hlFolderGetSize(IntPtr pItem, [MarshalAs(UnmanagedType.U1)]bool bRecurse);
@@ -1139,6 +1237,26 @@ public sealed class HLLib
         [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
         public static extern uint hlFolderGetFileCount(IntPtr pItem, [MarshalAs(UnmanagedType.U1)]bool bRecurse);
 
+        //
+        // Directory Iterator
+        //
+
+        [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        [return: MarshalAs(UnmanagedType.U1)]
+        public static extern bool hlIteratorCreate(IntPtr pFolder, [MarshalAs(UnmanagedType.LPStr)]string lpSearch, HLFindType eFind, out IntPtr pIterator);
+        [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern void hlIteratorDelete(IntPtr pIterator);
+
+        [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern IntPtr hlIteratorGetItem(IntPtr pIterator);
+
+        [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern IntPtr hlIteratorNext(IntPtr pIterator);
+        [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern void hlIteratorSkipSubtree(IntPtr pIterator);
+        [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern void hlIteratorReset(IntPtr pIterator);
+
         //
         // Directory File
         //
@@ -1196,6 +1314,10 @@ public sealed class HLLib
         public static extern bool hlStreamReadChar(IntPtr pStream, out char pChar);
         [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
         public static extern uint hlStreamRead(IntPtr pStream, IntPtr lpData, uint uiBytes);
+        [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern UInt64 hlStreamReadV(IntPtr pStream, [In, Out] HLStreamSegment[] lpSegments, uint uiCount);
+        [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern UInt64 hlStreamReadVAt(IntPtr pStream, UInt64 uiOffset, [In, Out] HLStreamSegment[] lpSegments, uint uiCount);
 
         [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
         [return: MarshalAs(UnmanagedType.U1)]
@@ -1248,6 +1370,9 @@ public sealed class HLLib
         [return: MarshalAs(UnmanagedType.U1)]
         public static extern bool hlPackageOpenStream(IntPtr pStream, uint uiMode);
         [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        [return: MarshalAs(UnmanagedType.U1)]
+        public static extern bool hlPackageOpenItem(IntPtr pItem, uint uiMode);
+        [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
         public static extern void hlPackageClose();
 
         [DllImport("HLLib.x86.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
@@ -1478,6 +1603,8 @@ public sealed class HLLib
         public static extern IntPtr hlFolderFindFirst(IntPtr pFolder, [MarshalAs(UnmanagedType.LPStr)]string lpSearch, HLFindType eFind);
         [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
         public static extern IntPtr hlFolderFindNext(IntPtr pFolder, IntPtr pItem, [MarshalAs(UnmanagedType.LPStr)]string lpSearch, HLFindType eFind);
+        [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern uint hlFolderFindAll(IntPtr pFolder, [MarshalAs(UnmanagedType.LPStr)]string lpSearch, HLFindType eFind, IntPtr[] lpItems, uint uiItemCount);
 
         [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
         public static extern uint hlFolderGetSize(IntPtr pItem, [MarshalAs(UnmanagedType.U1)]bool bRecurse);
@@ -1492,6 +1619,26 @@ public sealed class HLLib
         [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
         public static extern uint hlFolderGetFileCount(IntPtr pItem, [MarshalAs(UnmanagedType.U1)]bool bRecurse);
 
+        //
+        // Directory Iterator
+        //
+
+        [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        [return: MarshalAs(UnmanagedType.U1)]
+        public static extern bool hlIteratorCreate(IntPtr pFolder, [MarshalAs(UnmanagedType.LPStr)]string lpSearch, HLFindType eFind, out IntPtr pIterator);
+        [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern void hlIteratorDelete(IntPtr pIterator);
+
+        [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern IntPtr hlIteratorGetItem(IntPtr pIterator);
+
+        [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern IntPtr hlIteratorNext(IntPtr pIterator);
+        [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern void hlIteratorSkipSubtree(IntPtr pIterator);
+        [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern void hlIteratorReset(IntPtr pIterator);
+
         //
         // Directory File
         //
@@ -1549,6 +1696,10 @@ public sealed class HLLib
         public static extern bool hlStreamReadChar(IntPtr pStream, out char pChar);
         [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
         public static extern uint hlStreamRead(IntPtr pStream, IntPtr lpData, uint uiBytes);
+        [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern UInt64 hlStreamReadV(IntPtr pStream, [In, Out] HLStreamSegment[] lpSegments, uint uiCount);
+        [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern UInt64 hlStreamReadVAt(IntPtr pStream, UInt64 uiOffset, [In, Out] HLStreamSegment[] lpSegments, uint uiCount);
 
         [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
         [return: MarshalAs(UnmanagedType.U1)]
@@ -1601,6 +1752,9 @@ public sealed class HLLib
         [return: MarshalAs(UnmanagedType.U1)]
         public static extern bool hlPackageOpenStream(IntPtr pStream, uint uiMode);
         [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        [return: MarshalAs(UnmanagedType.U1)]
+        public static extern bool hlPackageOpenItem(IntPtr pItem, uint uiMode);
+        [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
         public static extern void hlPackageClose();
 
         [DllImport("HLLib.x64.dll", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
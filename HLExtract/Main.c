@@ -118,6 +118,8 @@ int main(hlInt argc, hlChar* argv[])
 	hlChar *lpConsoleCommands[MAX_ITEMS];
 	hlBool bFileMapping = hlFalse;
 	hlBool bQuickFileMapping = hlFalse;
+	hlBool bAsyncIO = hlFalse;
+	hlBool bDirectIO = hlFalse;
 	hlBool bVolatileAccess = hlFalse;
 	hlBool bOverwriteFiles = hlTrue;
 	hlBool bForceDefragment = hlFalse;
@@ -282,6 +284,14 @@ int main(hlInt argc, hlChar* argv[])
 				bFileMapping = hlTrue;
 				bQuickFileMapping = hlTrue;
 			}
+			else if(stricmp(argv[i], "-a") == 0 || stricmp(argv[i], "--async-io") == 0)
+			{
+				bAsyncIO = hlTrue;
+			}
+			else if(stricmp(argv[i], "-u") == 0 || stricmp(argv[i], "--direct-io") == 0)
+			{
+				bDirectIO = hlTrue;
+			}
 			else if(stricmp(argv[i], "-v") == 0 || stricmp(argv[i], "--volatile") == 0)
 			{
 				bVolatileAccess = hlTrue;
@@ -377,6 +387,8 @@ int main(hlInt argc, hlChar* argv[])
 	uiMode = HL_MODE_READ | (bDefragment ? HL_MODE_WRITE : 0);
 	uiMode |= !bFileMapping ? HL_MODE_NO_FILEMAPPING : 0;
 	uiMode |= bQuickFileMapping ? HL_MODE_QUICK_FILEMAPPING : 0;
+	uiMode |= bAsyncIO ? HL_MODE_ASYNC_IO : 0;
+	uiMode |= bDirectIO ? HL_MODE_DIRECT_IO : 0;
 	uiMode |= bVolatileAccess ? HL_MODE_VOLATILE : 0;
 
 	// Open the package.
@@ -387,7 +399,9 @@ int main(hlInt argc, hlChar* argv[])
 	// Windows have poor virtual memory management which means large files won't be able
 	// to find a continues block and will fail to load).  Volatile access allows HLLib
 	// to share files with other applications that have those file open for writing.
-	// This is useful for, say, loading .gcf files while Steam is running.
+	// This is useful for, say, loading .gcf files while Steam is running.  Asynchronous
+	// I/O reads through io_uring where the kernel supports it, and falls back to
+	// ordinary reads where it does not.
 	if(!hlPackageOpenFile(lpPackage, uiMode))
 	{
 		Print(FOREGROUND_RED | FOREGROUND_INTENSITY, "Error loading %s:\n%s\n", lpPackage, hlGetString(HL_ERROR_SHORT_FORMATED));
@@ -655,6 +669,8 @@ hlVoid PrintUsage()
 	printf(" -s                  (Silent mode.)\n");
 	printf(" -m                  (Use file mapping.)\n");
 	printf(" -q                  (Use quick file mapping.)\n");
+	printf(" -a                  (Use asynchronous I/O.)\n");
+	printf(" -u                  (Use direct I/O, bypassing the page cache.)\n");
 	printf(" -v                  (Allow volatile access.)\n");
 	printf(" -o                  (Don't overwrite files.)\n");
 	printf(" -r                  (Force defragmenting on all files.)\n");
@@ -983,6 +999,7 @@ hlVoid EnterConsole(hlUInt uiPackage, hlUInt uiConsoleCommands, hlChar *lpConsol
 	hlUInt uiItemCount, uiFolderCount, uiFileCount;
 	hlChar iChar;
 	HLStream *pStream = 0;
+	HLDirectoryIterator *pIterator = 0;
 	HLAttribute Attribute;
 	HLPackageType ePackageType = HL_PACKAGE_NONE;
 	hlUInt uiSubPackage = HL_ID_INVALID;
@@ -1072,10 +1089,9 @@ hlVoid EnterConsole(hlUInt uiPackage, hlUInt uiConsoleCommands, hlChar *lpConsol
 					}
 				}
 			}
-			else
+			else if(hlIteratorCreate(pItem, lpArgument, HL_FIND_ALL | HL_FIND_NO_RECURSE, &pIterator))
 			{
-				pSubItem = hlFolderFindFirst(pItem, lpArgument, HL_FIND_ALL | HL_FIND_NO_RECURSE);
-				while(pSubItem)
+				while((pSubItem = hlIteratorNext(pIterator)) != 0)
 				{
 					if(hlItemGetType(pSubItem) == HL_ITEM_FOLDER)
 					{
@@ -1087,9 +1103,9 @@ hlVoid EnterConsole(hlUInt uiPackage, hlUInt uiConsoleCommands, hlChar *lpConsol
 						uiFileCount++;
 						printf("  %s\n", hlItemGetName(pSubItem));
 					}
-
-					pSubItem = hlFolderFindNext(pItem, pSubItem, lpArgument, HL_FIND_ALL | HL_FIND_NO_RECURSE);
 				}
+				hlIteratorDelete(pIterator);
+				pIterator = 0;
 			}
 
 			printf("\n");
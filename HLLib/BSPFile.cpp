@@ -87,7 +87,7 @@ hlVoid CBSPFile::UnmapDataStructures()
 
 CDirectoryFolder *CBSPFile::CreateRoot()
 {
-	CDirectoryFolder *pRoot = new CDirectoryFolder(this);
+	CDirectoryFolder *pRoot = new CDirectoryFolder(this, &this->GetDirectoryArena());
 
 	hlChar lpFileName[256];
 
@@ -333,11 +333,11 @@ hlBool CBSPFile::CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStr
 			}
 		}
 
-		pStream = new Streams::CMemoryStream(lpBuffer, uiBufferSize);
+		pStream = this->CreateMemoryStream(lpBuffer, uiBufferSize);
 	}
 	else
 	{
-		pStream = new Streams::CMappingStream(*this->pMapping, this->pHeader->lpLumps[HL_BSP_LUMP_ENTITIES].uiOffset, this->pHeader->lpLumps[HL_BSP_LUMP_ENTITIES].uiLength - 1);
+		pStream = this->CreateMappingStream(*this->pMapping, this->pHeader->lpLumps[HL_BSP_LUMP_ENTITIES].uiOffset, this->pHeader->lpLumps[HL_BSP_LUMP_ENTITIES].uiLength - 1);
 	}
 
 	return hlTrue;
@@ -351,6 +351,17 @@ hlVoid CBSPFile::ReleaseStreamInternal(Streams::IStream &Stream) const
 	}
 }
 
+hlBool CBSPFile::MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const
+{
+	// Textures are converted to bitmaps on the fly.
+	if(pFile->GetID() < this->pTextureHeader->uiTextureCount)
+	{
+		return CPackage::MapContentsInternal(pFile, pView);
+	}
+
+	return this->pMapping->Map(pView, this->pHeader->lpLumps[HL_BSP_LUMP_ENTITIES].uiOffset, this->pHeader->lpLumps[HL_BSP_LUMP_ENTITIES].uiLength - 1);
+}
+
 hlVoid CBSPFile::GetFileName(hlChar *lpBuffer, hlUInt uiBufferSize)
 {
 	if(lpBuffer == 0 || uiBufferSize == 0)
@@ -0,0 +1,389 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#include "HLLib.h"
+#include "BufferedStream.h"
+
+using namespace HLLib;
+using namespace HLLib::Streams;
+
+CBufferedStream::CBufferedStream(IStream *pStream, hlBool bDeleteStream, hlUInt uiReadBufferSize, hlUInt uiWriteBufferSize) : pStream(pStream), bDeleteStream(bDeleteStream), uiPointer(0), lpReadBuffer(0), uiReadBufferSize(uiReadBufferSize), uiReadBufferOffset(0), uiReadBufferLength(0), lpWriteBuffer(0), uiWriteBufferSize(uiWriteBufferSize), uiWriteBufferOffset(0), uiWriteBufferLength(0)
+{
+
+}
+
+CBufferedStream::~CBufferedStream()
+{
+	this->Close();
+
+	if(this->bDeleteStream)
+	{
+		delete this->pStream;
+	}
+}
+
+HLStreamType CBufferedStream::GetType() const
+{
+	return HL_STREAM_BUFFERED;
+}
+
+const IStream &CBufferedStream::GetStream() const
+{
+	return *this->pStream;
+}
+
+const hlChar *CBufferedStream::GetFileName() const
+{
+	return this->pStream->GetFileName();
+}
+
+hlBool CBufferedStream::GetOpened() const
+{
+	return this->pStream->GetOpened();
+}
+
+hlUInt CBufferedStream::GetMode() const
+{
+	return this->pStream->GetMode();
+}
+
+hlBool CBufferedStream::Open(hlUInt uiMode)
+{
+	this->Close();
+
+	if(!this->pStream->Open(uiMode))
+	{
+		return hlFalse;
+	}
+
+	this->uiPointer = 0;
+
+	// A volatile stream can change under us, so don't read ahead.
+	if(this->uiReadBufferSize != 0 && (uiMode & HL_MODE_READ) && (uiMode & HL_MODE_VOLATILE) == 0)
+	{
+		this->lpReadBuffer = new hlByte[this->uiReadBufferSize];
+	}
+
+	if(this->uiWriteBufferSize != 0 && (uiMode & HL_MODE_WRITE))
+	{
+		this->lpWriteBuffer = new hlByte[this->uiWriteBufferSize];
+	}
+
+	return hlTrue;
+}
+
+hlVoid CBufferedStream::Close()
+{
+	if(this->pStream->GetOpened())
+	{
+		this->Flush();
+
+		this->pStream->Close();
+	}
+
+	delete []this->lpReadBuffer;
+	this->lpReadBuffer = 0;
+	this->uiReadBufferOffset = 0;
+	this->uiReadBufferLength = 0;
+
+	delete []this->lpWriteBuffer;
+	this->lpWriteBuffer = 0;
+	this->uiWriteBufferOffset = 0;
+	this->uiWriteBufferLength = 0;
+
+	this->uiPointer = 0;
+}
+
+hlULongLong CBufferedStream::GetStreamSize() const
+{
+	hlULongLong uiStreamSize = this->pStream->GetStreamSize();
+
+	// Pending writes may extend the stream.
+	if(this->uiWriteBufferLength != 0 && this->uiWriteBufferOffset + this->uiWriteBufferLength > uiStreamSize)
+	{
+		uiStreamSize = this->uiWriteBufferOffset + this->uiWriteBufferLength;
+	}
+
+	return uiStreamSize;
+}
+
+hlULongLong CBufferedStream::GetStreamPointer() const
+{
+	return this->uiPointer;
+}
+
+//
+// Seek()
+// Only moves the stream pointer; the buffers are kept and used again if the
+// pointer comes back inside them.
+//
+hlULongLong CBufferedStream::Seek(hlLongLong iOffset, HLSeekMode eSeekMode)
+{
+	if(!this->GetOpened())
+	{
+		return 0;
+	}
+
+	hlULongLong uiStreamSize = this->GetStreamSize();
+
+	switch(eSeekMode)
+	{
+		case HL_SEEK_BEGINNING:
+			this->uiPointer = 0;
+			break;
+		case HL_SEEK_CURRENT:
+
+			break;
+		case HL_SEEK_END:
+			this->uiPointer = uiStreamSize;
+			break;
+	}
+
+	hlLongLong iPointer = static_cast<hlLongLong>(this->uiPointer) + iOffset;
+
+	if(iPointer < 0)
+	{
+		iPointer = 0;
+	}
+	else if(iPointer > static_cast<hlLongLong>(uiStreamSize))
+	{
+		iPointer = static_cast<hlLongLong>(uiStreamSize);
+	}
+
+	this->uiPointer = static_cast<hlULongLong>(iPointer);
+
+	return this->uiPointer;
+}
+
+hlBool CBufferedStream::Read(hlChar &cChar)
+{
+	if(this->uiWriteBufferLength == 0 && this->uiPointer >= this->uiReadBufferOffset && this->uiPointer < this->uiReadBufferOffset + this->uiReadBufferLength)
+	{
+		cChar = static_cast<hlChar>(this->lpReadBuffer[this->uiPointer++ - this->uiReadBufferOffset]);
+		return hlTrue;
+	}
+
+	return this->Read(&cChar, 1) == 1;
+}
+
+hlUInt CBufferedStream::Read(hlVoid *lpData, hlUInt uiBytes)
+{
+	uiBytes = this->ReadBuffered(this->uiPointer, lpData, uiBytes);
+
+	this->uiPointer += static_cast<hlULongLong>(uiBytes);
+
+	return uiBytes;
+}
+
+hlBool CBufferedStream::Write(hlChar cChar)
+{
+	return this->Write(&cChar, 1) == 1;
+}
+
+hlUInt CBufferedStream::Write(const hlVoid *lpData, hlUInt uiBytes)
+{
+	uiBytes = this->WriteAt(this->uiPointer, lpData, uiBytes);
+
+	this->uiPointer += static_cast<hlULongLong>(uiBytes);
+
+	return uiBytes;
+}
+
+//
+// ReadAt()
+// Reads straight from the underlying stream, leaving the read-ahead buffer to
+// Read().  Positional readers may share the stream between threads, which the
+// buffer can't be.
+//
+hlUInt CBufferedStream::ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes)
+{
+	if(!this->GetOpened())
+	{
+		return 0;
+	}
+
+	if((this->GetMode() & HL_MODE_READ) == 0)
+	{
+		LastError.SetErrorMessage("Stream not in read mode.");
+		return 0;
+	}
+
+	if(!this->Flush())
+	{
+		return 0;
+	}
+
+	return this->pStream->ReadAt(uiOffset, lpData, uiBytes);
+}
+
+//
+// ReadBuffered()
+// Serves the read from the read-ahead buffer, refilling it as needed.  Reads
+// at least as large as the buffer go straight to the underlying stream.
+//
+hlUInt CBufferedStream::ReadBuffered(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes)
+{
+	if(!this->GetOpened())
+	{
+		return 0;
+	}
+
+	if((this->GetMode() & HL_MODE_READ) == 0)
+	{
+		LastError.SetErrorMessage("Stream not in read mode.");
+		return 0;
+	}
+
+	if(!this->Flush())
+	{
+		return 0;
+	}
+
+	if(this->lpReadBuffer == 0)
+	{
+		return this->pStream->ReadAt(uiOffset, lpData, uiBytes);
+	}
+
+	hlUInt uiBytesRead = 0;
+	hlBool bFilled = hlFalse;
+	while(uiBytesRead < uiBytes)
+	{
+		hlULongLong uiPosition = uiOffset + uiBytesRead;
+
+		if(uiPosition >= this->uiReadBufferOffset && uiPosition < this->uiReadBufferOffset + this->uiReadBufferLength)
+		{
+			hlUInt uiBufferBytes = static_cast<hlUInt>(this->uiReadBufferOffset + this->uiReadBufferLength - uiPosition);
+			if(uiBufferBytes > uiBytes - uiBytesRead)
+			{
+				uiBufferBytes = uiBytes - uiBytesRead;
+			}
+
+			memcpy(static_cast<hlByte *>(lpData) + uiBytesRead, this->lpReadBuffer + (uiPosition - this->uiReadBufferOffset), uiBufferBytes);
+			uiBytesRead += uiBufferBytes;
+
+			// A buffer that just came back short ends at the end of the stream.
+			if(bFilled && this->uiReadBufferLength < this->uiReadBufferSize)
+			{
+				break;
+			}
+		}
+		else if(uiBytes - uiBytesRead >= this->uiReadBufferSize)
+		{
+			uiBytesRead += this->pStream->ReadAt(uiPosition, static_cast<hlByte *>(lpData) + uiBytesRead, uiBytes - uiBytesRead);
+			break;
+		}
+		else if(!this->FillReadBuffer(uiPosition))
+		{
+			break;
+		}
+		else
+		{
+			bFilled = hlTrue;
+		}
+	}
+
+	return uiBytesRead;
+}
+
+//
+// WriteAt()
+// Appends the write to the write-behind buffer when it continues the pending
+// writes, otherwise flushes them first.  Writes at least as large as the buffer
+// go straight to the underlying stream.
+//
+hlUInt CBufferedStream::WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes)
+{
+	if(!this->GetOpened())
+	{
+		return 0;
+	}
+
+	if((this->GetMode() & HL_MODE_WRITE) == 0)
+	{
+		LastError.SetErrorMessage("Stream not in write mode.");
+		return 0;
+	}
+
+	// Anything read ahead over the written range is now stale.
+	if(this->uiReadBufferLength != 0 && uiOffset < this->uiReadBufferOffset + this->uiReadBufferLength && uiOffset + uiBytes > this->uiReadBufferOffset)
+	{
+		this->uiReadBufferLength = 0;
+	}
+
+	if(this->lpWriteBuffer == 0)
+	{
+		return this->pStream->WriteAt(uiOffset, lpData, uiBytes);
+	}
+
+	if(this->uiWriteBufferLength != 0 && (uiOffset != this->uiWriteBufferOffset + this->uiWriteBufferLength || uiBytes > this->uiWriteBufferSize - this->uiWriteBufferLength))
+	{
+		if(!this->Flush())
+		{
+			return 0;
+		}
+	}
+
+	if(uiBytes >= this->uiWriteBufferSize)
+	{
+		return this->pStream->WriteAt(uiOffset, lpData, uiBytes);
+	}
+
+	if(this->uiWriteBufferLength == 0)
+	{
+		this->uiWriteBufferOffset = uiOffset;
+	}
+
+	memcpy(this->lpWriteBuffer + this->uiWriteBufferLength, lpData, uiBytes);
+	this->uiWriteBufferLength += uiBytes;
+
+	return uiBytes;
+}
+
+hlBool CBufferedStream::ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount)
+{
+	if(!this->GetOpened() || !this->Flush())
+	{
+		return hlFalse;
+	}
+
+	return this->pStream->ReadBatch(lpRequests, uiCount);
+}
+
+hlVoid CBufferedStream::Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint)
+{
+	this->pStream->Advise(uiOffset, uiLength, eHint);
+}
+
+//
+// Flush()
+// Writes any pending writes out to the underlying stream.  The pending writes
+// are dropped whether or not they could be written.
+//
+hlBool CBufferedStream::Flush()
+{
+	if(this->uiWriteBufferLength == 0)
+	{
+		return hlTrue;
+	}
+
+	hlUInt uiBytes = this->uiWriteBufferLength;
+	this->uiWriteBufferLength = 0;
+
+	return this->pStream->WriteAt(this->uiWriteBufferOffset, this->lpWriteBuffer, uiBytes) == uiBytes;
+}
+
+hlBool CBufferedStream::FillReadBuffer(hlULongLong uiOffset)
+{
+	this->uiReadBufferOffset = uiOffset;
+	this->uiReadBufferLength = this->pStream->ReadAt(uiOffset, this->lpReadBuffer, this->uiReadBufferSize);
+
+	return this->uiReadBufferLength != 0;
+}
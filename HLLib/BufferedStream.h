@@ -0,0 +1,90 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#ifndef BUFFEREDSTREAM_H
+#define BUFFEREDSTREAM_H
+
+#include "stdafx.h"
+#include "Stream.h"
+
+namespace HLLib
+{
+	namespace Streams
+	{
+		//
+		// Wraps another stream so that small reads are served from a read-ahead
+		// buffer and small writes are gathered into a write-behind buffer, instead
+		// of each costing a call into the underlying stream.  A buffer size of 0
+		// disables that buffer.  ReadAt() doesn't use the read-ahead buffer, so
+		// positional reads may come from several threads.
+		//
+		class HLLIB_API CBufferedStream : public IStream
+		{
+		private:
+			IStream *pStream;
+			hlBool bDeleteStream;
+
+			hlULongLong uiPointer;
+
+			hlByte *lpReadBuffer;
+			hlUInt uiReadBufferSize;
+			hlULongLong uiReadBufferOffset;
+			hlUInt uiReadBufferLength;
+
+			hlByte *lpWriteBuffer;
+			hlUInt uiWriteBufferSize;
+			hlULongLong uiWriteBufferOffset;
+			hlUInt uiWriteBufferLength;
+
+		public:
+			CBufferedStream(IStream *pStream, hlBool bDeleteStream, hlUInt uiReadBufferSize = HL_DEFAULT_BUFFERED_STREAM_READ_SIZE, hlUInt uiWriteBufferSize = HL_DEFAULT_BUFFERED_STREAM_WRITE_SIZE);
+			~CBufferedStream();
+
+			virtual HLStreamType GetType() const;
+
+			const IStream &GetStream() const;
+			virtual const hlChar *GetFileName() const;
+
+			virtual hlBool GetOpened() const;
+			virtual hlUInt GetMode() const;
+
+			virtual hlBool Open(hlUInt uiMode);
+			virtual hlVoid Close();
+
+			virtual hlULongLong GetStreamSize() const;
+			virtual hlULongLong GetStreamPointer() const;
+
+			virtual hlULongLong Seek(hlLongLong iOffset, HLSeekMode eSeekMode);
+
+			virtual hlBool Read(hlChar &cChar);
+			virtual hlUInt Read(hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlBool Write(hlChar cChar);
+			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlUInt ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			virtual hlUInt WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlBool ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount);
+
+			virtual hlVoid Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
+			// Writes the write-behind buffer out to the underlying stream.
+			hlBool Flush();
+
+		private:
+			hlUInt ReadBuffered(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			hlBool FillReadBuffer(hlULongLong uiOffset);
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,177 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#include "HLLib.h"
+#include "DirectoryArena.h"
+
+using namespace HLLib;
+
+#define HL_FNV_OFFSET_BASIS 2166136261U
+#define HL_FNV_PRIME 16777619U
+
+CDirectoryArena::CDirectoryArena() : pBlocks(0), lpPointer(0), lpEnd(0), lpStrings(0), uiStringCount(0), uiStringTableSize(0)
+{
+
+}
+
+CDirectoryArena::~CDirectoryArena()
+{
+	this->Release();
+}
+
+//
+// Allocate()
+// Returns uiSize bytes aligned to HL_DIRECTORY_ARENA_ALIGNMENT.
+//
+hlVoid *CDirectoryArena::Allocate(hlUInt uiSize)
+{
+	uiSize = (uiSize + HL_DIRECTORY_ARENA_ALIGNMENT - 1) & ~(HL_DIRECTORY_ARENA_ALIGNMENT - 1);
+
+	if(static_cast<hlUInt>(this->lpEnd - this->lpPointer) < uiSize)
+	{
+		// Large requests get a block of their own so the current block isn't wasted.
+		if(uiSize > HL_DIRECTORY_ARENA_BLOCK_SIZE / 4)
+		{
+			return this->AllocateBlock(uiSize);
+		}
+
+		this->lpPointer = this->AllocateBlock(HL_DIRECTORY_ARENA_BLOCK_SIZE);
+		this->lpEnd = this->lpPointer + HL_DIRECTORY_ARENA_BLOCK_SIZE;
+	}
+
+	hlVoid *lpData = this->lpPointer;
+	this->lpPointer += uiSize;
+
+	return lpData;
+}
+
+//
+// CopyString()
+// Copies lpString into the arena.
+//
+const hlChar *CDirectoryArena::CopyString(const hlChar *lpString)
+{
+	return this->CopyString(lpString, (hlUInt)strlen(lpString));
+}
+
+const hlChar *CDirectoryArena::CopyString(const hlChar *lpString, hlUInt uiLength)
+{
+	// Strings don't need aligning, but they are small enough that it doesn't matter.
+	hlChar *lpCopy = static_cast<hlChar *>(this->Allocate(uiLength + 1));
+	memcpy(lpCopy, lpString, uiLength);
+	lpCopy[uiLength] = '\0';
+
+	return lpCopy;
+}
+
+//
+// InternString()
+// Returns the arena's copy of lpString, copying it in only the first time it is
+// seen.  Directory names repeat a lot (every folder has its own "materials",
+// "models", etc.) so the tree keeps one copy of each.
+//
+const hlChar *CDirectoryArena::InternString(const hlChar *lpString)
+{
+	if((this->uiStringCount + 1) * 2 > this->uiStringTableSize)
+	{
+		this->GrowStringTable();
+	}
+
+	hlUInt uiHash = HL_FNV_OFFSET_BASIS;
+	for(const hlChar *lpChar = lpString; *lpChar; lpChar++)
+	{
+		uiHash = (uiHash ^ (hlUInt)(hlByte)*lpChar) * HL_FNV_PRIME;
+	}
+
+	hlUInt uiMask = this->uiStringTableSize - 1;
+
+	hlUInt i = uiHash & uiMask;
+	while(this->lpStrings[i].lpString != 0)
+	{
+		if(this->lpStrings[i].uiHash == uiHash && strcmp(this->lpStrings[i].lpString, lpString) == 0)
+		{
+			return this->lpStrings[i].lpString;
+		}
+
+		i = (i + 1) & uiMask;
+	}
+
+	this->lpStrings[i].lpString = this->CopyString(lpString);
+	this->lpStrings[i].uiHash = uiHash;
+	this->uiStringCount++;
+
+	return this->lpStrings[i].lpString;
+}
+
+//
+// Release()
+// Frees everything allocated from the arena.
+//
+hlVoid CDirectoryArena::Release()
+{
+	delete []this->lpStrings;
+	this->lpStrings = 0;
+	this->uiStringCount = 0;
+	this->uiStringTableSize = 0;
+
+	while(this->pBlocks != 0)
+	{
+		DirectoryArenaBlock *pNext = this->pBlocks->pNext;
+		delete []reinterpret_cast<hlByte *>(this->pBlocks);
+		this->pBlocks = pNext;
+	}
+
+	this->lpPointer = 0;
+	this->lpEnd = 0;
+}
+
+hlByte *CDirectoryArena::AllocateBlock(hlUInt uiSize)
+{
+	hlUInt uiHeaderSize = (sizeof(DirectoryArenaBlock) + HL_DIRECTORY_ARENA_ALIGNMENT - 1) & ~(HL_DIRECTORY_ARENA_ALIGNMENT - 1);
+
+	DirectoryArenaBlock *pBlock = reinterpret_cast<DirectoryArenaBlock *>(new hlByte[uiHeaderSize + uiSize]);
+	pBlock->pNext = this->pBlocks;
+	pBlock->uiSize = uiSize;
+	this->pBlocks = pBlock;
+
+	return reinterpret_cast<hlByte *>(pBlock) + uiHeaderSize;
+}
+
+//
+// GrowStringTable()
+// Doubles the intern table, which is kept at most half full.
+//
+hlVoid CDirectoryArena::GrowStringTable()
+{
+	DirectoryArenaString *lpOldStrings = this->lpStrings;
+	hlUInt uiOldSize = this->uiStringTableSize;
+
+	this->uiStringTableSize = uiOldSize == 0 ? HL_DIRECTORY_ARENA_STRING_TABLE_SIZE : uiOldSize * 2;
+	this->lpStrings = new DirectoryArenaString[this->uiStringTableSize];
+	memset(this->lpStrings, 0, sizeof(DirectoryArenaString) * this->uiStringTableSize);
+
+	hlUInt uiMask = this->uiStringTableSize - 1;
+	for(hlUInt i = 0; i < uiOldSize; i++)
+	{
+		if(lpOldStrings[i].lpString != 0)
+		{
+			hlUInt j = lpOldStrings[i].uiHash & uiMask;
+			while(this->lpStrings[j].lpString != 0)
+			{
+				j = (j + 1) & uiMask;
+			}
+
+			this->lpStrings[j] = lpOldStrings[i];
+		}
+	}
+
+	delete []lpOldStrings;
+}
@@ -0,0 +1,71 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#ifndef DIRECTORYARENA_H
+#define DIRECTORYARENA_H
+
+#include "stdafx.h"
+
+#define HL_DIRECTORY_ARENA_BLOCK_SIZE 65536
+#define HL_DIRECTORY_ARENA_ALIGNMENT 8
+#define HL_DIRECTORY_ARENA_STRING_TABLE_SIZE 256
+
+namespace HLLib
+{
+	//
+	// Bump allocator for directory trees and the per-entry structures packages keep
+	// alongside them.  Memory is only returned when the arena is released, objects
+	// constructed in it must be destroyed explicitly.
+	//
+	class HLLIB_API CDirectoryArena
+	{
+	private:
+		struct DirectoryArenaBlock
+		{
+			DirectoryArenaBlock *pNext;
+			hlUInt uiSize;
+		};
+
+		struct DirectoryArenaString
+		{
+			const hlChar *lpString;
+			hlUInt uiHash;
+		};
+
+	private:
+		DirectoryArenaBlock *pBlocks;
+
+		hlByte *lpPointer;
+		hlByte *lpEnd;
+
+		DirectoryArenaString *lpStrings;
+		hlUInt uiStringCount;
+		hlUInt uiStringTableSize;
+
+	public:
+		CDirectoryArena();
+		~CDirectoryArena();
+
+		hlVoid *Allocate(hlUInt uiSize);
+
+		const hlChar *CopyString(const hlChar *lpString);
+		const hlChar *CopyString(const hlChar *lpString, hlUInt uiLength);
+		const hlChar *InternString(const hlChar *lpString);
+
+		hlVoid Release();
+
+	private:
+		hlByte *AllocateBlock(hlUInt uiSize);
+		hlVoid GrowStringTable();
+	};
+}
+
+#endif
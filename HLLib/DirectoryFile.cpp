@@ -91,6 +91,16 @@ hlVoid CDirectoryFile::ReleaseStream(Streams::IStream *pStream) const
 	return this->GetPackage()->ReleaseStream(pStream);
 }
 
+hlBool CDirectoryFile::MapContents(Mapping::CView *&pView) const
+{
+	return this->GetPackage()->MapContents(this, pView);
+}
+
+hlVoid CDirectoryFile::UnmapContents(Mapping::CView *pView) const
+{
+	return this->GetPackage()->UnmapContents(pView);
+}
+
 hlBool CDirectoryFile::Extract(const hlChar *lpPath) const
 {
 	hlExtractItemStart(this);
@@ -130,9 +140,13 @@ hlBool CDirectoryFile::Extract(const hlChar *lpPath) const
 		{
 			if(pInput->Open(HL_MODE_READ))
 			{
+				// The whole entry is about to be copied front to back.
+				pInput->Advise(0, pInput->GetStreamSize(), HL_ACCESS_HINT_SEQUENTIAL);
+
 				Streams::CFileStream Output = Streams::CFileStream(lpFileName);
 
-				if(Output.Open(HL_MODE_WRITE | HL_MODE_CREATE))
+				// Keep the output out of the page cache too if the package is read that way.
+				if(Output.Open(HL_MODE_WRITE | HL_MODE_CREATE | (this->GetPackage()->GetMapping()->GetMode() & HL_MODE_DIRECT_IO)))
 				{
 					hlUInt uiTotalBytes = 0, uiFileBytes = this->GetSize();
 					hlByte lpBuffer[HL_DEFAULT_COPY_BUFFER_SIZE];
@@ -168,6 +182,8 @@ hlBool CDirectoryFile::Extract(const hlChar *lpPath) const
 					Output.Close();
 				}
 
+				// The package is shared, so don't leave it tuned for this one pass.
+				pInput->Advise(0, pInput->GetStreamSize(), HL_ACCESS_HINT_NORMAL);
 				pInput->Close();
 			}
 
@@ -14,6 +14,7 @@
 
 #include "DirectoryItem.h"
 #include "Stream.h"
+#include "Mapping.h"
 
 namespace HLLib
 {
@@ -37,6 +38,9 @@ namespace HLLib
 		hlBool CreateStream(Streams::IStream *&pStream) const;
 		hlVoid ReleaseStream(Streams::IStream *pStream) const;
 
+		hlBool MapContents(Mapping::CView *&pView) const;
+		hlVoid UnmapContents(Mapping::CView *pView) const;
+
 		virtual hlBool Extract(const hlChar *lpPath) const;
 	};
 }
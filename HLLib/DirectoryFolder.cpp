@@ -15,28 +15,118 @@
 #include "Utility.h"
 
 #include <algorithm>
+#include <new>
+
+// Items are constructed in the arena with placement new.
+#if DEBUG_TRACK_MEMORY
+#	undef new
+#endif
 
 using namespace HLLib;
 
-CDirectoryFolder::CDirectoryFolder(CPackage *pPackage) : CDirectoryItem("root", HL_ID_INVALID, 0, pPackage, 0), pDirectoryItemVector(new CDirectoryItemVector())
+#define HL_FNV_OFFSET_BASIS 2166136261U
+#define HL_FNV_PRIME 16777619U
+
+static inline hlUInt HashCharacter(hlUInt uiHash, hlChar cChar)
 {
+	return (uiHash ^ (hlUInt)tolower((hlByte)cChar)) * HL_FNV_PRIME;
+}
 
+//
+// CompareSegment()
+// Returns true if lpName equals the uiLength characters at lpSegment.
+//
+static hlBool CompareSegment(const hlChar *lpName, const hlChar *lpSegment, hlUInt uiLength, HLFindType eFind)
+{
+	if(eFind & HL_FIND_CASE_SENSITIVE)
+	{
+		return strncmp(lpName, lpSegment, uiLength) == 0 && lpName[uiLength] == '\0';
+	}
+	else
+	{
+		return _strnicmp(lpName, lpSegment, uiLength) == 0 && lpName[uiLength] == '\0';
+	}
 }
 
-CDirectoryFolder::CDirectoryFolder(const hlChar *lpName, hlUInt uiID, hlVoid *pData, CPackage *pPackage, CDirectoryFolder *pParent) : CDirectoryItem(lpName, uiID, pData, pPackage, pParent), pDirectoryItemVector(new CDirectoryItemVector())
+//
+// GetToken()
+// Reentrant strtok(lpString, "\\/").
+//
+static hlChar *GetToken(hlChar *&lpContext)
 {
+	while(*lpContext == '\\' || *lpContext == '/')
+	{
+		lpContext++;
+	}
 
+	if(*lpContext == '\0')
+	{
+		return 0;
+	}
+
+	hlChar *lpToken = lpContext;
+	while(*lpContext != '\0' && *lpContext != '\\' && *lpContext != '/')
+	{
+		lpContext++;
+	}
+
+	if(*lpContext != '\0')
+	{
+		*lpContext++ = '\0';
+	}
+
+	return lpToken;
+}
+
+CDirectoryFolder::CDirectoryFolder(CPackage *pPackage, CDirectoryArena *pArena) : CDirectoryItem("root", HL_ID_INVALID, 0, pPackage, 0), pArena(pArena), bDeleteArena(hlFalse), lpItems(0), uiItemCount(0), uiItemCapacity(0), lpItemIndex(0), uiItemIndexSize(0), pPathIndex(0)
+{
+	if(this->pArena == 0)
+	{
+		this->pArena = new CDirectoryArena();
+		this->bDeleteArena = hlTrue;
+	}
+}
+
+//
+// Sub-folders share their parent's arena and are given names that already live
+// there.  A folder without a parent or arena creates one and copies its name in.
+//
+CDirectoryFolder::CDirectoryFolder(const hlChar *lpName, hlUInt uiID, hlVoid *pData, CPackage *pPackage, CDirectoryFolder *pParent, CDirectoryArena *pArena) : CDirectoryItem(lpName, uiID, pData, pPackage, pParent), pArena(pArena), bDeleteArena(hlFalse), lpItems(0), uiItemCount(0), uiItemCapacity(0), lpItemIndex(0), uiItemIndexSize(0), pPathIndex(0)
+{
+	if(this->pArena == 0)
+	{
+		if(pParent != 0)
+		{
+			this->pArena = pParent->pArena;
+		}
+		else
+		{
+			this->pArena = new CDirectoryArena();
+			this->bDeleteArena = hlTrue;
+		}
+	}
+
+	if(pParent == 0)
+	{
+		this->lpName = this->pArena->CopyString(lpName);
+	}
 }
 
 CDirectoryFolder::~CDirectoryFolder()
 {
-	// Delete children.
-	for(hlUInt i = 0; i < this->pDirectoryItemVector->size(); i++)
+	// Children live in the arena, so they are destroyed but not freed.
+	for(hlUInt i = 0; i < this->uiItemCount; i++)
 	{
-		delete (*this->pDirectoryItemVector)[i];
+		this->lpItems[i]->~CDirectoryItem();
 	}
 
-	delete this->pDirectoryItemVector;
+	this->ClearItemIndex();
+	this->ClearPathIndex();
+
+	if(this->bDeleteArena)
+	{
+		delete this->pArena;
+	}
 }
 
 HLDirectoryItemType CDirectoryFolder::GetType() const
@@ -44,31 +134,76 @@ HLDirectoryItemType CDirectoryFolder::GetType() const
 	return HL_ITEM_FOLDER;
 }
 
-CDirectoryFolder *CDirectoryFolder::AddFolder(const hlChar *lpName, hlUInt uiID, hlVoid *lpData)
+//
+// AddFolder()
+// Adds a folder named lpName.  If bCopyName is false lpName is used as is and
+// must live as long as the tree, e.g. a name in the package's mapped directory.
+// Otherwise the name is interned in the arena.
+//
+CDirectoryFolder *CDirectoryFolder::AddFolder(const hlChar *lpName, hlUInt uiID, hlVoid *lpData, hlBool bCopyName)
 {
-	CDirectoryFolder *pFolder = new CDirectoryFolder(lpName, uiID, lpData, this->GetPackage(), this);
+	if(bCopyName)
+	{
+		lpName = this->pArena->InternString(lpName);
+	}
+
+	CDirectoryFolder *pFolder = new(this->pArena->Allocate(sizeof(CDirectoryFolder))) CDirectoryFolder(lpName, uiID, lpData, this->GetPackage(), this, this->pArena);
 
-	this->pDirectoryItemVector->push_back(pFolder);
+	this->AddItem(pFolder);
 
 	return pFolder;
 }
 
-CDirectoryFile *CDirectoryFolder::AddFile(const hlChar *lpName, hlUInt uiID, hlVoid *lpData)
+//
+// AddFile()
+// Adds a file named lpName.  See AddFolder() for bCopyName.
+//
+CDirectoryFile *CDirectoryFolder::AddFile(const hlChar *lpName, hlUInt uiID, hlVoid *lpData, hlBool bCopyName)
 {
-	CDirectoryFile *pFile = new CDirectoryFile(lpName, uiID, lpData, this->GetPackage(), this);
+	if(bCopyName)
+	{
+		lpName = this->pArena->InternString(lpName);
+	}
+
+	CDirectoryFile *pFile = new(this->pArena->Allocate(sizeof(CDirectoryFile))) CDirectoryFile(lpName, uiID, lpData, this->GetPackage(), this);
 
-	this->pDirectoryItemVector->push_back(pFile);
+	this->AddItem(pFile);
 
 	return pFile;
 }
 
+hlVoid CDirectoryFolder::AddItem(CDirectoryItem *pItem)
+{
+	// Grow lpItems in the arena; the old array is left behind, which at most
+	// doubles the space the arrays take.
+	if(this->uiItemCount == this->uiItemCapacity)
+	{
+		this->uiItemCapacity = this->uiItemCapacity == 0 ? 4 : this->uiItemCapacity * 2;
+
+		CDirectoryItem **lpItems = static_cast<CDirectoryItem **>(this->pArena->Allocate(sizeof(CDirectoryItem *) * this->uiItemCapacity));
+		if(this->uiItemCount != 0)
+		{
+			memcpy(lpItems, this->lpItems, sizeof(CDirectoryItem *) * this->uiItemCount);
+		}
+		this->lpItems = lpItems;
+	}
+
+	this->lpItems[this->uiItemCount++] = pItem;
+	this->InsertItemIndex(this->uiItemCount - 1);
+
+	for(CDirectoryFolder *pFolder = this; pFolder != 0; pFolder = pFolder->GetParent())
+	{
+		pFolder->ClearPathIndex();
+	}
+}
+
 //
 // GetCount()
 // Returns the number of directory items in this folder.
 //
 hlUInt CDirectoryFolder::GetCount() const
 {
-	return (hlUInt)this->pDirectoryItemVector->size();
+	return this->uiItemCount;
 }
 
 //
@@ -77,22 +212,22 @@ hlUInt CDirectoryFolder::GetCount() const
 //
 CDirectoryItem *CDirectoryFolder::GetItem(hlUInt uiIndex)
 {
-	if(uiIndex >= (hlUInt)this->pDirectoryItemVector->size())
+	if(uiIndex >= this->uiItemCount)
 	{
 		return 0;
 	}
 
-	return (*this->pDirectoryItemVector)[uiIndex];
+	return this->lpItems[uiIndex];
 }
 
 const CDirectoryItem *CDirectoryFolder::GetItem(hlUInt uiIndex) const
 {
-	if(uiIndex >= (hlUInt)this->pDirectoryItemVector->size())
+	if(uiIndex >= this->uiItemCount)
 	{
 		return 0;
 	}
 
-	return (*this->pDirectoryItemVector)[uiIndex];
+	return this->lpItems[uiIndex];
 }
 
 //
@@ -107,19 +242,50 @@ CDirectoryItem *CDirectoryFolder::GetItem(const hlChar *lpName, HLFindType eFind
 
 const CDirectoryItem *CDirectoryFolder::GetItem(const hlChar *lpName, HLFindType eFind) const
 {
-	for(hlUInt i = 0; i < this->pDirectoryItemVector->size(); i++)
+	if(this->lpItemIndex == 0)
 	{
-		CDirectoryItem *pItem = (*this->pDirectoryItemVector)[i];
+		for(hlUInt i = 0; i < this->uiItemCount; i++)
+		{
+			CDirectoryItem *pItem = this->lpItems[i];
+			if((pItem->GetType() == HL_ITEM_FILE && (eFind & HL_FIND_FILES)) || (pItem->GetType() == HL_ITEM_FOLDER && (eFind & HL_FIND_FOLDERS)))
+			{
+				if(this->Compare(lpName, pItem->GetName(), eFind) == 0)
+				{
+					return pItem;
+				}
+			}
+		}
+
+		return 0;
+	}
+
+	// The hash is case folded so both find modes share the index.  Walk the whole probe
+	// chain and keep the lowest matching index so the result is the same as a linear scan.
+	hlUInt uiHash = HashName(lpName);
+	hlUInt uiMask = this->uiItemIndexSize - 1;
+
+	const CDirectoryItem *pResult = 0;
+	hlUInt uiResult = 0;
+	for(hlUInt i = uiHash & uiMask; this->lpItemIndex[i].uiItem != 0; i = (i + 1) & uiMask)
+	{
+		const DirectoryItemIndexEntry &Entry = this->lpItemIndex[i];
+		if(Entry.uiHash != uiHash || (pResult != 0 && Entry.uiItem > uiResult))
+		{
+			continue;
+		}
+
+		const CDirectoryItem *pItem = this->lpItems[Entry.uiItem - 1];
 		if((pItem->GetType() == HL_ITEM_FILE && (eFind & HL_FIND_FILES)) || (pItem->GetType() == HL_ITEM_FOLDER && (eFind & HL_FIND_FOLDERS)))
 		{
 			if(this->Compare(lpName, pItem->GetName(), eFind) == 0)
 			{
-				return pItem;
+				pResult = pItem;
+				uiResult = Entry.uiItem;
 			}
 		}
 	}
 
-	return 0;
+	return pResult;
 }
 
 //
@@ -134,22 +300,29 @@ CDirectoryItem *CDirectoryFolder::GetRelativeItem(const hlChar *lpPath, HLFindTy
 
 const CDirectoryItem *CDirectoryFolder::GetRelativeItem(const hlChar *lpPath, HLFindType eFind) const
 {
+	const CDirectoryItem *pIndexItem;
+	if(this->GetPathIndexItem(lpPath, eFind, pIndexItem))
+	{
+		return pIndexItem;
+	}
+
 	const CDirectoryFolder *pFolder = this;
 
 	hlChar *lpTemp = new hlChar[strlen(lpPath) + 1];
 	strcpy(lpTemp, lpPath);
 
-	hlChar *lpToken = strtok(lpTemp, "\\/");
+	hlChar *lpContext = lpTemp;
+	hlChar *lpToken = GetToken(lpContext);
 	if(lpToken != 0 && this->Compare(pFolder->GetName(), lpToken, eFind) == 0)
 	{
-		lpToken = strtok(0, "\\/");
+		lpToken = GetToken(lpContext);
 	}
 
 	while(lpToken != 0)
 	{
 		if(*lpToken == '\0' || strcmp(lpToken, ".") == 0)
 		{
-			lpToken = strtok(0, "\\/");
+			lpToken = GetToken(lpContext);
 		}
 		else if(strcmp(lpToken, "..") == 0)
 		{
@@ -163,29 +336,21 @@ const CDirectoryItem *CDirectoryFolder::GetRelativeItem(const hlChar *lpPath, HL
 				return 0;
 			}
 
-			lpToken = strtok(0, "\\/");
+			lpToken = GetToken(lpContext);
 		}
 		else
 		{
-			hlChar *lpNext = strtok(0, "\\/");
+			hlChar *lpNext = GetToken(lpContext);
 
-			const CDirectoryItem *pItem = 0;
-
-			for(hlUInt i = 0; i < pFolder->GetCount(); i++)
+			// Intermediate tokens can only name folders.
+			hlUInt uiFind = HL_FIND_FOLDERS | (eFind & HL_FIND_CASE_SENSITIVE);
+			if(lpNext == 0)
 			{
-				const CDirectoryItem *pTemp = pFolder->GetItem(i);
-				if(lpNext == 0 && pTemp->GetType() == HL_ITEM_FILE && (eFind & HL_FIND_FILES) && this->Compare(lpToken, pTemp->GetName(), eFind) == 0)
-				{
-					pItem = pTemp;
-					break;
-				}
-				else if(pTemp->GetType() == HL_ITEM_FOLDER && this->Compare(lpToken, pTemp->GetName(), eFind) == 0)
-				{
-					pItem = pTemp;
-					break;
-				}
+				uiFind |= eFind & HL_FIND_FILES;
 			}
 
+			const CDirectoryItem *pItem = pFolder->GetItem(lpToken, static_cast<HLFindType>(uiFind));
+
 			if(pItem == 0)
 			{
 				delete []lpTemp;
@@ -278,13 +443,21 @@ public:
 
 hlVoid CDirectoryFolder::Sort(HLSortField eField, HLSortOrder eOrder, hlBool bRecurse)
 {
-	std::sort(this->pDirectoryItemVector->begin(), this->pDirectoryItemVector->end(), CCompareDirectoryItems(eField, eOrder));
+	std::sort(this->lpItems, this->lpItems + this->uiItemCount, CCompareDirectoryItems(eField, eOrder));
+
+	// The index refers to items by position, so rebuild it here rather than from a
+	// lookup, which may run on several threads.  The path index refers to items
+	// directly and is unaffected.
+	if(this->lpItemIndex != 0)
+	{
+		this->BuildItemIndex();
+	}
 
 	if(bRecurse)
 	{
-		for(hlUInt i = 0; i < this->pDirectoryItemVector->size(); i++)
+		for(hlUInt i = 0; i < this->uiItemCount; i++)
 		{
-			CDirectoryItem *pItem = (*this->pDirectoryItemVector)[i];
+			CDirectoryItem *pItem = this->lpItems[i];
 			if(pItem->GetType() == HL_ITEM_FOLDER)
 			{
 				static_cast<CDirectoryFolder *>(pItem)->Sort(eField, eOrder, bRecurse);
@@ -293,6 +466,240 @@ hlVoid CDirectoryFolder::Sort(HLSortField eField, HLSortOrder eOrder, hlBool bRe
 	}
 }
 
+//
+// BuildPathIndex()
+// Indexes the case folded paths of all items below this folder so that
+// GetRelativeItem() can resolve them with a single hash lookup.  Adding
+// items to this folder or any of its sub-folders drops the index.
+//
+hlVoid CDirectoryFolder::BuildPathIndex()
+{
+	this->ClearPathIndex();
+
+	hlUInt uiCount = this->GetFolderCount() + this->GetFileCount();
+
+	this->pPathIndex = new DirectoryPathIndex;
+	this->pPathIndex->uiSize = 2 * HL_DIRECTORY_FOLDER_INDEX_THRESHOLD;
+	while(this->pPathIndex->uiSize < uiCount * 2)
+	{
+		this->pPathIndex->uiSize <<= 1;
+	}
+	this->pPathIndex->lpEntries = new DirectoryPathIndexEntry[this->pPathIndex->uiSize];
+	memset(this->pPathIndex->lpEntries, 0, sizeof(DirectoryPathIndexEntry) * this->pPathIndex->uiSize);
+	this->pPathIndex->bAmbiguous = hlFalse;
+
+	this->BuildPathIndex(this, HL_FNV_OFFSET_BASIS);
+}
+
+hlVoid CDirectoryFolder::BuildPathIndex(CDirectoryFolder *pFolder, hlUInt uiHash)
+{
+	hlUInt uiMask = this->pPathIndex->uiSize - 1;
+
+	if(pFolder != this)
+	{
+		uiHash = HashCharacter(uiHash, '/');
+	}
+
+	for(hlUInt i = 0; i < pFolder->GetCount(); i++)
+	{
+		CDirectoryItem *pItem = pFolder->GetItem(i);
+
+		hlUInt uiItemHash = uiHash;
+		for(const hlChar *lpName = pItem->GetName(); *lpName; lpName++)
+		{
+			uiItemHash = HashCharacter(uiItemHash, *lpName);
+		}
+
+		hlUInt j = uiItemHash & uiMask;
+		for(; this->pPathIndex->lpEntries[j].pItem != 0; j = (j + 1) & uiMask)
+		{
+			if(this->pPathIndex->lpEntries[j].uiHash != uiItemHash || this->pPathIndex->bAmbiguous)
+			{
+				continue;
+			}
+
+			// Items sharing a case folded path make the tree walk order dependent.
+			const CDirectoryItem *pTest0 = this->pPathIndex->lpEntries[j].pItem;
+			const CDirectoryItem *pTest1 = pItem;
+			while(pTest0 != this && pTest1 != this && stricmp(pTest0->GetName(), pTest1->GetName()) == 0)
+			{
+				pTest0 = pTest0->GetParent();
+				pTest1 = pTest1->GetParent();
+			}
+
+			if(pTest0 == this && pTest1 == this)
+			{
+				this->pPathIndex->bAmbiguous = hlTrue;
+			}
+		}
+
+		this->pPathIndex->lpEntries[j].uiHash = uiItemHash;
+		this->pPathIndex->lpEntries[j].pItem = pItem;
+
+		if(pItem->GetType() == HL_ITEM_FOLDER)
+		{
+			this->BuildPathIndex(static_cast<CDirectoryFolder *>(pItem), uiItemHash);
+		}
+	}
+}
+
+//
+// GetPathIndexItem()
+// Resolves lpPath through the path index without allocating.  Returns false
+// if the index can't answer and the tree has to be walked instead.
+//
+hlBool CDirectoryFolder::GetPathIndexItem(const hlChar *lpPath, HLFindType eFind, const CDirectoryItem *&pItem) const
+{
+	if(this->pPathIndex == 0 || this->pPathIndex->bAmbiguous)
+	{
+		return hlFalse;
+	}
+
+	const hlChar *lpSegments[HL_DIRECTORY_FOLDER_PATH_DEPTH];
+	hlUInt lpLengths[HL_DIRECTORY_FOLDER_PATH_DEPTH];
+	hlUInt uiSegments = 0;
+
+	hlBool bFirst = hlTrue;
+	const hlChar *lpCursor = lpPath;
+	while(hlTrue)
+	{
+		while(*lpCursor == '\\' || *lpCursor == '/')
+		{
+			lpCursor++;
+		}
+
+		if(*lpCursor == '\0')
+		{
+			break;
+		}
+
+		const hlChar *lpSegment = lpCursor;
+		while(*lpCursor != '\0' && *lpCursor != '\\' && *lpCursor != '/')
+		{
+			lpCursor++;
+		}
+		hlUInt uiLength = (hlUInt)(lpCursor - lpSegment);
+
+		// Like the tree walk, a leading segment naming this folder is skipped.
+		if(bFirst)
+		{
+			bFirst = hlFalse;
+			if(CompareSegment(this->GetName(), lpSegment, uiLength, eFind))
+			{
+				continue;
+			}
+		}
+
+		if(uiLength == 1 && lpSegment[0] == '.')
+		{
+			continue;
+		}
+
+		if(uiLength == 2 && lpSegment[0] == '.' && lpSegment[1] == '.')
+		{
+			if(uiSegments == 0)
+			{
+				if(this->GetParent() != 0)
+				{
+					return hlFalse;
+				}
+
+				pItem = 0;
+				return hlTrue;
+			}
+
+			// The tree walk fails on a missing folder before it gets to the "..".
+			if(this->GetPathIndexItem(lpSegments, lpLengths, uiSegments, static_cast<HLFindType>(HL_FIND_FOLDERS | (eFind & HL_FIND_CASE_SENSITIVE))) == 0)
+			{
+				pItem = 0;
+				return hlTrue;
+			}
+
+			uiSegments--;
+			continue;
+		}
+
+		if(uiSegments == HL_DIRECTORY_FOLDER_PATH_DEPTH)
+		{
+			return hlFalse;
+		}
+
+		lpSegments[uiSegments] = lpSegment;
+		lpLengths[uiSegments] = uiLength;
+		uiSegments++;
+	}
+
+	if(uiSegments == 0)
+	{
+		pItem = (eFind & HL_FIND_FOLDERS) ? this : 0;
+	}
+	else
+	{
+		pItem = this->GetPathIndexItem(lpSegments, lpLengths, uiSegments, eFind);
+	}
+
+	return hlTrue;
+}
+
+const CDirectoryItem *CDirectoryFolder::GetPathIndexItem(const hlChar **lpSegments, const hlUInt *lpLengths, hlUInt uiSegments, HLFindType eFind) const
+{
+	hlUInt uiHash = HL_FNV_OFFSET_BASIS;
+	for(hlUInt i = 0; i < uiSegments; i++)
+	{
+		if(i != 0)
+		{
+			uiHash = HashCharacter(uiHash, '/');
+		}
+
+		for(hlUInt j = 0; j < lpLengths[i]; j++)
+		{
+			uiHash = HashCharacter(uiHash, lpSegments[i][j]);
+		}
+	}
+
+	hlUInt uiMask = this->pPathIndex->uiSize - 1;
+	for(hlUInt i = uiHash & uiMask; this->pPathIndex->lpEntries[i].pItem != 0; i = (i + 1) & uiMask)
+	{
+		const DirectoryPathIndexEntry &Entry = this->pPathIndex->lpEntries[i];
+		if(Entry.uiHash != uiHash)
+		{
+			continue;
+		}
+
+		const CDirectoryItem *pItem = Entry.pItem;
+		if(!((pItem->GetType() == HL_ITEM_FILE && (eFind & HL_FIND_FILES)) || (pItem->GetType() == HL_ITEM_FOLDER && (eFind & HL_FIND_FOLDERS))))
+		{
+			continue;
+		}
+
+		// Paths are unique once case folded, so the first verified item is the only one.
+		const CDirectoryItem *pTest = pItem;
+		hlUInt uiSegment = uiSegments;
+		while(uiSegment > 0 && pTest != this && CompareSegment(pTest->GetName(), lpSegments[uiSegment - 1], lpLengths[uiSegment - 1], eFind))
+		{
+			pTest = pTest->GetParent();
+			uiSegment--;
+		}
+
+		if(uiSegment == 0 && pTest == this)
+		{
+			return pItem;
+		}
+	}
+
+	return 0;
+}
+
+hlVoid CDirectoryFolder::ClearPathIndex()
+{
+	if(this->pPathIndex != 0)
+	{
+		delete []this->pPathIndex->lpEntries;
+		delete this->pPathIndex;
+		this->pPathIndex = 0;
+	}
+}
+
 CDirectoryItem *CDirectoryFolder::FindFirst(const hlChar *lpSearch, HLFindType eFind)
 {
 	return const_cast<CDirectoryItem *>(const_cast<const CDirectoryFolder*>(this)->FindFirst(lpSearch, eFind));
@@ -300,7 +707,9 @@ CDirectoryItem *CDirectoryFolder::FindFirst(const hlChar *lpSearch, HLFindType e
 
 const CDirectoryItem *CDirectoryFolder::FindFirst(const hlChar *lpSearch, HLFindType eFind) const
 {
-	return this->FindNext(this, 0, lpSearch, eFind);
+	CSearchPattern Pattern(lpSearch, eFind);
+
+	return this->FindNext(this, 0, Pattern, eFind);
 }
 
 CDirectoryItem *CDirectoryFolder::FindNext(const CDirectoryItem *pItem, const hlChar *lpSearch, HLFindType eFind)
@@ -315,17 +724,23 @@ const CDirectoryItem *CDirectoryFolder::FindNext(const CDirectoryItem *pItem, co
 		return 0;
 	}
 
+	CSearchPattern Pattern(lpSearch, eFind);
+
 	if(pItem->GetType() == HL_ITEM_FOLDER && !(eFind & HL_FIND_NO_RECURSE))
 	{
-		return this->FindNext(static_cast<const CDirectoryFolder *>(pItem), 0, lpSearch, eFind);
-	}
-	else
-	{
-		return this->FindNext(pItem->GetParent(), pItem, lpSearch, eFind);
+		const CDirectoryItem *pNext = this->FindNext(static_cast<const CDirectoryFolder *>(pItem), 0, Pattern, eFind);
+
+		// Nothing below pItem matches, carry on after it.
+		if(pNext != 0 || pItem == this)
+		{
+			return pNext;
+		}
 	}
+
+	return this->FindNext(pItem->GetParent(), pItem, Pattern, eFind);
 }
 
-const CDirectoryItem *CDirectoryFolder::FindNext(const CDirectoryFolder *pFolder, const CDirectoryItem *pRelative, const hlChar *lpSearch, HLFindType eFind) const
+const CDirectoryItem *CDirectoryFolder::FindNext(const CDirectoryFolder *pFolder, const CDirectoryItem *pRelative, const CSearchPattern &Pattern, HLFindType eFind) const
 {
 	hlUInt uiFirst = 0;
 
@@ -346,7 +761,7 @@ const CDirectoryItem *CDirectoryFolder::FindNext(const CDirectoryFolder *pFolder
 		const CDirectoryItem *pTest = pFolder->GetItem(i);
 		if((pTest->GetType() == HL_ITEM_FILE && (eFind & HL_FIND_FILES)) || (pTest->GetType() == HL_ITEM_FOLDER && (eFind & HL_FIND_FOLDERS)))
 		{
-			if(this->Match(pTest->GetName(), lpSearch, eFind))
+			if(Pattern.Match(pTest->GetName()))
 			{
 				return pTest;
 			}
@@ -354,7 +769,7 @@ const CDirectoryItem *CDirectoryFolder::FindNext(const CDirectoryFolder *pFolder
 
 		if(pTest->GetType() == HL_ITEM_FOLDER && !(eFind & HL_FIND_NO_RECURSE))
 		{
-			pTest = this->FindNext(static_cast<const CDirectoryFolder *>(pTest), 0, lpSearch, eFind);
+			pTest = this->FindNext(static_cast<const CDirectoryFolder *>(pTest), 0, Pattern, eFind);
 
 			if(pTest != 0)
 			{
@@ -368,134 +783,147 @@ const CDirectoryItem *CDirectoryFolder::FindNext(const CDirectoryFolder *pFolder
 		return 0;
 	}
 
-	return this->FindNext(pFolder->GetParent(), pFolder, lpSearch, eFind);
+	return this->FindNext(pFolder->GetParent(), pFolder, Pattern, eFind);
 }
 
-hlInt CDirectoryFolder::Compare(const hlChar *lpString0, const hlChar *lpString1, HLFindType eFind) const
+//
+// BuildItemIndex()
+// Builds an open addressing hash table over the names of this folder's items.
+// The table is kept at most half full.
+//
+hlVoid CDirectoryFolder::BuildItemIndex()
 {
-	if(eFind & HL_FIND_CASE_SENSITIVE)
+	this->ClearItemIndex();
+
+	hlUInt uiCount = this->uiItemCount;
+
+	this->uiItemIndexSize = 2 * HL_DIRECTORY_FOLDER_INDEX_THRESHOLD;
+	while(this->uiItemIndexSize < uiCount * 2)
 	{
-		return strcmp(lpString0, lpString1);
+		this->uiItemIndexSize <<= 1;
 	}
-	else
+
+	this->lpItemIndex = new DirectoryItemIndexEntry[this->uiItemIndexSize];
+	memset(this->lpItemIndex, 0, sizeof(DirectoryItemIndexEntry) * this->uiItemIndexSize);
+
+	for(hlUInt i = 0; i < uiCount; i++)
 	{
-		return stricmp(lpString0, lpString1);
+		this->InsertItemIndex(i);
 	}
 }
 
 //
-// Match a string to a seach string.  Search string can contain wild cards like * (to match
-// a substring) and ? (to match a letter).
+// InsertItemIndex()
+// Adds the item at position uiItem to the index, building the index once the
+// folder reaches HL_DIRECTORY_FOLDER_INDEX_THRESHOLD items.  The index is only
+// changed as items are added so lookups never write to the folder.
 //
-hlBool CDirectoryFolder::Match(const hlChar *lpString, const hlChar *lpSearch, HLFindType eFind) const
+hlVoid CDirectoryFolder::InsertItemIndex(hlUInt uiItem)
 {
-	if(eFind & HL_FIND_MODE_STRING)
+	if(this->lpItemIndex == 0)
+	{
+		if(uiItem + 1 >= HL_DIRECTORY_FOLDER_INDEX_THRESHOLD)
+		{
+			this->BuildItemIndex();
+		}
+		return;
+	}
+
+	if((uiItem + 1) * 2 > this->uiItemIndexSize)
+	{
+		this->BuildItemIndex();
+		return;
+	}
+
+	hlUInt uiHash = HashName(this->lpItems[uiItem]->GetName());
+	hlUInt uiMask = this->uiItemIndexSize - 1;
+
+	hlUInt i = uiHash & uiMask;
+	while(this->lpItemIndex[i].uiItem != 0)
 	{
-		return this->Compare(lpString, lpSearch, eFind);
+		i = (i + 1) & uiMask;
 	}
-	else if(eFind & HL_FIND_MODE_SUBSTRING)
+
+	this->lpItemIndex[i].uiHash = uiHash;
+	this->lpItemIndex[i].uiItem = uiItem + 1;
+}
+
+hlVoid CDirectoryFolder::ClearItemIndex()
+{
+	delete []this->lpItemIndex;
+	this->lpItemIndex = 0;
+	this->uiItemIndexSize = 0;
+}
+
+//
+// HashName()
+// FNV-1a hash of lpName folded to lower case.
+//
+hlUInt CDirectoryFolder::HashName(const hlChar *lpName)
+{
+	hlUInt uiHash = HL_FNV_OFFSET_BASIS;
+	while(*lpName)
 	{
-		hlInt iStringLength = (hlInt)strlen(lpString);
-		hlInt iSearchLength = (hlInt)strlen(lpSearch);
-		hlInt iTests = iStringLength - iSearchLength;
+		uiHash = HashCharacter(uiHash, *lpName++);
+	}
+
+	return uiHash;
+}
+
+//
+// FindAll()
+// Stores the items below this folder that match lpSearch in lpItems, in the
+// order FindFirst() and FindNext() return them, and returns how many there
+// are.  Only the first uiItemCount are stored.
+//
+hlUInt CDirectoryFolder::FindAll(const hlChar *lpSearch, CDirectoryItem **lpItems, hlUInt uiItemCount, HLFindType eFind)
+{
+	return const_cast<const CDirectoryFolder*>(this)->FindAll(lpSearch, const_cast<const CDirectoryItem **>(lpItems), uiItemCount, eFind);
+}
+
+hlUInt CDirectoryFolder::FindAll(const hlChar *lpSearch, const CDirectoryItem **lpItems, hlUInt uiItemCount, HLFindType eFind) const
+{
+	CSearchPattern Pattern(lpSearch, eFind);
 
-		if(eFind & HL_FIND_CASE_SENSITIVE)
+	hlUInt uiCount = 0;
+	this->FindAll(Pattern, eFind, lpItems, uiItemCount, uiCount);
+
+	return uiCount;
+}
+
+hlVoid CDirectoryFolder::FindAll(const CSearchPattern &Pattern, HLFindType eFind, const CDirectoryItem **lpItems, hlUInt uiItemCount, hlUInt &uiCount) const
+{
+	for(hlUInt i = 0; i < this->uiItemCount; i++)
+	{
+		const CDirectoryItem *pItem = this->lpItems[i];
+		if((pItem->GetType() == HL_ITEM_FILE && (eFind & HL_FIND_FILES)) || (pItem->GetType() == HL_ITEM_FOLDER && (eFind & HL_FIND_FOLDERS)))
 		{
-			for(hlInt i = 0; i <= iTests; i++)
+			if(Pattern.Match(pItem->GetName()))
 			{
-				if(strncmp(lpString + i, lpSearch, iSearchLength) == 0)
+				if(uiCount < uiItemCount)
 				{
-					return hlTrue;
+					lpItems[uiCount] = pItem;
 				}
+				uiCount++;
 			}
 		}
-		else
+
+		if(pItem->GetType() == HL_ITEM_FOLDER && !(eFind & HL_FIND_NO_RECURSE))
 		{
-			for(hlInt i = 0; i <= iTests; i++)
-			{
-				if(_strnicmp(lpString + i, lpSearch, iSearchLength) == 0)
-				{
-					return hlTrue;
-				}
-			}
+			static_cast<const CDirectoryFolder *>(pItem)->FindAll(Pattern, eFind, lpItems, uiItemCount, uiCount);
 		}
+	}
+}
 
-		return hlFalse;
+hlInt CDirectoryFolder::Compare(const hlChar *lpString0, const hlChar *lpString1, HLFindType eFind) const
+{
+	if(eFind & HL_FIND_CASE_SENSITIVE)
+	{
+		return strcmp(lpString0, lpString1);
 	}
-	else /*if(eFind & HL_FIND_MODE_WILDCARD)*/
+	else
 	{
-		while(*lpSearch)
-		{
-			if(*lpSearch == '*')
-			{
-				if(lpSearch[1] == '*')
-				{
-					lpSearch++;
-					continue;
-				}
-				else if(lpSearch[1] == '\0')
-				{
-					return hlTrue;
-				}
-				else
-				{
-					lpSearch++;
-					while(*lpString)
-					{
-						if(this->Match(lpString, lpSearch, eFind))
-						{
-							return hlTrue;
-						}
-						lpString++;
-					}
-
-					return hlFalse;
-				}
-			}
-			else if(*lpSearch == '?')
-			{
-				if(*lpString == '\0')
-				{
-					return hlFalse;
-				}
-				lpSearch++;
-				lpString++;
-			}
-			else
-			{
-				if(*lpString == '\0')
-				{
-					return hlFalse;
-				}
-				else
-				{
-					hlChar iA = *lpSearch;
-					hlChar iB = *lpString;
-
-					if((eFind & HL_FIND_CASE_SENSITIVE) == 0)
-					{
-						if(iA >= 'a' && iA <= 'z')
-						{
-							iA -= 'a' - 'A';
-						}
-
-						if(iB >= 'a' && iB <= 'z')
-						{
-							iB -= 'a' - 'A';
-						}
-					}
-
-					if(iA != iB)
-					{
-						return hlFalse;
-					}
-				}
-				lpSearch++;
-				lpString++;
-			}
-		}
-
-		return *lpString == '\0';
+		return stricmp(lpString0, lpString1);
 	}
 }
 
@@ -503,9 +931,9 @@ hlUInt CDirectoryFolder::GetSize(hlBool bRecurse) const
 {
 	hlUInt uiSize = 0;
 
-	for(hlUInt i = 0; i < this->pDirectoryItemVector->size(); i++)
+	for(hlUInt i = 0; i < this->uiItemCount; i++)
 	{
-		const CDirectoryItem *pItem = (*this->pDirectoryItemVector)[i];
+		const CDirectoryItem *pItem = this->lpItems[i];
 		switch(pItem->GetType())
 		{
 		case HL_ITEM_FOLDER:
@@ -529,9 +957,9 @@ hlULongLong CDirectoryFolder::GetSizeEx(hlBool bRecurse) const
 {
 	hlULongLong uiSize = 0;
 
-	for(hlUInt i = 0; i < this->pDirectoryItemVector->size(); i++)
+	for(hlUInt i = 0; i < this->uiItemCount; i++)
 	{
-		const CDirectoryItem *pItem = (*this->pDirectoryItemVector)[i];
+		const CDirectoryItem *pItem = this->lpItems[i];
 		switch(pItem->GetType())
 		{
 		case HL_ITEM_FOLDER:
@@ -555,9 +983,9 @@ hlUInt CDirectoryFolder::GetSizeOnDisk(hlBool bRecurse) const
 {
 	hlUInt uiSize = 0;
 
-	for(hlUInt i = 0; i < this->pDirectoryItemVector->size(); i++)
+	for(hlUInt i = 0; i < this->uiItemCount; i++)
 	{
-		const CDirectoryItem *pItem = (*this->pDirectoryItemVector)[i];
+		const CDirectoryItem *pItem = this->lpItems[i];
 		switch(pItem->GetType())
 		{
 		case HL_ITEM_FOLDER:
@@ -581,9 +1009,9 @@ hlULongLong CDirectoryFolder::GetSizeOnDiskEx(hlBool bRecurse) const
 {
 	hlULongLong uiSize = 0;
 
-	for(hlUInt i = 0; i < this->pDirectoryItemVector->size(); i++)
+	for(hlUInt i = 0; i < this->uiItemCount; i++)
 	{
-		const CDirectoryItem *pItem = (*this->pDirectoryItemVector)[i];
+		const CDirectoryItem *pItem = this->lpItems[i];
 		switch(pItem->GetType())
 		{
 		case HL_ITEM_FOLDER:
@@ -607,9 +1035,9 @@ hlUInt CDirectoryFolder::GetFolderCount(hlBool bRecurse) const
 {
 	hlUInt uiCount = 0;
 
-	for(hlUInt i = 0; i < this->pDirectoryItemVector->size(); i++)
+	for(hlUInt i = 0; i < this->uiItemCount; i++)
 	{
-		const CDirectoryItem *pItem = (*this->pDirectoryItemVector)[i];
+		const CDirectoryItem *pItem = this->lpItems[i];
 		switch(pItem->GetType())
 		{
 		case HL_ITEM_FOLDER:
@@ -631,9 +1059,9 @@ hlUInt CDirectoryFolder::GetFileCount(hlBool bRecurse) const
 {
 	hlUInt uiCount = 0;
 
-	for(hlUInt i = 0; i < this->pDirectoryItemVector->size(); i++)
+	for(hlUInt i = 0; i < this->uiItemCount; i++)
 	{
-		const CDirectoryItem *pItem = (*this->pDirectoryItemVector)[i];
+		const CDirectoryItem *pItem = this->lpItems[i];
 		switch(pItem->GetType())
 		{
 		case HL_ITEM_FOLDER:
@@ -688,9 +1116,9 @@ hlBool CDirectoryFolder::Extract(const hlChar *lpPath) const
 	{
 		bResult = hlTrue;
 
-		for(hlUInt i = 0; i < this->pDirectoryItemVector->size(); i++)
+		for(hlUInt i = 0; i < this->uiItemCount; i++)
 		{
-			const CDirectoryItem *pItem = (*this->pDirectoryItemVector)[i];
+			const CDirectoryItem *pItem = this->lpItems[i];
 			if(pItem->GetType() != HL_ITEM_FILE || static_cast<const CDirectoryFile *>(pItem)->GetExtractable())
 			{
 				bResult &= pItem->Extract(lpFolderName);
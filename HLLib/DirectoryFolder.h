@@ -14,28 +14,62 @@
 
 #include "DirectoryItem.h"
 #include "DirectoryFile.h"
+#include "DirectoryArena.h"
+#include "SearchPattern.h"
 
-#include <vector>
+// Folders with at least this many items get a name hash index on first lookup.
+#define HL_DIRECTORY_FOLDER_INDEX_THRESHOLD 16
+
+// Paths with more segments than this are resolved by walking the tree.
+#define HL_DIRECTORY_FOLDER_PATH_DEPTH 64
 
 namespace HLLib
 {
 	class HLLIB_API CDirectoryFolder : public CDirectoryItem
 	{
 	private:
-		typedef std::vector<CDirectoryItem *> CDirectoryItemVector;
+		struct DirectoryItemIndexEntry
+		{
+			hlUInt uiHash;
+			hlUInt uiItem;	// Index into lpItems plus one, zero if the entry is unused.
+		};
+
+		struct DirectoryPathIndexEntry
+		{
+			hlUInt uiHash;
+			CDirectoryItem *pItem;
+		};
+
+		struct DirectoryPathIndex
+		{
+			DirectoryPathIndexEntry *lpEntries;
+			hlUInt uiSize;
+			hlBool bAmbiguous;	// Two items share a case folded path; lookups walk the tree.
+		};
 
 	private:
-		CDirectoryItemVector *pDirectoryItemVector;
+		// Children, their names and lpItems itself are allocated from pArena.
+		CDirectoryArena *pArena;
+		hlBool bDeleteArena;
+
+		CDirectoryItem **lpItems;
+		hlUInt uiItemCount;
+		hlUInt uiItemCapacity;
+
+		DirectoryItemIndexEntry *lpItemIndex;
+		hlUInt uiItemIndexSize;
+
+		DirectoryPathIndex *pPathIndex;
 
 	public:
-		CDirectoryFolder(CPackage *pPackage);
-		CDirectoryFolder(const hlChar *lpName, hlUInt uiID, hlVoid *pData, CPackage *pPackage, CDirectoryFolder *pParent);
+		CDirectoryFolder(CPackage *pPackage, CDirectoryArena *pArena = 0);
+		CDirectoryFolder(const hlChar *lpName, hlUInt uiID, hlVoid *pData, CPackage *pPackage, CDirectoryFolder *pParent, CDirectoryArena *pArena = 0);
 		virtual ~CDirectoryFolder();
 
 		virtual HLDirectoryItemType GetType() const;
 
-		CDirectoryFolder *AddFolder(const hlChar *lpName, hlUInt uiID = HL_ID_INVALID, hlVoid *lpData = 0);
-		CDirectoryFile *AddFile(const hlChar *lpName, hlUInt uiID = HL_ID_INVALID, hlVoid *lpData = 0);
+		CDirectoryFolder *AddFolder(const hlChar *lpName, hlUInt uiID = HL_ID_INVALID, hlVoid *lpData = 0, hlBool bCopyName = hlTrue);
+		CDirectoryFile *AddFile(const hlChar *lpName, hlUInt uiID = HL_ID_INVALID, hlVoid *lpData = 0, hlBool bCopyName = hlTrue);
 
 		hlUInt GetCount() const;
 		CDirectoryItem *GetItem(hlUInt uiIndex);
@@ -47,10 +81,14 @@ namespace HLLib
 
 		hlVoid Sort(HLSortField eField = HL_FIELD_NAME, HLSortOrder eOrder = HL_ORDER_ASCENDING, hlBool bRecurse = hlTrue);
 
+		hlVoid BuildPathIndex();
+
 		CDirectoryItem *FindFirst(const hlChar *lpSearch, HLFindType eFind = HL_FIND_ALL);
 		const CDirectoryItem *FindFirst(const hlChar *lpSearch, HLFindType eFind = HL_FIND_ALL) const;
 		CDirectoryItem *FindNext(const CDirectoryItem *pItem, const hlChar *lpSearch, HLFindType eFind = HL_FIND_ALL);
 		const CDirectoryItem *FindNext(const CDirectoryItem *pItem, const hlChar *lpSearch, HLFindType eFind = HL_FIND_ALL) const;
+		hlUInt FindAll(const hlChar *lpSearch, CDirectoryItem **lpItems, hlUInt uiItemCount, HLFindType eFind = HL_FIND_ALL);
+		hlUInt FindAll(const hlChar *lpSearch, const CDirectoryItem **lpItems, hlUInt uiItemCount, HLFindType eFind = HL_FIND_ALL) const;
 
 		hlUInt GetSize(hlBool bRecurse = hlTrue) const;
 		hlULongLong GetSizeEx(hlBool bRecurse = hlTrue) const;
@@ -63,8 +101,21 @@ namespace HLLib
 
 	private:
 		hlInt Compare(const hlChar *lpString0, const hlChar *lpString1, HLFindType eFind) const;
-		hlBool Match(const hlChar *lpString, const hlChar *lpSearch, HLFindType eFind) const;
-		const CDirectoryItem *FindNext(const CDirectoryFolder *pFolder, const CDirectoryItem *pRelative, const hlChar *lpSearch, HLFindType eFind = HL_FIND_ALL) const;
+
+		hlVoid AddItem(CDirectoryItem *pItem);
+
+		const CDirectoryItem *FindNext(const CDirectoryFolder *pFolder, const CDirectoryItem *pRelative, const CSearchPattern &Pattern, HLFindType eFind) const;
+		hlVoid FindAll(const CSearchPattern &Pattern, HLFindType eFind, const CDirectoryItem **lpItems, hlUInt uiItemCount, hlUInt &uiCount) const;
+
+		hlVoid BuildItemIndex();
+		hlVoid InsertItemIndex(hlUInt uiItem);
+		hlVoid ClearItemIndex();
+		static hlUInt HashName(const hlChar *lpName);
+
+		hlVoid BuildPathIndex(CDirectoryFolder *pFolder, hlUInt uiHash);
+		hlBool GetPathIndexItem(const hlChar *lpPath, HLFindType eFind, const CDirectoryItem *&pItem) const;
+		const CDirectoryItem *GetPathIndexItem(const hlChar **lpSegments, const hlUInt *lpLengths, hlUInt uiSegments, HLFindType eFind) const;
+		hlVoid ClearPathIndex();
 	};
 }
 
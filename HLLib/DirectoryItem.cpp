@@ -15,15 +15,18 @@
 
 using namespace HLLib;
 
-CDirectoryItem::CDirectoryItem(const hlChar *lpName, hlUInt uiID, hlVoid *pData, CPackage *pPackage, CDirectoryFolder *pParent) : uiID(uiID), pData(pData), pPackage(pPackage), pParent(pParent)
+//
+// lpName is not copied, it has to live as long as the item.  CDirectoryFolder
+// keeps the names of the items it creates in its arena.
+//
+CDirectoryItem::CDirectoryItem(const hlChar *lpName, hlUInt uiID, hlVoid *pData, CPackage *pPackage, CDirectoryFolder *pParent) : lpName(lpName), uiID(uiID), pData(pData), pPackage(pPackage), pParent(pParent)
 {
-	this->lpName = new hlChar[strlen(lpName) + 1];
-	strcpy(this->lpName, lpName);
+
 }
 
 CDirectoryItem::~CDirectoryItem()
 {
-	delete []this->lpName;
+
 }
 
 //
@@ -21,8 +21,10 @@ namespace HLLib
 
 	class HLLIB_API CDirectoryItem
 	{
+		friend class CDirectoryFolder;
+
 	private:
-		hlChar *lpName;
+		const hlChar *lpName;
 		hlUInt uiID;
 		hlVoid *pData;
 		CPackage *pPackage;
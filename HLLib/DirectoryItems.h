@@ -9,6 +9,8 @@
  * version.
  */
 
+#include "DirectoryArena.h"
 #include "DirectoryItem.h"
 #include "DirectoryFile.h"
 #include "DirectoryFolder.h"
+#include "DirectoryIterator.h"
@@ -0,0 +1,143 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#include "HLLib.h"
+#include "DirectoryIterator.h"
+
+using namespace HLLib;
+
+CDirectoryIterator::CDirectoryIterator(const CDirectoryFolder *pFolder, const hlChar *lpSearch, HLFindType eFind) : pFolder(pFolder), eFind(eFind), pPattern(0), uiFrame(0), pItem(0), pDescend(0)
+{
+	if(lpSearch != 0)
+	{
+		this->pPattern = new CSearchPattern(lpSearch, eFind);
+	}
+
+	this->Reset();
+}
+
+CDirectoryIterator::~CDirectoryIterator()
+{
+	delete this->pPattern;
+}
+
+const CDirectoryFolder *CDirectoryIterator::GetFolder() const
+{
+	return this->pFolder;
+}
+
+//
+// GetItem()
+// Returns the item the last call to Next() returned.
+//
+const CDirectoryItem *CDirectoryIterator::GetItem() const
+{
+	return this->pItem;
+}
+
+//
+// Next()
+// Returns the next matching item, or null once every item has been visited.
+//
+const CDirectoryItem *CDirectoryIterator::Next()
+{
+	if(this->pDescend != 0)
+	{
+		this->Push(this->pDescend);
+		this->pDescend = 0;
+	}
+
+	hlBool bBreadthFirst = (this->eFind & HL_FIND_BREADTH_FIRST) != 0;
+	hlBool bRecurse = (this->eFind & HL_FIND_NO_RECURSE) == 0;
+
+	while(this->uiFrame < this->Frames.size())
+	{
+		DirectoryIteratorFrame &Frame = bBreadthFirst ? this->Frames[this->uiFrame] : this->Frames.back();
+
+		if(Frame.uiItem == Frame.pFolder->GetCount())
+		{
+			if(bBreadthFirst)
+			{
+				this->uiFrame++;
+			}
+			else
+			{
+				this->Frames.pop_back();
+			}
+			continue;
+		}
+
+		// Frame is invalid once a folder is pushed.
+		const CDirectoryItem *pTest = Frame.pFolder->GetItem(Frame.uiItem++);
+		const CDirectoryFolder *pSubFolder = pTest->GetType() == HL_ITEM_FOLDER && bRecurse ? static_cast<const CDirectoryFolder *>(pTest) : 0;
+
+		if((pTest->GetType() == HL_ITEM_FILE && (this->eFind & HL_FIND_FILES)) || (pTest->GetType() == HL_ITEM_FOLDER && (this->eFind & HL_FIND_FOLDERS)))
+		{
+			if(this->pPattern == 0 || this->pPattern->Match(pTest->GetName()))
+			{
+				// Enter the folder on the next call so SkipSubtree() can still cancel it.
+				this->pDescend = pSubFolder;
+				this->pItem = pTest;
+				return pTest;
+			}
+		}
+
+		if(pSubFolder != 0)
+		{
+			this->Push(pSubFolder);
+		}
+	}
+
+	this->Frames.clear();
+	this->uiFrame = 0;
+
+	this->pItem = 0;
+	return 0;
+}
+
+//
+// SkipSubtree()
+// Stops the next call to Next() from entering the folder the last call returned.
+//
+hlVoid CDirectoryIterator::SkipSubtree()
+{
+	this->pDescend = 0;
+}
+
+//
+// Reset()
+// Starts over from the first item.
+//
+hlVoid CDirectoryIterator::Reset()
+{
+	this->Frames.clear();
+	this->uiFrame = 0;
+
+	this->pItem = 0;
+	this->pDescend = 0;
+
+	this->Push(this->pFolder);
+}
+
+hlVoid CDirectoryIterator::Push(const CDirectoryFolder *pFolder)
+{
+	if(this->uiFrame > 0 && this->uiFrame == this->Frames.size())
+	{
+		this->Frames.clear();
+		this->uiFrame = 0;
+	}
+
+	DirectoryIteratorFrame Frame;
+	Frame.pFolder = pFolder;
+	Frame.uiItem = 0;
+
+	this->Frames.push_back(Frame);
+}
@@ -0,0 +1,70 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#ifndef DIRECTORYITERATOR_H
+#define DIRECTORYITERATOR_H
+
+#include "stdafx.h"
+#include "DirectoryFolder.h"
+#include "SearchPattern.h"
+
+namespace HLLib
+{
+	//
+	// Walks the items below a folder, returning the same items as FindFirst() and
+	// FindNext() but keeping its place between calls.  Depth first walks return
+	// items in FindNext() order, breadth first walks (HL_FIND_BREADTH_FIRST) return
+	// each level before the next.  The folder must not change while iterating.
+	//
+	class HLLIB_API CDirectoryIterator
+	{
+	private:
+		struct DirectoryIteratorFrame
+		{
+			const CDirectoryFolder *pFolder;
+			hlUInt uiItem;	// Next item to visit.
+		};
+
+		typedef std::vector<DirectoryIteratorFrame> CDirectoryIteratorFrameVector;
+
+	private:
+		const CDirectoryFolder *pFolder;
+		HLFindType eFind;
+		CSearchPattern *pPattern;	// Null matches every name.
+
+		// A stack for depth first walks, a queue starting at uiFrame for breadth first walks.
+		CDirectoryIteratorFrameVector Frames;
+		hlUInt uiFrame;
+
+		const CDirectoryItem *pItem;
+		const CDirectoryFolder *pDescend;	// Last folder returned, entered on the next call to Next().
+
+	public:
+		CDirectoryIterator(const CDirectoryFolder *pFolder, const hlChar *lpSearch = 0, HLFindType eFind = HL_FIND_ALL);
+		~CDirectoryIterator();
+
+		const CDirectoryFolder *GetFolder() const;
+		const CDirectoryItem *GetItem() const;
+
+		const CDirectoryItem *Next();
+		hlVoid SkipSubtree();
+		hlVoid Reset();
+
+	private:
+		hlVoid Push(const CDirectoryFolder *pFolder);
+
+		// Owns pPattern.
+		CDirectoryIterator(const CDirectoryIterator &);
+		CDirectoryIterator &operator=(const CDirectoryIterator &);
+	};
+}
+
+#endif
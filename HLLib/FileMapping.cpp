@@ -11,14 +11,54 @@
 
 #include "HLLib.h"
 #include "FileMapping.h"
+#include "Utility.h"
 
 using namespace HLLib;
 using namespace HLLib::Mapping;
 
+#ifndef _WIN32
+static hlInt GetMapFlags(hlUInt uiMode)
+{
+	hlInt iFlags = MAP_SHARED;
+#ifdef MAP_POPULATE
+	// With huge pages the range is populated after madvise() instead, see PrepareView().
+	if((uiMode & HL_MODE_PREFAULT) && !(uiMode & HL_MODE_HUGE_PAGES))
+	{
+		iFlags |= MAP_POPULATE;
+	}
+#endif
+	return iFlags;
+}
+
+//
+// PrepareView()
+// Applies HL_MODE_HUGE_PAGES and HL_MODE_PREFAULT to a freshly mapped view.
+//
+static hlVoid PrepareView(hlVoid *lpView, hlULongLong uiLength, hlUInt uiMode)
+{
+#ifdef MADV_HUGEPAGE
+	if(uiMode & HL_MODE_HUGE_PAGES)
+	{
+		madvise(lpView, static_cast<size_t>(uiLength), MADV_HUGEPAGE);
+
+		if(uiMode & HL_MODE_PREFAULT)
+		{
+#if defined(MADV_POPULATE_READ) && defined(MADV_POPULATE_WRITE)
+			if(madvise(lpView, static_cast<size_t>(uiLength), (uiMode & HL_MODE_WRITE) ? MADV_POPULATE_WRITE : MADV_POPULATE_READ) != 0)
+#endif
+			{
+				madvise(lpView, static_cast<size_t>(uiLength), MADV_WILLNEED);
+			}
+		}
+	}
+#endif
+}
+#endif
+
 #ifdef _WIN32
-CFileMapping::CFileMapping(const hlChar *lpFileName) : hFile(0), hFileMapping(0), uiMode(HL_MODE_INVALID), lpView(0), uiViewSize(0)
+CFileMapping::CFileMapping(const hlChar *lpFileName) : hFile(0), hFileMapping(0), uiMode(HL_MODE_INVALID), lpView(0), uiViewSize(0), pWindowList(0), pWindowMap(0)
 #else
-CFileMapping::CFileMapping(const hlChar *lpFileName) : iFile(-1), uiMode(HL_MODE_INVALID), lpView(0), uiViewSize(0)
+CFileMapping::CFileMapping(const hlChar *lpFileName) : iFile(-1), uiMode(HL_MODE_INVALID), lpView(0), uiViewSize(0), pWindowList(0), pWindowMap(0)
 #endif
 {
 	this->lpFileName = new hlChar[strlen(lpFileName) + 1];
@@ -103,7 +143,8 @@ hlBool CFileMapping::OpenInternal(hlUInt uiMode)
 	}
 
 	// Map the whole file to memory then pass pointers to the
-	// master view back instead of mapping smaller views.
+	// master view back instead of mapping smaller views.  The view
+	// can't be evicted, so it isn't charged to the memory budget.
 	if(uiMode & HL_MODE_QUICK_FILEMAPPING)
 	{
 		LARGE_INTEGER liFileSize;
@@ -170,7 +211,8 @@ hlBool CFileMapping::OpenInternal(hlUInt uiMode)
 	}
 
 	// Map the whole file to memory then pass pointers to the
-	// master view back instead of mapping smaller views.
+	// master view back instead of mapping smaller views.  The view
+	// can't be evicted, so it isn't charged to the memory budget.
 	if(uiMode & HL_MODE_QUICK_FILEMAPPING)
 	{
 		hlInt iProtection = ((uiMode & HL_MODE_READ) ? PROT_READ : 0) | ((uiMode & HL_MODE_WRITE) ? PROT_WRITE : 0);
@@ -184,20 +226,37 @@ hlBool CFileMapping::OpenInternal(hlUInt uiMode)
 			return hlFalse;
 		}
 
-		this->uiViewSize = (hlUInt)Stat.st_size;
-
-		this->lpView = mmap(0, this->uiViewSize, iProtection, MAP_SHARED, this->iFile, 0);
+		this->uiViewSize = static_cast<hlULongLong>(Stat.st_size);
 
-		if(this->lpView == MAP_FAILED)
+		if(this->uiViewSize == 0 || this->uiViewSize > static_cast<hlULongLong>(static_cast<size_t>(-1)))
 		{
-			LastError.SetSystemErrorMessage("Failed to map view of file. Try disabling quick file mapping.");
+			// Cannot map an empty file, or more than 4 GB on 32 bit systems.
+			this->uiViewSize = 0;
+			uiMode &= ~HL_MODE_QUICK_FILEMAPPING;
+		}
+		else
+		{
+			this->lpView = mmap(0, static_cast<size_t>(this->uiViewSize), iProtection, GetMapFlags(uiMode), this->iFile, 0);
 
-			this->lpView = 0;
-			return hlFalse;
+			if(this->lpView == MAP_FAILED)
+			{
+				LastError.SetSystemErrorMessage("Failed to map view of file. Try disabling quick file mapping.");
+
+				this->lpView = 0;
+				return hlFalse;
+			}
+
+			PrepareView(this->lpView, this->uiViewSize, uiMode);
 		}
 	}
 #endif
 
+	if(this->lpView == 0)
+	{
+		this->pWindowList = new CFileMappingWindowList();
+		this->pWindowMap = new CFileMappingWindowMap();
+	}
+
 	this->uiMode = uiMode;
 
 	return hlTrue;
@@ -205,6 +264,8 @@ hlBool CFileMapping::OpenInternal(hlUInt uiMode)
 
 hlVoid CFileMapping::CloseInternal()
 {
+	this->ClearWindows();
+
 #ifdef _WIN32
 	if(this->lpView != 0)
 	{
@@ -279,18 +340,45 @@ hlBool CFileMapping::MapInternal(CView *&pView, hlULongLong uiOffset, hlULongLon
 	}
 	else
 	{
+		CMutexLock Lock(*this->pMutex);
+
 		hlULongLong uiMappingSize = this->GetMappingSize();
 
 		if(uiOffset + uiLength > uiMappingSize)
 		{
 #ifdef _WIN32
-			LastError.SetErrorMessageFormated("Requested view (%I64u, %I64u) does not fit inside mapping, (%I64u, %I64u).", uiOffset, uiLength, 0ULL, this->uiViewSize);
+			LastError.SetErrorMessageFormated("Requested view (%I64u, %I64u) does not fit inside mapping, (%I64u, %I64u).", uiOffset, uiLength, 0ULL, uiMappingSize);
 #else
-			LastError.SetErrorMessageFormated("Requested view (%llu, %llu) does not fit inside mapping, (%llu, %llu).", uiOffset, uiLength, 0ULL, this->uiViewSize);
+			LastError.SetErrorMessageFormated("Requested view (%llu, %llu) does not fit inside mapping, (%llu, %llu).", uiOffset, uiLength, 0ULL, uiMappingSize);
 #endif
 			return hlFalse;
 		}
 
+		// If the view falls inside a single window, share the window.
+		hlULongLong uiIndex = uiOffset / HL_DEFAULT_FILE_MAPPING_WINDOW_SIZE;
+		if(uiLength != 0 && (uiOffset + uiLength - 1) / HL_DEFAULT_FILE_MAPPING_WINDOW_SIZE == uiIndex)
+		{
+			FileMappingWindow *pWindow = this->GetWindow(uiIndex, uiMappingSize);
+
+			if(pWindow != 0)
+			{
+				hlULongLong uiWindowOffset = uiIndex * HL_DEFAULT_FILE_MAPPING_WINDOW_SIZE;
+
+				if(uiOffset + uiLength <= uiWindowOffset + pWindow->uiLength)
+				{
+					if(pWindow->uiReferences++ == 0)
+					{
+						this->RemoveCacheEntry(pWindow->CachePosition);
+					}
+
+					pView = new CView(this, pWindow->lpView, uiWindowOffset, pWindow->uiLength, uiOffset - uiWindowOffset, uiLength);
+
+					this->EvictWindows();
+					return hlTrue;
+				}
+			}
+		}
+
 		// Map multiples of the allocation granularity from the nearest allocation granularity
 		// (for performance).
 		hlULongLong uiGrainOffset = uiOffset % static_cast<hlULongLong>(this->uiAllocationGranularity);
@@ -302,27 +390,12 @@ hlBool CFileMapping::MapInternal(CView *&pView, hlULongLong uiOffset, hlULongLon
 			uiFileLength = uiMappingSize - uiFileOffset;
 		}
 
-#ifdef _WIN32
-		DWORD dwDesiredAccess = ((uiMode & HL_MODE_READ) ? FILE_MAP_READ : 0) | ((uiMode & HL_MODE_WRITE) ? FILE_MAP_WRITE : 0);
-
-		hlVoid *lpView = MapViewOfFile(this->hFileMapping, dwDesiredAccess, static_cast<DWORD>(uiFileOffset >> 32), static_cast<DWORD>(uiFileOffset), static_cast<SIZE_T>(uiFileLength));
+		hlVoid *lpView = this->MapFile(uiFileOffset, uiFileLength);
 
 		if(lpView == 0)
 		{
-			LastError.SetSystemErrorMessage("Failed to map view of file. Try disabling file mapping.");
-			return hlFalse;
-		}
-#else
-		hlInt iProtection = ((uiMode & HL_MODE_READ) ? PROT_READ : 0) | ((uiMode & HL_MODE_WRITE) ? PROT_WRITE : 0);
-
-		hlVoid *lpView = mmap(0, uiFileLength, iProtection, MAP_SHARED, this->iFile, uiFileOffset);
-
-		if(this->lpView == MAP_FAILED)
-		{
-			LastError.SetSystemErrorMessage("Failed to map view of file. Try disabling file mapping.");
 			return hlFalse;
 		}
-#endif
 
 		pView = new CView(this, lpView, uiFileOffset, uiFileLength, uiGrainOffset, uiLength);
 	}
@@ -337,10 +410,210 @@ hlVoid CFileMapping::UnmapInternal(CView &View)
 
 	if(this->lpView == 0)
 	{
+		if(this->pWindowMap != 0 && View.GetAllocationOffset() % HL_DEFAULT_FILE_MAPPING_WINDOW_SIZE == 0)
+		{
+			CFileMappingWindowMap::iterator i = this->pWindowMap->find(View.GetAllocationOffset() / HL_DEFAULT_FILE_MAPPING_WINDOW_SIZE);
+
+			if(i != this->pWindowMap->end() && i->second->lpView == View.GetAllocationView())
+			{
+				assert(i->second->uiReferences > 0);
+
+				if(--i->second->uiReferences == 0)
+				{
+					i->second->CachePosition = this->InsertCacheEntry(i->second);
+				}
+				this->EvictWindows();
+				return;
+			}
+		}
+
+		this->UnmapFile((hlVoid *)View.GetAllocationView(), View.GetAllocationLength());
+	}
+}
+
+hlVoid CFileMapping::AdviseInternal(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint)
+{
+#ifndef _WIN32
+	AdviseFile(this->iFile, uiOffset, uiLength, eHint);
+
+	// The page cache hint does not cover pages that are already mapped, so also
+	// advise whatever part of the range is currently mapped.
+	if(this->lpView != 0)
+	{
+		AdviseMemory(static_cast<hlByte *>(this->lpView) + uiOffset, uiLength, eHint);
+	}
+	else if(this->pWindowList != 0)
+	{
+		for(CFileMappingWindowList::iterator i = this->pWindowList->begin(); i != this->pWindowList->end(); ++i)
+		{
+			hlULongLong uiWindowOffset = (*i)->uiIndex * HL_DEFAULT_FILE_MAPPING_WINDOW_SIZE;
+			hlULongLong uiStart = std::max(uiOffset, uiWindowOffset);
+			hlULongLong uiEnd = std::min(uiOffset + uiLength, uiWindowOffset + (*i)->uiLength);
+
+			if(uiStart < uiEnd)
+			{
+				AdviseMemory(static_cast<hlByte *>((*i)->lpView) + (uiStart - uiWindowOffset), uiEnd - uiStart, eHint);
+			}
+		}
+	}
+#endif
+}
+
+hlVoid *CFileMapping::MapFile(hlULongLong uiOffset, hlULongLong uiLength)
+{
+#ifdef _WIN32
+	DWORD dwDesiredAccess = ((this->uiMode & HL_MODE_READ) ? FILE_MAP_READ : 0) | ((this->uiMode & HL_MODE_WRITE) ? FILE_MAP_WRITE : 0);
+
+	hlVoid *lpView = MapViewOfFile(this->hFileMapping, dwDesiredAccess, static_cast<DWORD>(uiOffset >> 32), static_cast<DWORD>(uiOffset), static_cast<SIZE_T>(uiLength));
+
+	if(lpView == 0)
+	{
+		LastError.SetSystemErrorMessage("Failed to map view of file. Try disabling file mapping.");
+		return 0;
+	}
+#else
+	hlInt iProtection = ((this->uiMode & HL_MODE_READ) ? PROT_READ : 0) | ((this->uiMode & HL_MODE_WRITE) ? PROT_WRITE : 0);
+
+	hlVoid *lpView = mmap(0, static_cast<size_t>(uiLength), iProtection, GetMapFlags(this->uiMode), this->iFile, static_cast<off_t>(uiOffset));
+
+	if(lpView == MAP_FAILED)
+	{
+		LastError.SetSystemErrorMessage("Failed to map view of file. Try disabling file mapping.");
+		return 0;
+	}
+
+	PrepareView(lpView, uiLength, this->uiMode);
+#endif
+
+	this->AllocateMemory(uiLength);
+
+	return lpView;
+}
+
+hlVoid CFileMapping::UnmapFile(hlVoid *lpView, hlULongLong uiLength)
+{
 #ifdef _WIN32
-		UnmapViewOfFile((hlVoid *)View.GetAllocationView());
+	UnmapViewOfFile(lpView);
 #else
-		munmap((hlVoid *)View.GetAllocationView(), View.GetAllocationLength());
+	munmap(lpView, uiLength);
 #endif
+
+	this->FreeMemory(uiLength);
+}
+
+CFileMapping::FileMappingWindow *CFileMapping::GetWindow(hlULongLong uiIndex, hlULongLong uiMappingSize)
+{
+	CFileMappingWindowMap::iterator i = this->pWindowMap->find(uiIndex);
+
+	if(i != this->pWindowMap->end())
+	{
+		FileMappingWindow *pWindow = i->second;
+
+		// Move to the front of the LRU list.
+		this->pWindowList->splice(this->pWindowList->begin(), *this->pWindowList, pWindow->Position);
+		if(pWindow->uiReferences == 0)
+		{
+			this->TouchCacheEntry(pWindow->CachePosition);
+		}
+
+		return pWindow;
+	}
+
+	hlULongLong uiWindowOffset = uiIndex * HL_DEFAULT_FILE_MAPPING_WINDOW_SIZE;
+	hlULongLong uiWindowLength = uiWindowOffset + HL_DEFAULT_FILE_MAPPING_WINDOW_SIZE > uiMappingSize ? uiMappingSize - uiWindowOffset : HL_DEFAULT_FILE_MAPPING_WINDOW_SIZE;
+
+	hlVoid *lpView = this->MapFile(uiWindowOffset, uiWindowLength);
+
+	if(lpView == 0)
+	{
+		return 0;
+	}
+
+	FileMappingWindow *pWindow = new FileMappingWindow;
+	pWindow->uiIndex = uiIndex;
+	pWindow->lpView = lpView;
+	pWindow->uiLength = uiWindowLength;
+	pWindow->uiReferences = 0;
+	pWindow->Position = this->pWindowList->insert(this->pWindowList->begin(), pWindow);
+	pWindow->CachePosition = this->InsertCacheEntry(pWindow);
+
+	this->pWindowMap->insert(CFileMappingWindowMap::value_type(uiIndex, pWindow));
+
+	return pWindow;
+}
+
+//
+// EvictWindows()
+// Unmaps the least recently used windows that no view references once more
+// than HL_DEFAULT_FILE_MAPPING_WINDOW_COUNT of them are idle.
+//
+hlVoid CFileMapping::EvictWindows()
+{
+	if(this->pWindowList == 0)
+	{
+		return;
+	}
+
+	hlUInt uiIdle = 0;
+	for(CFileMappingWindowList::iterator i = this->pWindowList->begin(); i != this->pWindowList->end(); )
+	{
+		FileMappingWindow *pWindow = *i;
+
+		if(pWindow->uiReferences != 0 || ++uiIdle <= HL_DEFAULT_FILE_MAPPING_WINDOW_COUNT)
+		{
+			++i;
+			continue;
+		}
+
+		++i;
+
+		this->RemoveCacheEntry(pWindow->CachePosition);
+		this->EvictWindow(pWindow);
+	}
+}
+
+//
+// EvictInternal()
+// Unmaps an idle window to bring the process back under the mapping memory budget.
+//
+hlVoid CFileMapping::EvictInternal(hlVoid *pItem)
+{
+	this->EvictWindow(static_cast<FileMappingWindow *>(pItem));
+}
+
+hlVoid CFileMapping::EvictWindow(FileMappingWindow *pWindow)
+{
+	assert(pWindow->uiReferences == 0);
+
+	this->UnmapFile(pWindow->lpView, pWindow->uiLength);
+	this->pWindowMap->erase(pWindow->uiIndex);
+	this->pWindowList->erase(pWindow->Position);
+
+	delete pWindow;
+}
+
+hlVoid CFileMapping::ClearWindows()
+{
+	if(this->pWindowList != 0)
+	{
+		for(CFileMappingWindowList::iterator i = this->pWindowList->begin(); i != this->pWindowList->end(); ++i)
+		{
+			if((*i)->uiReferences == 0)
+			{
+				this->RemoveCacheEntry((*i)->CachePosition);
+			}
+
+			this->UnmapFile((*i)->lpView, (*i)->uiLength);
+			delete *i;
+		}
+
+		delete this->pWindowList;
+		this->pWindowList = 0;
+	}
+
+	if(this->pWindowMap != 0)
+	{
+		delete this->pWindowMap;
+		this->pWindowMap = 0;
 	}
 }
@@ -22,6 +22,22 @@ namespace HLLib
 		class HLLIB_API CFileMapping : public CMapping
 		{
 		private:
+			struct FileMappingWindow;
+
+			typedef std::list<FileMappingWindow *> CFileMappingWindowList;
+			typedef std::map<hlULongLong, FileMappingWindow *> CFileMappingWindowMap;
+
+			struct FileMappingWindow
+			{
+				hlULongLong uiIndex;
+				hlVoid *lpView;
+				hlULongLong uiLength;
+				hlUInt uiReferences;
+				CFileMappingWindowList::iterator Position;
+				CMappingCacheList::iterator CachePosition;
+			};
+
+		private:
 #ifdef _WIN32
 			HANDLE hFile;
 			HANDLE hFileMapping;
@@ -36,6 +52,10 @@ namespace HLLib
 
 			hlChar *lpFileName;
 
+			// Large shared windows that views are carved out of.
+			CFileMappingWindowList *pWindowList;
+			CFileMappingWindowMap *pWindowMap;
+
 		public:
 			CFileMapping(const hlChar *lpFileName);
 			virtual ~CFileMapping();
@@ -55,6 +75,18 @@ namespace HLLib
 
 			virtual hlBool MapInternal(CView *&pView, hlULongLong uiOffset, hlULongLong uiLength);
 			virtual hlVoid UnmapInternal(CView &View);
+
+			virtual hlVoid AdviseInternal(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
+			virtual hlVoid EvictInternal(hlVoid *pItem);
+
+			hlVoid *MapFile(hlULongLong uiOffset, hlULongLong uiLength);
+			hlVoid UnmapFile(hlVoid *lpView, hlULongLong uiLength);
+
+			FileMappingWindow *GetWindow(hlULongLong uiIndex, hlULongLong uiMappingSize);
+			hlVoid EvictWindows();
+			hlVoid EvictWindow(FileMappingWindow *pWindow);
+			hlVoid ClearWindows();
 		};
 	}
 }
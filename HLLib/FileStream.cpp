@@ -11,14 +11,77 @@
 
 #include "HLLib.h"
 #include "FileStream.h"
+#include "IOUring.h"
+#include "Mutex.h"
+#include "Utility.h"
 
 using namespace HLLib;
 using namespace HLLib::Streams;
 
+#ifndef _WIN32
+namespace
+{
+	//
+	// Page aligned buffers for HL_MODE_DIRECT_IO streams.  A few are kept between
+	// streams so that extracting many small files doesn't allocate one per file.
+	// Streams on any thread share the pool.
+	//
+	class CDirectBufferPool
+	{
+	private:
+		CMutex Mutex;
+		std::vector<hlByte *> Buffers;
+
+	public:
+		~CDirectBufferPool()
+		{
+			for(std::vector<hlByte *>::iterator i = this->Buffers.begin(); i != this->Buffers.end(); ++i)
+			{
+				free(*i);
+			}
+		}
+
+		hlByte *Acquire()
+		{
+			CMutexLock Lock(this->Mutex);
+
+			if(!this->Buffers.empty())
+			{
+				hlByte *lpBuffer = this->Buffers.back();
+				this->Buffers.pop_back();
+				return lpBuffer;
+			}
+
+			hlVoid *lpBuffer = 0;
+			if(posix_memalign(&lpBuffer, static_cast<size_t>(sysconf(_SC_PAGESIZE)), HL_DEFAULT_DIRECT_IO_BUFFER_SIZE) != 0)
+			{
+				return 0;
+			}
+
+			return static_cast<hlByte *>(lpBuffer);
+		}
+
+		hlVoid Release(hlByte *lpBuffer)
+		{
+			CMutexLock Lock(this->Mutex);
+
+			if(this->Buffers.size() < HL_DEFAULT_DIRECT_IO_BUFFER_COUNT)
+			{
+				this->Buffers.push_back(lpBuffer);
+			}
+			else
+			{
+				free(lpBuffer);
+			}
+		}
+	} DirectBufferPool;
+}
+#endif
+
 #ifdef _WIN32
-CFileStream::CFileStream(const hlChar *lpFileName) : hFile(0), uiMode(HL_MODE_INVALID)
+CFileStream::CFileStream(const hlChar *lpFileName) : hFile(0), uiMode(HL_MODE_INVALID), pIOUring(0), lpDirectBuffer(0), uiDirectAlignment(0), uiDirectBufferOffset(0), uiDirectBufferLength(0)
 #else
-CFileStream::CFileStream(const hlChar *lpFileName) : iFile(-1), uiMode(HL_MODE_INVALID)
+CFileStream::CFileStream(const hlChar *lpFileName) : iFile(-1), uiMode(HL_MODE_INVALID), pIOUring(0), lpDirectBuffer(0), uiDirectAlignment(0), uiDirectBufferOffset(0), uiDirectBufferLength(0)
 #endif
 {
 	this->lpFileName = new hlChar[strlen(lpFileName) + 1];
@@ -120,6 +183,29 @@ hlBool CFileStream::Open(hlUInt uiMode)
 	}
 #endif
 
+	if((uiMode & HL_MODE_ASYNC_IO) && (uiMode & HL_MODE_READ))
+	{
+		// Fall back to synchronous reads if the kernel has no io_uring.
+		this->pIOUring = new CIOUring();
+		if(!this->pIOUring->Open(HL_DEFAULT_IO_URING_DEPTH))
+		{
+			delete this->pIOUring;
+			this->pIOUring = 0;
+		}
+	}
+
+	if(this->pIOUring == 0)
+	{
+		uiMode &= ~HL_MODE_ASYNC_IO;
+	}
+
+	// Unlike HL_MODE_ASYNC_IO the flag is kept when the file system refuses direct
+	// I/O, so that files extracted from the stream's package still try it.
+	if(uiMode & HL_MODE_DIRECT_IO)
+	{
+		this->OpenDirect();
+	}
+
 	this->uiMode = uiMode;
 
 	return hlTrue;
@@ -129,6 +215,15 @@ hlVoid CFileStream::Close()
 {
 	if(this->GetOpened())
 	{
+		if(this->pIOUring != 0)
+		{
+			delete this->pIOUring;
+			this->pIOUring = 0;
+		}
+
+		this->FlushDirect();
+		this->CloseDirect();
+
 #ifdef _WIN32
 		CloseHandle(this->hFile);
 		this->hFile = 0;
@@ -154,7 +249,19 @@ hlULongLong CFileStream::GetStreamSize() const
 #else
 	struct stat Stat;
 
-	return fstat(this->iFile, &Stat) < 0 ? 0 : Stat.st_size;
+	if(fstat(this->iFile, &Stat) < 0)
+	{
+		return 0;
+	}
+
+	// Writes still gathered in the direct I/O buffer may extend the file.
+	hlULongLong uiSize = static_cast<hlULongLong>(Stat.st_size);
+	if(this->uiDirectBufferLength != 0 && this->uiDirectBufferOffset + this->uiDirectBufferLength > uiSize)
+	{
+		uiSize = this->uiDirectBufferOffset + this->uiDirectBufferLength;
+	}
+
+	return uiSize;
 #endif
 }
 
@@ -172,7 +279,7 @@ hlULongLong CFileStream::GetStreamPointer() const
 	LARGE_INTEGER liPointer;
 	return SetFilePointerEx(this->hFile, liOffset, &liPointer, FILE_CURRENT) ? static_cast<hlULongLong>(liPointer.QuadPart) : 0;
 #else
-	return (hlULongLong)lseek(this->iFile, 0, SEEK_CUR);
+	return (hlULongLong)lseek(this->iFile, 0, SEEK_CUR) + this->uiDirectBufferLength;
 #endif
 }
 
@@ -204,6 +311,8 @@ hlULongLong CFileStream::Seek(hlLongLong iOffset, HLSeekMode eSeekMode)
 	LARGE_INTEGER liPointer;
 	return SetFilePointerEx(this->hFile, liOffset, &liPointer, dwMode) ? static_cast<hlULongLong>(liPointer.QuadPart) : 0;
 #else
+	this->SyncDirect();
+
 	hlInt iMode = SEEK_SET;
 	switch(eSeekMode)
 	{
@@ -244,6 +353,11 @@ hlBool CFileStream::Read(hlChar &cChar)
 
 	return ulBytesRead == 1;
 #else
+	// A stream read a byte at a time would do a whole aligned read per byte, so
+	// let the page cache serve it instead.
+	this->SyncDirect();
+	this->CloseDirect();
+
 	hlInt iBytesRead = read(this->iFile, &cChar, 1);
 
 	if(iBytesRead < 0)
@@ -278,6 +392,17 @@ hlUInt CFileStream::Read(hlVoid *lpData, hlUInt uiBytes)
 
 	return (hlUInt)ulBytesRead;
 #else
+	if(this->lpDirectBuffer != 0)
+	{
+		this->SyncDirect();
+
+		off_t iPointer = lseek(this->iFile, 0, SEEK_CUR);
+		hlUInt uiBytesRead = this->ReadDirect(static_cast<hlULongLong>(iPointer), lpData, uiBytes);
+		lseek(this->iFile, iPointer + static_cast<off_t>(uiBytesRead), SEEK_SET);
+
+		return uiBytesRead;
+	}
+
 	hlInt iBytesRead = read(this->iFile, lpData, uiBytes);
 
 	if(iBytesRead < 0)
@@ -312,6 +437,11 @@ hlBool CFileStream::Write(hlChar cChar)
 
 	return ulBytesWritten == 1;
 #else
+	if(this->lpDirectBuffer != 0)
+	{
+		return this->WriteDirect(&cChar, 1) == 1;
+	}
+
 	hlInt iBytesWritten = write(this->iFile, &cChar, 1);
 
 	if(iBytesWritten < 0)
@@ -346,6 +476,11 @@ hlUInt CFileStream::Write(const hlVoid *lpData, hlUInt uiBytes)
 
 	return (hlUInt)ulBytesWritten;
 #else
+	if(this->lpDirectBuffer != 0)
+	{
+		return this->WriteDirect(lpData, uiBytes);
+	}
+
 	hlInt iBytesWritten = write(this->iFile, lpData, uiBytes);
 
 	if(iBytesWritten < 0)
@@ -356,3 +491,558 @@ hlUInt CFileStream::Write(const hlVoid *lpData, hlUInt uiBytes)
 	return (hlUInt)iBytesWritten;
 #endif
 }
+
+hlUInt CFileStream::ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes)
+{
+	if(!this->GetOpened())
+	{
+		return 0;
+	}
+
+	if((this->uiMode & HL_MODE_READ) == 0)
+	{
+		LastError.SetErrorMessage("Stream not in read mode.");
+		return 0;
+	}
+
+#ifdef _WIN32
+	OVERLAPPED Overlapped;
+	memset(&Overlapped, 0, sizeof(Overlapped));
+	Overlapped.Offset = static_cast<DWORD>(uiOffset);
+	Overlapped.OffsetHigh = static_cast<DWORD>(uiOffset >> 32);
+
+	// The offset goes with the read, so concurrent calls don't race on the file
+	// pointer.  ReadFile() still leaves the pointer after the range, see FileStream.h.
+	hlULong ulBytesRead = 0;
+
+	if(!ReadFile(this->hFile, lpData, uiBytes, &ulBytesRead, &Overlapped) && GetLastError() != ERROR_HANDLE_EOF)
+	{
+		LastError.SetSystemErrorMessage("ReadFile() failed.");
+	}
+
+	return (hlUInt)ulBytesRead;
+#else
+	if(this->lpDirectBuffer != 0)
+	{
+		this->SyncDirect();
+
+		return this->ReadDirect(uiOffset, lpData, uiBytes);
+	}
+
+	ssize_t iBytesRead = pread(this->iFile, lpData, uiBytes, static_cast<off_t>(uiOffset));
+
+	if(iBytesRead < 0)
+	{
+		LastError.SetSystemErrorMessage("pread() failed.");
+		return 0;
+	}
+
+	return (hlUInt)iBytesRead;
+#endif
+}
+
+hlUInt CFileStream::WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes)
+{
+	if(!this->GetOpened())
+	{
+		return 0;
+	}
+
+	if((this->uiMode & HL_MODE_WRITE) == 0)
+	{
+		LastError.SetErrorMessage("Stream not in write mode.");
+		return 0;
+	}
+
+#ifdef _WIN32
+	OVERLAPPED Overlapped;
+	memset(&Overlapped, 0, sizeof(Overlapped));
+	Overlapped.Offset = static_cast<DWORD>(uiOffset);
+	Overlapped.OffsetHigh = static_cast<DWORD>(uiOffset >> 32);
+
+	hlULong ulBytesWritten = 0;
+
+	if(!WriteFile(this->hFile, lpData, uiBytes, &ulBytesWritten, &Overlapped))
+	{
+		LastError.SetSystemErrorMessage("WriteFile() failed.");
+	}
+
+	return (hlUInt)ulBytesWritten;
+#else
+	// Positional writes are rare enough not to bother aligning them.
+	this->SyncDirect();
+	this->CloseDirect();
+
+	ssize_t iBytesWritten = pwrite(this->iFile, lpData, uiBytes, static_cast<off_t>(uiOffset));
+
+	if(iBytesWritten < 0)
+	{
+		LastError.SetSystemErrorMessage("pwrite() failed.");
+		return 0;
+	}
+
+	return (hlUInt)iBytesWritten;
+#endif
+}
+
+hlBool CFileStream::ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount)
+{
+	if(!this->GetOpened())
+	{
+		return hlFalse;
+	}
+
+	if((this->uiMode & HL_MODE_READ) == 0)
+	{
+		LastError.SetErrorMessage("Stream not in read mode.");
+		return hlFalse;
+	}
+
+#ifndef _WIN32
+	// io_uring reads straight into the callers' buffers, which need not be aligned.
+	if(this->pIOUring != 0 && this->lpDirectBuffer == 0)
+	{
+		return this->pIOUring->Read(this->iFile, lpRequests, uiCount);
+	}
+
+	if(this->lpDirectBuffer == 0)
+	{
+		return this->ReadVector(lpRequests, uiCount);
+	}
+#endif
+
+	return IStream::ReadBatch(lpRequests, uiCount);
+}
+
+//
+// ReadVector()
+// Reads the requests in file order, using one preadv() for each run of
+// requests that follow each other in the file.
+//
+hlBool CFileStream::ReadVector(StreamReadRequest *lpRequests, hlUInt uiCount)
+{
+#ifdef _WIN32
+	return IStream::ReadBatch(lpRequests, uiCount);
+#else
+#ifdef IOV_MAX
+	const hlUInt uiMaxVectors = IOV_MAX;
+#else
+	const hlUInt uiMaxVectors = 1024;
+#endif
+
+	std::vector<hlUInt> Order;
+	SortStreamSegments(lpRequests, uiCount, Order);
+
+	for(hlUInt i = 0; i < uiCount; i++)
+	{
+		lpRequests[i].uiBytesRead = 0;
+	}
+
+	hlBool bResult = hlTrue;
+
+	std::vector<iovec> Vectors;
+	for(hlUInt i = 0; i < uiCount; )
+	{
+		// Gather the run.
+		hlUInt uiFirst = i;
+		hlULongLong uiOffset = lpRequests[Order[i]].uiOffset;
+		hlULongLong uiEnd = uiOffset;
+
+		Vectors.clear();
+		while(i < uiCount && Vectors.size() < uiMaxVectors && lpRequests[Order[i]].uiOffset == uiEnd)
+		{
+			iovec Vector;
+			Vector.iov_base = lpRequests[Order[i]].lpData;
+			Vector.iov_len = lpRequests[Order[i]].uiBytes;
+			Vectors.push_back(Vector);
+
+			uiEnd += lpRequests[Order[i]].uiBytes;
+			i++;
+		}
+
+		// Read it, resuming after short reads until the end of the file.
+		hlUInt uiVector = 0;
+		while(hlTrue)
+		{
+			while(uiVector < Vectors.size() && Vectors[uiVector].iov_len == 0)
+			{
+				uiVector++;
+			}
+
+			if(uiVector == Vectors.size())
+			{
+				break;
+			}
+
+			ssize_t iBytesRead = preadv(this->iFile, &Vectors[uiVector], static_cast<hlInt>(Vectors.size() - uiVector), static_cast<off_t>(uiOffset));
+
+			if(iBytesRead < 0)
+			{
+				if(errno == EINTR)
+				{
+					continue;
+				}
+
+				LastError.SetSystemErrorMessage("preadv() failed.");
+				bResult = hlFalse;
+				break;
+			}
+			else if(iBytesRead == 0)
+			{
+				break;
+			}
+
+			uiOffset += static_cast<hlULongLong>(iBytesRead);
+
+			size_t uiBytes = static_cast<size_t>(iBytesRead);
+			while(uiBytes != 0)
+			{
+				iovec &Vector = Vectors[uiVector];
+				size_t uiVectorBytes = uiBytes < Vector.iov_len ? uiBytes : Vector.iov_len;
+
+				lpRequests[Order[uiFirst + uiVector]].uiBytesRead += static_cast<hlUInt>(uiVectorBytes);
+				Vector.iov_base = static_cast<hlByte *>(Vector.iov_base) + uiVectorBytes;
+				Vector.iov_len -= uiVectorBytes;
+				uiBytes -= uiVectorBytes;
+
+				if(Vector.iov_len == 0)
+				{
+					uiVector++;
+				}
+			}
+		}
+	}
+
+	return bResult;
+#endif
+}
+
+hlVoid CFileStream::Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint)
+{
+	if(!this->GetOpened())
+	{
+		return;
+	}
+
+#ifndef _WIN32
+	AdviseFile(this->iFile, uiOffset, uiLength, eHint);
+#endif
+}
+
+//
+// OpenDirect()
+// Switches the open file to direct I/O, bypassing the page cache.  Transfers
+// must then be aligned to the file system's direct I/O block size; fails, and
+// leaves the file buffered, if that can't be determined or isn't supported.
+//
+hlBool CFileStream::OpenDirect()
+{
+#if !defined(_WIN32) && defined(O_DIRECT)
+	const hlUInt uiPageSize = static_cast<hlUInt>(sysconf(_SC_PAGESIZE));
+
+	hlUInt uiAlignment = 0;
+
+#ifdef STATX_DIOALIGN
+	struct statx Statx;
+	if(statx(this->iFile, "", AT_EMPTY_PATH, STATX_DIOALIGN, &Statx) == 0 && (Statx.stx_mask & STATX_DIOALIGN) != 0)
+	{
+		if(Statx.stx_dio_offset_align == 0 || Statx.stx_dio_mem_align > uiPageSize)
+		{
+			return hlFalse;
+		}
+
+		uiAlignment = Statx.stx_dio_offset_align > Statx.stx_dio_mem_align ? Statx.stx_dio_offset_align : Statx.stx_dio_mem_align;
+	}
+#endif
+
+	// Without statx() the preferred block size is a safe multiple of the logical block size.
+	if(uiAlignment == 0)
+	{
+		struct stat Stat;
+		if(fstat(this->iFile, &Stat) < 0)
+		{
+			return hlFalse;
+		}
+
+		uiAlignment = static_cast<hlUInt>(Stat.st_blksize);
+	}
+
+	if(uiAlignment == 0 || (uiAlignment & (uiAlignment - 1)) != 0 || uiAlignment > HL_DEFAULT_DIRECT_IO_BUFFER_SIZE)
+	{
+		return hlFalse;
+	}
+
+	hlInt iFlags = fcntl(this->iFile, F_GETFL);
+	if(iFlags < 0 || fcntl(this->iFile, F_SETFL, iFlags | O_DIRECT) < 0)
+	{
+		return hlFalse;
+	}
+
+	this->lpDirectBuffer = DirectBufferPool.Acquire();
+	if(this->lpDirectBuffer == 0)
+	{
+		fcntl(this->iFile, F_SETFL, iFlags);
+		return hlFalse;
+	}
+
+	this->uiDirectAlignment = uiAlignment;
+	this->uiDirectBufferOffset = 0;
+	this->uiDirectBufferLength = 0;
+
+	return hlTrue;
+#else
+	return hlFalse;
+#endif
+}
+
+//
+// CloseDirect()
+// Switches the file back to buffered I/O.  Pending writes that don't make up a
+// whole block are written through the page cache.
+//
+hlBool CFileStream::CloseDirect()
+{
+	if(this->lpDirectBuffer == 0)
+	{
+		return hlTrue;
+	}
+
+	hlBool bResult = hlTrue;
+
+#if !defined(_WIN32) && defined(O_DIRECT)
+	hlInt iFlags = fcntl(this->iFile, F_GETFL);
+	if(iFlags >= 0)
+	{
+		fcntl(this->iFile, F_SETFL, iFlags & ~O_DIRECT);
+	}
+
+	if(this->uiDirectBufferLength != 0)
+	{
+		ssize_t iBytesWritten = write(this->iFile, this->lpDirectBuffer, this->uiDirectBufferLength);
+
+		if(iBytesWritten != static_cast<ssize_t>(this->uiDirectBufferLength))
+		{
+			LastError.SetSystemErrorMessage("write() failed.");
+			bResult = hlFalse;
+		}
+	}
+
+	DirectBufferPool.Release(this->lpDirectBuffer);
+#endif
+
+	this->lpDirectBuffer = 0;
+	this->uiDirectAlignment = 0;
+	this->uiDirectBufferOffset = 0;
+	this->uiDirectBufferLength = 0;
+
+	return bResult;
+}
+
+//
+// ReadDirect()
+// Reads straight into lpData when it, uiOffset and uiBytes are all aligned,
+// otherwise reads the covering blocks into a buffer from the pool and copies
+// out.  The stream's own direct buffer holds pending writes and isn't safe to
+// share between ReadAt() callers.  Falls back to buffered reads if the file
+// system rejects the alignment.
+//
+hlUInt CFileStream::ReadDirect(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes)
+{
+#if !defined(_WIN32) && defined(O_DIRECT)
+	const hlULongLong uiMask = static_cast<hlULongLong>(this->uiDirectAlignment - 1);
+
+	if((uiOffset & uiMask) == 0 && (static_cast<hlULongLong>(uiBytes) & uiMask) == 0 && (reinterpret_cast<hlULongLong>(lpData) & uiMask) == 0)
+	{
+		ssize_t iBytesRead = pread(this->iFile, lpData, uiBytes, static_cast<off_t>(uiOffset));
+
+		if(iBytesRead >= 0)
+		{
+			return static_cast<hlUInt>(iBytesRead);
+		}
+
+		if(errno != EINVAL)
+		{
+			LastError.SetSystemErrorMessage("pread() failed.");
+			return 0;
+		}
+
+		this->CloseDirect();
+		return this->ReadAt(uiOffset, lpData, uiBytes);
+	}
+
+	hlByte *lpBuffer = DirectBufferPool.Acquire();
+	if(lpBuffer == 0)
+	{
+		LastError.SetErrorMessage("Error allocating direct I/O buffer.");
+		return 0;
+	}
+
+	hlUInt uiTotalBytes = 0;
+
+	while(uiBytes > 0)
+	{
+		hlULongLong uiBlockOffset = uiOffset & ~uiMask;
+		hlUInt uiSkip = static_cast<hlUInt>(uiOffset - uiBlockOffset);
+
+		hlULongLong uiLength = (static_cast<hlULongLong>(uiSkip) + uiBytes + uiMask) & ~uiMask;
+		if(uiLength > HL_DEFAULT_DIRECT_IO_BUFFER_SIZE)
+		{
+			uiLength = HL_DEFAULT_DIRECT_IO_BUFFER_SIZE;
+		}
+
+		ssize_t iBytesRead = pread(this->iFile, lpBuffer, static_cast<size_t>(uiLength), static_cast<off_t>(uiBlockOffset));
+
+		if(iBytesRead < 0)
+		{
+			if(errno != EINVAL)
+			{
+				LastError.SetSystemErrorMessage("pread() failed.");
+				break;
+			}
+
+			DirectBufferPool.Release(lpBuffer);
+
+			this->CloseDirect();
+			return uiTotalBytes + this->ReadAt(uiOffset, static_cast<hlByte *>(lpData) + uiTotalBytes, uiBytes);
+		}
+
+		if(static_cast<hlULongLong>(iBytesRead) <= uiSkip)
+		{
+			break;
+		}
+
+		hlUInt uiCopy = static_cast<hlUInt>(iBytesRead) - uiSkip;
+		if(uiCopy > uiBytes)
+		{
+			uiCopy = uiBytes;
+		}
+
+		memcpy(static_cast<hlByte *>(lpData) + uiTotalBytes, lpBuffer + uiSkip, uiCopy);
+
+		uiOffset += uiCopy;
+		uiBytes -= uiCopy;
+		uiTotalBytes += uiCopy;
+
+		if(static_cast<hlULongLong>(iBytesRead) < uiLength)
+		{
+			break;
+		}
+	}
+
+	DirectBufferPool.Release(lpBuffer);
+
+	return uiTotalBytes;
+#else
+	return 0;
+#endif
+}
+
+//
+// WriteDirect()
+// Gathers sequential writes in the direct buffer and writes it out whenever it
+// fills up.  Writes that don't start on a block boundary fall back to buffered
+// I/O.
+//
+hlUInt CFileStream::WriteDirect(const hlVoid *lpData, hlUInt uiBytes)
+{
+#if !defined(_WIN32) && defined(O_DIRECT)
+	if(this->uiDirectBufferLength == 0)
+	{
+		this->uiDirectBufferOffset = static_cast<hlULongLong>(lseek(this->iFile, 0, SEEK_CUR));
+
+		if(this->uiDirectBufferOffset % this->uiDirectAlignment != 0)
+		{
+			this->CloseDirect();
+			return this->Write(lpData, uiBytes);
+		}
+	}
+
+	hlUInt uiTotalBytes = 0;
+
+	while(uiBytes > 0)
+	{
+		if(this->lpDirectBuffer == 0)
+		{
+			// FlushDirect() fell back to buffered I/O.
+			return uiTotalBytes + this->Write(static_cast<const hlByte *>(lpData) + uiTotalBytes, uiBytes);
+		}
+
+		hlUInt uiCopy = HL_DEFAULT_DIRECT_IO_BUFFER_SIZE - this->uiDirectBufferLength;
+		if(uiCopy > uiBytes)
+		{
+			uiCopy = uiBytes;
+		}
+
+		memcpy(this->lpDirectBuffer + this->uiDirectBufferLength, static_cast<const hlByte *>(lpData) + uiTotalBytes, uiCopy);
+		this->uiDirectBufferLength += uiCopy;
+
+		if(this->uiDirectBufferLength == HL_DEFAULT_DIRECT_IO_BUFFER_SIZE && !this->FlushDirect())
+		{
+			break;
+		}
+
+		uiBytes -= uiCopy;
+		uiTotalBytes += uiCopy;
+	}
+
+	return uiTotalBytes;
+#else
+	return 0;
+#endif
+}
+
+//
+// FlushDirect()
+// Writes out every whole block gathered by WriteDirect(), keeping the partial
+// block at the end (if any) for later.
+//
+hlBool CFileStream::FlushDirect()
+{
+#if !defined(_WIN32) && defined(O_DIRECT)
+	if(this->lpDirectBuffer == 0)
+	{
+		return hlTrue;
+	}
+
+	hlUInt uiLength = this->uiDirectBufferLength - this->uiDirectBufferLength % this->uiDirectAlignment;
+
+	if(uiLength == 0)
+	{
+		return hlTrue;
+	}
+
+	ssize_t iBytesWritten = write(this->iFile, this->lpDirectBuffer, uiLength);
+
+	if(iBytesWritten < 0 && errno == EINVAL)
+	{
+		return this->CloseDirect();
+	}
+
+	if(iBytesWritten != static_cast<ssize_t>(uiLength))
+	{
+		LastError.SetSystemErrorMessage("write() failed.");
+
+		this->uiDirectBufferLength = 0;
+		return hlFalse;
+	}
+
+	memmove(this->lpDirectBuffer, this->lpDirectBuffer + uiLength, this->uiDirectBufferLength - uiLength);
+	this->uiDirectBufferOffset += uiLength;
+	this->uiDirectBufferLength -= uiLength;
+#endif
+
+	return hlTrue;
+}
+
+//
+// SyncDirect()
+// Makes the file itself match what has been written, before an operation
+// that doesn't go through the direct buffer.
+//
+hlVoid CFileStream::SyncDirect()
+{
+	if(this->uiDirectBufferLength != 0 && this->FlushDirect() && this->uiDirectBufferLength != 0)
+	{
+		this->CloseDirect();
+	}
+}
@@ -19,6 +19,8 @@ namespace HLLib
 {
 	namespace Streams
 	{
+		class CIOUring;
+
 		class HLLIB_API CFileStream : public IStream
 		{
 		private:
@@ -31,6 +33,17 @@ namespace HLLib
 
 			hlChar *lpFileName;
 
+			// Only set when opened with HL_MODE_ASYNC_IO and the kernel supports it.
+			CIOUring *pIOUring;
+
+			// Only set when opened with HL_MODE_DIRECT_IO and the file system supports it.
+			// Unaligned reads bounce through the buffer; writes are gathered in it until
+			// whole blocks can be written.
+			hlByte *lpDirectBuffer;
+			hlUInt uiDirectAlignment;
+			hlULongLong uiDirectBufferOffset;
+			hlUInt uiDirectBufferLength;
+
 		public:
 			CFileStream(const hlChar *lpFileName);
 			~CFileStream();
@@ -55,6 +68,26 @@ namespace HLLib
 
 			virtual hlBool Write(hlChar cChar);
 			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes);
+
+			// On Windows these pass the offset in an OVERLAPPED, which still leaves the file
+			// pointer after the range; Seek() before going back to Read() or Write().
+			virtual hlUInt ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			virtual hlUInt WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlBool ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount);
+
+			virtual hlVoid Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
+		private:
+			hlBool OpenDirect();
+			hlBool CloseDirect();
+
+			hlUInt ReadDirect(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			hlUInt WriteDirect(const hlVoid *lpData, hlUInt uiBytes);
+
+			hlBool ReadVector(StreamReadRequest *lpRequests, hlUInt uiCount);
+			hlBool FlushDirect();
+			hlVoid SyncDirect();
 		};
 	}
 }
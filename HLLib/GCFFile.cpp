@@ -13,6 +13,7 @@
 #include "GCFFile.h"
 #include "Streams.h"
 #include "Checksum.h"
+#include "Utility.h"
 
 using namespace HLLib;
 
@@ -59,6 +60,8 @@ CGCFFile::CGCFFile() : CPackage(), pHeaderView(0)
 	this->pDataBlockHeader = 0;
 
 	this->lpDirectoryItems = 0;
+
+	this->lpBlockIndices = 0;
 }
 
 CGCFFile::~CGCFFile()
@@ -231,6 +234,26 @@ hlBool CGCFFile::MapDataStructures()
 		return hlFalse;
 	}
 
+#ifndef _WIN32
+	// The tables are looked up by block and item index, not scanned.  Only hint the
+	// pages that hold nothing but header; the view can sit in a window shared with
+	// block data, and posix_fadvise() would turn off readahead for the whole file.
+	if(this->pMapping->GetType() == HL_MAPPING_FILE)
+	{
+		hlULongLong uiPageSize = static_cast<hlULongLong>(sysconf(_SC_PAGESIZE));
+		hlULongLong uiStart = reinterpret_cast<hlULongLong>(this->pHeaderView->GetView());
+		hlULongLong uiEnd = uiStart + uiHeaderSize;
+
+		uiStart = (uiStart + uiPageSize - 1) / uiPageSize * uiPageSize;
+		uiEnd = uiEnd / uiPageSize * uiPageSize;
+
+		if(uiStart < uiEnd)
+		{
+			AdviseMemory(reinterpret_cast<const hlVoid *>(uiStart), uiEnd - uiStart, HL_ACCESS_HINT_RANDOM);
+		}
+	}
+#endif
+
 	this->pHeader = (GCFHeader *)this->pHeaderView->GetView();
 
 	this->pBlockEntryHeader = (GCFBlockEntryHeader *)((hlByte *)this->pHeader + sizeof(GCFHeader));
@@ -297,6 +320,8 @@ hlBool CGCFFile::MapDataStructures()
 
 hlVoid CGCFFile::UnmapDataStructures()
 {
+	this->FreeBlockIndices();
+
 	delete []this->lpDirectoryItems;
 	this->lpDirectoryItems = 0;
 
@@ -639,6 +664,9 @@ hlBool CGCFFile::DefragmentInternal()
 	this->pMapping->Commit(*this->pHeaderView, (hlUInt)((const hlByte *)this->pFragmentationMapHeader - (const hlByte *)this->pHeaderView->GetView()), sizeof(GCFFragmentationMapHeader));
 	this->pMapping->Commit(*this->pHeaderView, (hlUInt)((const hlByte *)this->lpFragmentationMap - (const hlByte *)this->pHeaderView->GetView()), sizeof(GCFFragmentationMap) * this->pFragmentationMapHeader->uiBlockCount);
 
+	// The data blocks have moved.
+	this->FreeBlockIndices();
+
 	return !bError;
 }
 
@@ -646,7 +674,7 @@ CDirectoryFolder *CGCFFile::CreateRoot()
 {
 	this->lpDirectoryItems = new CDirectoryItem *[this->pDirectoryHeader->uiItemCount];
 
-	this->lpDirectoryItems[0] = new CDirectoryFolder("root", 0, 0, this, 0);
+	this->lpDirectoryItems[0] = new CDirectoryFolder("root", 0, 0, this, 0, &this->GetDirectoryArena());
 
 	this->CreateRoot(static_cast<CDirectoryFolder *>(this->lpDirectoryItems[0]));
 
@@ -665,7 +693,7 @@ hlVoid CGCFFile::CreateRoot(CDirectoryFolder *pFolder)
 		if((this->lpDirectoryEntries[uiIndex].uiDirectoryFlags & HL_GCF_FLAG_FILE) == 0)
 		{
 			// Add the directory item to the current folder.
-			this->lpDirectoryItems[uiIndex] = pFolder->AddFolder(this->lpDirectoryNames + this->lpDirectoryEntries[uiIndex].uiNameOffset, uiIndex);
+			this->lpDirectoryItems[uiIndex] = pFolder->AddFolder(this->lpDirectoryNames + this->lpDirectoryEntries[uiIndex].uiNameOffset, uiIndex, 0, hlFalse);
 
 			// Build the new folder.
 			this->CreateRoot(static_cast<CDirectoryFolder *>(this->lpDirectoryItems[uiIndex]));
@@ -673,7 +701,7 @@ hlVoid CGCFFile::CreateRoot(CDirectoryFolder *pFolder)
 		else
 		{
 			// Add the directory item to the current folder.
-			this->lpDirectoryItems[uiIndex] = pFolder->AddFile(this->lpDirectoryNames + this->lpDirectoryEntries[uiIndex].uiNameOffset, uiIndex);
+			this->lpDirectoryItems[uiIndex] = pFolder->AddFile(this->lpDirectoryNames + this->lpDirectoryEntries[uiIndex].uiNameOffset, uiIndex, 0, hlFalse);
 		}
 
 		// Get the next directory item.
@@ -907,6 +935,8 @@ hlBool CGCFFile::GetFileValidationInternal(const CDirectoryFile *pFile, HLValida
 	{
 		if(pStream->Open(HL_MODE_READ))
 		{
+			pStream->Advise(0, pStream->GetStreamSize(), HL_ACCESS_HINT_SEQUENTIAL);
+
 			eValidation = HL_VALIDATES_OK;
 
 			hlULongLong uiTotalBytes = 0, uiFileBytes = pStream->GetStreamSize();
@@ -949,6 +979,7 @@ hlBool CGCFFile::GetFileValidationInternal(const CDirectoryFile *pFile, HLValida
 				i++;
 			}
 
+			pStream->Advise(0, pStream->GetStreamSize(), HL_ACCESS_HINT_NORMAL);
 			pStream->Close();
 		}
 		else
@@ -999,11 +1030,85 @@ hlBool CGCFFile::CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStr
 		return hlFalse;
 	}
 
-	pStream = new Streams::CGCFStream(*this, pFile->GetID());
+	Streams::CGCFStream *pGCFStream = static_cast<Streams::CGCFStream *>(this->GetPooledStream(HL_STREAM_GCF));
+	if(pGCFStream != 0)
+	{
+		pGCFStream->Reset(pFile->GetID());
+		pStream = pGCFStream;
+	}
+	else
+	{
+		pStream = new Streams::CGCFStream(*this, pFile->GetID());
+	}
 
 	return hlTrue;
 }
 
+//
+// MapContentsInternal()
+// Files can only be mapped when every data block follows the previous one on
+// disk, as is the case for a freshly defragmented cache.
+//
+hlBool CGCFFile::MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const
+{
+	if(this->lpDirectoryEntries[pFile->GetID()].uiDirectoryFlags & HL_GCF_FLAG_ENCRYPTED)
+	{
+		LastError.SetErrorMessage("File is encrypted.");
+		return hlFalse;
+	}
+
+	const hlULongLong uiBlockSize = static_cast<hlULongLong>(this->pDataBlockHeader->uiBlockSize);
+	const hlULongLong uiFirstBlockOffset = static_cast<hlULongLong>(this->pDataBlockHeader->uiFirstBlockOffset);
+	const hlUInt uiDataBlockTerminator = this->pFragmentationMapHeader->uiTerminator == 0 ? 0x0000ffff : 0xffffffff;
+	const hlULongLong uiFileSize = static_cast<hlULongLong>(this->lpDirectoryEntries[pFile->GetID()].uiItemSize);
+
+	hlULongLong uiOffset = 0, uiLength = 0;
+
+	hlUInt uiBlockEntryIndex = this->lpDirectoryMapEntries[pFile->GetID()].uiFirstBlockIndex;
+
+	while(uiBlockEntryIndex != this->pDataBlockHeader->uiBlockCount && uiLength < uiFileSize)
+	{
+		hlULongLong uiFileDataSize = static_cast<hlULongLong>(this->lpBlockEntries[uiBlockEntryIndex].uiFileDataSize);
+
+		hlULongLong uiDataBlockOffset = 0;
+		hlUInt uiDataBlockIndex = this->lpBlockEntries[uiBlockEntryIndex].uiFirstDataBlockIndex;
+
+		while(uiDataBlockIndex < uiDataBlockTerminator && uiDataBlockOffset < uiFileDataSize)
+		{
+			hlULongLong uiDataOffset = uiFirstBlockOffset + static_cast<hlULongLong>(uiDataBlockIndex) * uiBlockSize;
+
+			if(uiLength == 0)
+			{
+				uiOffset = uiDataOffset;
+			}
+			else if(uiOffset + uiLength != uiDataOffset)
+			{
+				return CPackage::MapContentsInternal(pFile, pView);
+			}
+
+			uiLength += uiDataBlockOffset + uiBlockSize > uiFileDataSize ? uiFileDataSize - uiDataBlockOffset : uiBlockSize;
+
+			uiDataBlockIndex = this->lpFragmentationMap[uiDataBlockIndex].uiNextDataBlockIndex;
+			uiDataBlockOffset += uiBlockSize;
+		}
+
+		if(uiDataBlockOffset < uiFileDataSize)
+		{
+			break;
+		}
+
+		uiBlockEntryIndex = this->lpBlockEntries[uiBlockEntryIndex].uiNextBlockEntryIndex;
+	}
+
+	if(uiLength < uiFileSize)
+	{
+		LastError.SetErrorMessage("File has not been completely acquired.");
+		return hlFalse;
+	}
+
+	return this->pMapping->Map(pView, uiOffset, uiFileSize);
+}
+
 hlVoid CGCFFile::GetItemFragmentation(hlUInt uiDirectoryItemIndex, hlUInt &uiBlocksFragmented, hlUInt &uiBlocksUsed) const
 {
 	if((this->lpDirectoryEntries[uiDirectoryItemIndex].uiDirectoryFlags & HL_GCF_FLAG_FILE) == 0)
@@ -1047,3 +1152,79 @@ hlVoid CGCFFile::GetItemFragmentation(hlUInt uiDirectoryItemIndex, hlUInt &uiBlo
 		}
 	}
 }
+
+//
+// GetBlockIndex()
+// Returns the data block index of a file, building it the first time it is asked
+// for.  The index stops at the first missing block of a partially acquired file.
+//
+const CGCFFile::GCFBlockIndex &CGCFFile::GetBlockIndex(hlUInt uiDirectoryItemIndex) const
+{
+	if(this->lpBlockIndices == 0)
+	{
+		this->lpBlockIndices = new GCFBlockIndex *[this->pDirectoryHeader->uiItemCount];
+		memset(this->lpBlockIndices, 0, sizeof(GCFBlockIndex *) * this->pDirectoryHeader->uiItemCount);
+	}
+
+	if(this->lpBlockIndices[uiDirectoryItemIndex] != 0)
+	{
+		return *this->lpBlockIndices[uiDirectoryItemIndex];
+	}
+
+	GCFBlockIndex *pBlockIndex = new GCFBlockIndex();
+
+	const hlULongLong uiBlockSize = static_cast<hlULongLong>(this->pDataBlockHeader->uiBlockSize);
+	const hlUInt uiDataBlockTerminator = this->pFragmentationMapHeader->uiTerminator == 0 ? 0x0000ffff : 0xffffffff;
+
+	pBlockIndex->reserve(static_cast<size_t>((static_cast<hlULongLong>(this->lpDirectoryEntries[uiDirectoryItemIndex].uiItemSize) + uiBlockSize - 1) / uiBlockSize));
+
+	hlULongLong uiBlockEntryOffset = 0;
+	hlUInt uiBlockEntryIndex = this->lpDirectoryMapEntries[uiDirectoryItemIndex].uiFirstBlockIndex;
+
+	while(uiBlockEntryIndex != this->pDataBlockHeader->uiBlockCount)
+	{
+		hlULongLong uiFileDataSize = static_cast<hlULongLong>(this->lpBlockEntries[uiBlockEntryIndex].uiFileDataSize);
+
+		hlULongLong uiDataBlockOffset = 0;
+		hlUInt uiDataBlockIndex = this->lpBlockEntries[uiBlockEntryIndex].uiFirstDataBlockIndex;
+
+		while(uiDataBlockIndex < uiDataBlockTerminator && uiDataBlockOffset < uiFileDataSize)
+		{
+			GCFBlockIndexEntry Entry;
+			Entry.uiOffset = uiBlockEntryOffset + uiDataBlockOffset;
+			Entry.uiBlockEntryOffset = uiBlockEntryOffset;
+			Entry.uiBlockEntryIndex = uiBlockEntryIndex;
+			Entry.uiDataBlockIndex = uiDataBlockIndex;
+			pBlockIndex->push_back(Entry);
+
+			uiDataBlockIndex = this->lpFragmentationMap[uiDataBlockIndex].uiNextDataBlockIndex;
+			uiDataBlockOffset += uiBlockSize;
+		}
+
+		if(uiDataBlockOffset < uiFileDataSize)
+		{
+			break;
+		}
+
+		uiBlockEntryOffset += uiFileDataSize;
+		uiBlockEntryIndex = this->lpBlockEntries[uiBlockEntryIndex].uiNextBlockEntryIndex;
+	}
+
+	this->lpBlockIndices[uiDirectoryItemIndex] = pBlockIndex;
+
+	return *pBlockIndex;
+}
+
+hlVoid CGCFFile::FreeBlockIndices()
+{
+	if(this->lpBlockIndices != 0)
+	{
+		for(hlUInt i = 0; i < this->pDirectoryHeader->uiItemCount; i++)
+		{
+			delete this->lpBlockIndices[i];
+		}
+
+		delete []this->lpBlockIndices;
+		this->lpBlockIndices = 0;
+	}
+}
@@ -198,6 +198,20 @@ namespace HLLib
 
 		#pragma pack()
 
+		//
+		// One entry per data block of a file, in file order, so that a stream can
+		// binary search for the block holding any offset.
+		//
+		struct GCFBlockIndexEntry
+		{
+			hlULongLong uiOffset;				// Offset of the data block in the file.
+			hlULongLong uiBlockEntryOffset;		// Offset of the data block's block entry in the file.
+			hlUInt uiBlockEntryIndex;
+			hlUInt uiDataBlockIndex;
+		};
+
+		typedef std::vector<GCFBlockIndexEntry> GCFBlockIndex;
+
 	private:
 		static const char *lpAttributeNames[];
 		static const char *lpItemAttributeNames[];
@@ -236,6 +250,8 @@ namespace HLLib
 
 		CDirectoryItem **lpDirectoryItems;
 
+		mutable GCFBlockIndex **lpBlockIndices;
+
 	public:
 		CGCFFile();
 		virtual ~CGCFFile();
@@ -267,10 +283,15 @@ namespace HLLib
 
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
 
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
+
 	private:
 		hlVoid CreateRoot(CDirectoryFolder *pFolder);
 
 		hlVoid GetItemFragmentation(hlUInt uiDirectoryItemIndex, hlUInt &uiBlocksFragmented, hlUInt &uiBlocksUsed) const;
+
+		const GCFBlockIndex &GetBlockIndex(hlUInt uiDirectoryItemIndex) const;
+		hlVoid FreeBlockIndices();
 	};
 }
 
@@ -11,6 +11,7 @@
 
 #include "HLLib.h"
 #include "GCFStream.h"
+#include "Utility.h"
 
 using namespace HLLib;
 using namespace HLLib::Streams;
@@ -25,6 +26,17 @@ CGCFStream::~CGCFStream()
 	this->Close();
 }
 
+//
+// Reset()
+// Closes the stream and points it at another file, see CMappingStream::Reset().
+//
+hlVoid CGCFStream::Reset(hlUInt uiFileID)
+{
+	this->Close();
+
+	this->uiFileID = uiFileID;
+}
+
 HLStreamType CGCFStream::GetType() const
 {
 	return HL_STREAM_GCF;
@@ -328,14 +340,78 @@ hlUInt CGCFStream::Write(const hlVoid *lpData, hlUInt uiBytes)
 	}
 }
 
+//
+// ReadBatch()
+// Reads the requests in offset order, so that the block chain is walked once
+// instead of from the start for every request that goes backwards.
+//
+hlBool CGCFStream::ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount)
+{
+	if(!this->bOpened)
+	{
+		return hlFalse;
+	}
+
+	if((this->uiMode & HL_MODE_READ) == 0)
+	{
+		LastError.SetErrorMessage("Stream not in read mode.");
+		return hlFalse;
+	}
+
+	std::vector<hlUInt> Order;
+	SortStreamSegments(lpRequests, uiCount, Order);
+
+	hlULongLong uiPointer = this->uiPointer;
+
+	for(hlUInt i = 0; i < uiCount; i++)
+	{
+		StreamReadRequest &Request = lpRequests[Order[i]];
+
+		this->uiPointer = Request.uiOffset < this->uiLength ? Request.uiOffset : this->uiLength;
+		Request.uiBytesRead = this->Read(Request.lpData, Request.uiBytes);
+	}
+
+	this->uiPointer = uiPointer;
+
+	return hlTrue;
+}
+
+//
+// Map()
+// Maps the data block holding uiPointer, along with any data blocks that follow
+// it on disk (up to uiGCFStreamRunSize bytes).  Reads that move on to the next
+// block walk the block chain; anything else seeks with the file's block index.
+//
 hlBool CGCFStream::Map(hlULongLong uiPointer)
 {
-	if(uiPointer < this->uiBlockEntryOffset + this->uiDataBlockOffset)
+	hlULongLong uiViewLength = this->pView != 0 ? this->pView->GetLength() : 0;
+
+	if(uiPointer >= this->uiBlockEntryOffset + this->uiDataBlockOffset && uiPointer < this->uiBlockEntryOffset + this->uiDataBlockOffset + uiViewLength)
+	{
+		return hlTrue;
+	}
+
+	if(uiPointer < this->uiBlockEntryOffset + this->uiDataBlockOffset || uiPointer >= this->uiBlockEntryOffset + this->uiDataBlockOffset + uiViewLength + static_cast<hlULongLong>(this->GCFFile.pDataBlockHeader->uiBlockSize))
 	{
-		this->uiBlockEntryIndex = this->GCFFile.lpDirectoryMapEntries[this->uiFileID].uiFirstBlockIndex;
-		this->uiBlockEntryOffset = 0;
-		this->uiDataBlockIndex = this->GCFFile.lpBlockEntries[this->uiBlockEntryIndex].uiFirstDataBlockIndex;
-		this->uiDataBlockOffset = 0;
+		const CGCFFile::GCFBlockIndex &BlockIndex = this->GCFFile.GetBlockIndex(this->uiFileID);
+
+		CGCFFile::GCFBlockIndex::const_iterator i = std::upper_bound(BlockIndex.begin(), BlockIndex.end(), uiPointer, CGCFStream::BlockIndexOffsetLess);
+		if(i != BlockIndex.begin())
+		{
+			--i;
+
+			this->uiBlockEntryIndex = i->uiBlockEntryIndex;
+			this->uiBlockEntryOffset = i->uiBlockEntryOffset;
+			this->uiDataBlockIndex = i->uiDataBlockIndex;
+			this->uiDataBlockOffset = i->uiOffset - i->uiBlockEntryOffset;
+		}
+		else
+		{
+			this->uiBlockEntryIndex = this->GCFFile.lpDirectoryMapEntries[this->uiFileID].uiFirstBlockIndex;
+			this->uiBlockEntryOffset = 0;
+			this->uiDataBlockIndex = this->GCFFile.lpBlockEntries[this->uiBlockEntryIndex].uiFirstDataBlockIndex;
+			this->uiDataBlockOffset = 0;
+		}
 	}
 
 	hlULongLong uiLength = this->uiDataBlockOffset + this->GCFFile.pDataBlockHeader->uiBlockSize > this->GCFFile.lpBlockEntries[this->uiBlockEntryIndex].uiFileDataSize ? this->GCFFile.lpBlockEntries[this->uiBlockEntryIndex].uiFileDataSize - this->uiDataBlockOffset : this->GCFFile.pDataBlockHeader->uiBlockSize;
@@ -385,9 +461,47 @@ hlBool CGCFStream::Map(hlULongLong uiPointer)
 		return hlFalse;
 	}
 
+	// Extend the view over the run of data blocks that directly follow this one.
+	const hlULongLong uiBlockSize = static_cast<hlULongLong>(this->GCFFile.pDataBlockHeader->uiBlockSize);
+
+	hlUInt uiRunBlockEntryIndex = this->uiBlockEntryIndex;
+	hlUInt uiRunDataBlockIndex = this->uiDataBlockIndex;
+	hlULongLong uiRunDataBlockOffset = this->uiDataBlockOffset;
+
+	while(uiLength % uiBlockSize == 0 && uiLength + uiBlockSize <= uiGCFStreamRunSize)
+	{
+		hlUInt uiNextDataBlockIndex;
+
+		uiRunDataBlockOffset += uiBlockSize;
+		if(uiRunDataBlockOffset < static_cast<hlULongLong>(this->GCFFile.lpBlockEntries[uiRunBlockEntryIndex].uiFileDataSize))
+		{
+			uiNextDataBlockIndex = this->GCFFile.lpFragmentationMap[uiRunDataBlockIndex].uiNextDataBlockIndex;
+		}
+		else
+		{
+			// The block entry ended on a block boundary, so the run may carry on into the next one.
+			uiRunBlockEntryIndex = this->GCFFile.lpBlockEntries[uiRunBlockEntryIndex].uiNextBlockEntryIndex;
+			if(uiRunBlockEntryIndex == this->GCFFile.pDataBlockHeader->uiBlockCount)
+			{
+				break;
+			}
+
+			uiRunDataBlockOffset = 0;
+			uiNextDataBlockIndex = this->GCFFile.lpBlockEntries[uiRunBlockEntryIndex].uiFirstDataBlockIndex;
+		}
+
+		if(uiNextDataBlockIndex >= uiDataBlockTerminator || uiNextDataBlockIndex != uiRunDataBlockIndex + 1)
+		{
+			break;
+		}
+
+		uiRunDataBlockIndex = uiNextDataBlockIndex;
+		uiLength += uiRunDataBlockOffset + uiBlockSize > static_cast<hlULongLong>(this->GCFFile.lpBlockEntries[uiRunBlockEntryIndex].uiFileDataSize) ? static_cast<hlULongLong>(this->GCFFile.lpBlockEntries[uiRunBlockEntryIndex].uiFileDataSize) - uiRunDataBlockOffset : uiBlockSize;
+	}
+
 	if(this->pView)
 	{
-		if(this->pView->GetAllocationOffset() == this->GCFFile.pDataBlockHeader->uiFirstBlockOffset + this->uiDataBlockIndex * this->GCFFile.pDataBlockHeader->uiBlockSize)
+		if(this->pView->GetAllocationOffset() == this->GCFFile.pDataBlockHeader->uiFirstBlockOffset + this->uiDataBlockIndex * this->GCFFile.pDataBlockHeader->uiBlockSize && this->pView->GetLength() == uiLength)
 		{
 			return hlTrue;
 		}
@@ -395,3 +509,76 @@ hlBool CGCFStream::Map(hlULongLong uiPointer)
 
 	return this->GCFFile.pMapping->Map(this->pView, static_cast<hlULongLong>(this->GCFFile.pDataBlockHeader->uiFirstBlockOffset) + static_cast<hlULongLong>(this->uiDataBlockIndex) * static_cast<hlULongLong>(this->GCFFile.pDataBlockHeader->uiBlockSize), uiLength);
 }
+
+hlBool CGCFStream::BlockIndexOffsetLess(hlULongLong uiOffset, const CGCFFile::GCFBlockIndexEntry &Entry)
+{
+	return uiOffset < Entry.uiOffset;
+}
+
+//
+// Advise()
+// Walks the block chain of the file and passes the hint on for each run of
+// contiguous data blocks that overlaps the requested range.
+//
+hlVoid CGCFStream::Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint)
+{
+	if(!this->bOpened)
+	{
+		return;
+	}
+
+	const hlULongLong uiBlockSize = static_cast<hlULongLong>(this->GCFFile.pDataBlockHeader->uiBlockSize);
+	const hlULongLong uiFirstBlockOffset = static_cast<hlULongLong>(this->GCFFile.pDataBlockHeader->uiFirstBlockOffset);
+	const hlUInt uiDataBlockTerminator = this->GCFFile.pFragmentationMapHeader->uiTerminator == 0 ? 0x0000ffff : 0xffffffff;
+	const hlULongLong uiEnd = uiOffset + uiLength;
+
+	hlULongLong uiRunOffset = 0, uiRunLength = 0;
+
+	hlULongLong uiBlockEntryOffset = 0;
+	hlUInt uiBlockEntryIndex = this->GCFFile.lpDirectoryMapEntries[this->uiFileID].uiFirstBlockIndex;
+
+	while(uiBlockEntryIndex != this->GCFFile.pDataBlockHeader->uiBlockCount && uiBlockEntryOffset < uiEnd)
+	{
+		hlULongLong uiFileDataSize = static_cast<hlULongLong>(this->GCFFile.lpBlockEntries[uiBlockEntryIndex].uiFileDataSize);
+
+		if(uiBlockEntryOffset + uiFileDataSize > uiOffset)
+		{
+			hlULongLong uiDataBlockOffset = 0;
+			hlUInt uiDataBlockIndex = this->GCFFile.lpBlockEntries[uiBlockEntryIndex].uiFirstDataBlockIndex;
+
+			while(uiDataBlockIndex < uiDataBlockTerminator && uiDataBlockOffset < uiFileDataSize && uiBlockEntryOffset + uiDataBlockOffset < uiEnd)
+			{
+				if(uiBlockEntryOffset + uiDataBlockOffset + uiBlockSize > uiOffset)
+				{
+					hlULongLong uiDataOffset = uiFirstBlockOffset + static_cast<hlULongLong>(uiDataBlockIndex) * uiBlockSize;
+
+					if(uiRunLength != 0 && uiRunOffset + uiRunLength == uiDataOffset)
+					{
+						uiRunLength += uiBlockSize;
+					}
+					else
+					{
+						if(uiRunLength != 0)
+						{
+							this->GCFFile.pMapping->Advise(uiRunOffset, uiRunLength, eHint);
+						}
+
+						uiRunOffset = uiDataOffset;
+						uiRunLength = uiBlockSize;
+					}
+				}
+
+				uiDataBlockIndex = this->GCFFile.lpFragmentationMap[uiDataBlockIndex].uiNextDataBlockIndex;
+				uiDataBlockOffset += uiBlockSize;
+			}
+		}
+
+		uiBlockEntryOffset += uiFileDataSize;
+		uiBlockEntryIndex = this->GCFFile.lpBlockEntries[uiBlockEntryIndex].uiNextBlockEntryIndex;
+	}
+
+	if(uiRunLength != 0)
+	{
+		this->GCFFile.pMapping->Advise(uiRunOffset, uiRunLength, eHint);
+	}
+}
@@ -43,6 +43,8 @@ namespace HLLib
 			CGCFStream(const CGCFFile &GCFFile, hlUInt uiFileID);
 			~CGCFStream();
 
+			hlVoid Reset(hlUInt uiFileID);
+
 			virtual HLStreamType GetType() const;
 
 			const CGCFFile &GetPackage() const;
@@ -65,8 +67,14 @@ namespace HLLib
 			virtual hlBool Write(hlChar iChar);
 			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes);
 
+			virtual hlBool ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount);
+
+			virtual hlVoid Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
 		private:
 			hlBool Map(hlULongLong uiPointer);
+
+			static hlBool BlockIndexOffsetLess(hlULongLong uiOffset, const CGCFFile::GCFBlockIndexEntry &Entry);
 		};
 	}
 }
@@ -10,6 +10,7 @@
  */
 
 #include "HLLib.h"
+#include "Mappings.h"
 
 using namespace HLLib;
 
@@ -28,6 +29,9 @@ namespace HLLib
 	PTellExProc pTellExProc = 0;
 	PSizeProc pSizeProc = 0;
 	PSizeExProc pSizeExProc = 0;
+	PReadAtProc pReadAtProc = 0;
+	PReadVProc pReadVProc = 0;
+	PGetPointerProc pGetPointerProc = 0;
 
 	PExtractItemStartProc pExtractItemStartProc = 0;
 	PExtractItemEndProc pExtractItemEndProc = 0;
@@ -43,6 +47,12 @@ namespace HLLib
 	hlBool bReadEncrypted = hlTrue;
 	hlBool bForceDefragment = hlFalse;
 
+	hlULongLong uiStreamMappingCacheSize = HL_DEFAULT_STREAM_MAPPING_CACHE_SIZE;
+	hlULongLong uiMappingMemoryBudget = 0;
+	hlULongLong uiGCFStreamRunSize = HL_DEFAULT_GCF_STREAM_RUN_SIZE;
+	hlULongLong uiInflateCheckpointSpacing = HL_DEFAULT_INFLATE_CHECKPOINT_SPACING;
+	hlULongLong uiStreamPoolSize = HL_DEFAULT_STREAM_POOL_SIZE;
+
 	hlVoid hlExtractItemStart(const HLDirectoryItem *pItem)
 	{
 		if(pExtractItemStartProc != 0)
@@ -261,6 +271,48 @@ HLLIB_API hlBool hlGetUnsignedIntegerValidate(HLOption eOption, hlUInt *pValue)
 
 		*pValue = static_cast<hlUInt>(pPackage->GetMapping()->GetTotalMemoryUsed());
 		return hlTrue;
+	case HL_STREAM_MAPPING_CACHE_SIZE:
+		*pValue = static_cast<hlUInt>(uiStreamMappingCacheSize);
+		return hlTrue;
+	case HL_PACKAGE_CACHE_HITS:
+		if(pPackage == 0 || !pPackage->GetOpened() || !pPackage->GetMapping() || pPackage->GetMapping()->GetType() != HL_MAPPING_STREAM)
+		{
+			return hlFalse;
+		}
+
+		*pValue = static_cast<hlUInt>(static_cast<const Mapping::CStreamMapping *>(pPackage->GetMapping())->GetCacheHits());
+		return hlTrue;
+	case HL_PACKAGE_CACHE_MISSES:
+		if(pPackage == 0 || !pPackage->GetOpened() || !pPackage->GetMapping() || pPackage->GetMapping()->GetType() != HL_MAPPING_STREAM)
+		{
+			return hlFalse;
+		}
+
+		*pValue = static_cast<hlUInt>(static_cast<const Mapping::CStreamMapping *>(pPackage->GetMapping())->GetCacheMisses());
+		return hlTrue;
+	case HL_MAPPING_MEMORY_BUDGET:
+		*pValue = static_cast<hlUInt>(uiMappingMemoryBudget);
+		return hlTrue;
+	case HL_MAPPING_MEMORY_USED:
+		*pValue = static_cast<hlUInt>(Mapping::CMapping::GetGlobalMemoryUsed());
+		return hlTrue;
+	case HL_PACKAGE_EVICTIONS:
+		if(pPackage == 0 || !pPackage->GetOpened() || !pPackage->GetMapping())
+		{
+			return hlFalse;
+		}
+
+		*pValue = static_cast<hlUInt>(pPackage->GetMapping()->GetEvictions());
+		return hlTrue;
+	case HL_GCF_STREAM_RUN_SIZE:
+		*pValue = static_cast<hlUInt>(uiGCFStreamRunSize);
+		return hlTrue;
+	case HL_INFLATE_CHECKPOINT_SPACING:
+		*pValue = static_cast<hlUInt>(uiInflateCheckpointSpacing);
+		return hlTrue;
+	case HL_STREAM_POOL_SIZE:
+		*pValue = static_cast<hlUInt>(uiStreamPoolSize);
+		return hlTrue;
 	default:
 		return hlFalse;
 	}
@@ -348,14 +400,76 @@ HLLIB_API hlBool hlGetUnsignedLongLongValidate(HLOption eOption, hlULongLong *pV
 
 		*pValue = pPackage->GetMapping()->GetTotalMemoryUsed();
 		return hlTrue;
+	case HL_STREAM_MAPPING_CACHE_SIZE:
+		*pValue = uiStreamMappingCacheSize;
+		return hlTrue;
+	case HL_PACKAGE_CACHE_HITS:
+		if(pPackage == 0 || !pPackage->GetOpened() || !pPackage->GetMapping() || pPackage->GetMapping()->GetType() != HL_MAPPING_STREAM)
+		{
+			return hlFalse;
+		}
+
+		*pValue = static_cast<const Mapping::CStreamMapping *>(pPackage->GetMapping())->GetCacheHits();
+		return hlTrue;
+	case HL_PACKAGE_CACHE_MISSES:
+		if(pPackage == 0 || !pPackage->GetOpened() || !pPackage->GetMapping() || pPackage->GetMapping()->GetType() != HL_MAPPING_STREAM)
+		{
+			return hlFalse;
+		}
+
+		*pValue = static_cast<const Mapping::CStreamMapping *>(pPackage->GetMapping())->GetCacheMisses();
+		return hlTrue;
+	case HL_MAPPING_MEMORY_BUDGET:
+		*pValue = uiMappingMemoryBudget;
+		return hlTrue;
+	case HL_MAPPING_MEMORY_USED:
+		*pValue = Mapping::CMapping::GetGlobalMemoryUsed();
+		return hlTrue;
+	case HL_PACKAGE_EVICTIONS:
+		if(pPackage == 0 || !pPackage->GetOpened() || !pPackage->GetMapping())
+		{
+			return hlFalse;
+		}
+
+		*pValue = pPackage->GetMapping()->GetEvictions();
+		return hlTrue;
+	case HL_GCF_STREAM_RUN_SIZE:
+		*pValue = uiGCFStreamRunSize;
+		return hlTrue;
+	case HL_INFLATE_CHECKPOINT_SPACING:
+		*pValue = uiInflateCheckpointSpacing;
+		return hlTrue;
+	case HL_STREAM_POOL_SIZE:
+		*pValue = uiStreamPoolSize;
+		return hlTrue;
 	default:
 		return hlFalse;
 	}
 }
 
-HLLIB_API hlVoid hlSetUnsignedLongLong(HLOption , hlULongLong )
+HLLIB_API hlVoid hlSetUnsignedLongLong(HLOption eOption, hlULongLong uiValue)
 {
-
+	switch(eOption)
+	{
+	case HL_STREAM_MAPPING_CACHE_SIZE:
+		uiStreamMappingCacheSize = uiValue;
+		break;
+	case HL_MAPPING_MEMORY_BUDGET:
+		uiMappingMemoryBudget = uiValue;
+		Mapping::CMapping::EnforceMemoryBudget();
+		break;
+	case HL_GCF_STREAM_RUN_SIZE:
+		uiGCFStreamRunSize = uiValue;
+		break;
+	case HL_INFLATE_CHECKPOINT_SPACING:
+		uiInflateCheckpointSpacing = uiValue;
+		break;
+	case HL_STREAM_POOL_SIZE:
+		uiStreamPoolSize = uiValue;
+		break;
+	default:
+		break;
+	}
 }
 
 HLLIB_API hlFloat hlGetFloat(HLOption eOption)
@@ -452,6 +566,15 @@ HLLIB_API hlBool hlGetVoidValidate(HLOption eOption, const hlVoid **pValue)
 	case HL_PROC_SIZE_EX:
 		*pValue = (const hlVoid *)pSizeExProc;
 		return hlTrue;
+	case HL_PROC_READ_AT:
+		*pValue = (const hlVoid *)pReadAtProc;
+		return hlTrue;
+	case HL_PROC_READ_V:
+		*pValue = (const hlVoid *)pReadVProc;
+		return hlTrue;
+	case HL_PROC_GET_POINTER:
+		*pValue = (const hlVoid *)pGetPointerProc;
+		return hlTrue;
 	case HL_PROC_EXTRACT_ITEM_START:
 		*pValue = (const hlVoid *)pExtractItemStartProc;
 		return hlTrue;
@@ -509,6 +632,15 @@ HLLIB_API hlVoid hlSetVoid(HLOption eOption, const hlVoid *pValue)
 	case HL_PROC_SIZE_EX:
 		pSizeExProc = (PSizeExProc)pValue;
 		break;
+	case HL_PROC_READ_AT:
+		pReadAtProc = (PReadAtProc)pValue;
+		break;
+	case HL_PROC_READ_V:
+		pReadVProc = (PReadVProc)pValue;
+		break;
+	case HL_PROC_GET_POINTER:
+		pGetPointerProc = (PGetPointerProc)pValue;
+		break;
 	case HL_PROC_EXTRACT_ITEM_START:
 		pExtractItemStartProc = (PExtractItemStartProc)pValue;
 		break;
@@ -33,6 +33,9 @@ namespace HLLib
 	extern PTellExProc pTellExProc;
 	extern PSizeProc pSizeProc;
 	extern PSizeExProc pSizeExProc;
+	extern PReadAtProc pReadAtProc;
+	extern PReadVProc pReadVProc;
+	extern PGetPointerProc pGetPointerProc;
 
 	extern PExtractItemStartProc pExtractItemStartProc;
 	extern PExtractItemEndProc pExtractItemEndProc;
@@ -53,6 +56,12 @@ namespace HLLib
 	extern hlBool bOverwriteFiles;
 	extern hlBool bReadEncrypted;
 	extern hlBool bForceDefragment;
+
+	extern hlULongLong uiStreamMappingCacheSize;
+	extern hlULongLong uiMappingMemoryBudget;
+	extern hlULongLong uiGCFStreamRunSize;
+	extern hlULongLong uiInflateCheckpointSpacing;
+	extern hlULongLong uiStreamPoolSize;
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,326 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#include "HLLib.h"
+#include "IOUring.h"
+
+#ifdef HL_IO_URING
+#	include <linux/io_uring.h>
+#	include <sys/syscall.h>
+#	include <sys/uio.h>
+#endif
+
+using namespace HLLib;
+using namespace HLLib::Streams;
+
+#ifdef HL_IO_URING
+CIOUring::CIOUring() : iRing(-1), uiEntries(0), lpSubmissionRing(0), uiSubmissionRingSize(0), lpCompletionRing(0), uiCompletionRingSize(0), lpSubmissionEntries(0), uiSubmissionEntriesSize(0)
+#else
+CIOUring::CIOUring() : iRing(-1), uiEntries(0)
+#endif
+{
+
+}
+
+CIOUring::~CIOUring()
+{
+	this->Close();
+}
+
+hlBool CIOUring::GetOpened() const
+{
+	return this->iRing >= 0;
+}
+
+hlBool CIOUring::Open(hlUInt uiEntries)
+{
+	this->Close();
+
+#ifdef HL_IO_URING
+	io_uring_params Params;
+	memset(&Params, 0, sizeof(Params));
+
+	this->iRing = static_cast<hlInt>(syscall(__NR_io_uring_setup, uiEntries, &Params));
+
+	if(this->iRing < 0)
+	{
+		LastError.SetSystemErrorMessage("io_uring_setup() failed.");
+
+		this->iRing = -1;
+		return hlFalse;
+	}
+
+	this->uiEntries = Params.sq_entries;
+
+	this->uiSubmissionRingSize = Params.sq_off.array + Params.sq_entries * sizeof(hlUInt);
+	this->uiCompletionRingSize = Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe);
+
+	// Headers older than the feature (and the features field) get the two mmap()
+	// layout, which every kernel accepts.
+#ifdef IORING_FEAT_SINGLE_MMAP
+	hlBool bSingleMap = (Params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#else
+	hlBool bSingleMap = hlFalse;
+#endif
+
+	if(bSingleMap)
+	{
+		if(this->uiCompletionRingSize > this->uiSubmissionRingSize)
+		{
+			this->uiSubmissionRingSize = this->uiCompletionRingSize;
+		}
+		this->uiCompletionRingSize = this->uiSubmissionRingSize;
+	}
+
+	this->lpSubmissionRing = mmap(0, this->uiSubmissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->iRing, IORING_OFF_SQ_RING);
+
+	if(this->lpSubmissionRing == MAP_FAILED)
+	{
+		LastError.SetSystemErrorMessage("Failed to map io_uring submission queue.");
+
+		this->lpSubmissionRing = 0;
+		this->Close();
+		return hlFalse;
+	}
+
+	if(bSingleMap)
+	{
+		this->lpCompletionRing = this->lpSubmissionRing;
+	}
+	else
+	{
+		this->lpCompletionRing = mmap(0, this->uiCompletionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->iRing, IORING_OFF_CQ_RING);
+
+		if(this->lpCompletionRing == MAP_FAILED)
+		{
+			LastError.SetSystemErrorMessage("Failed to map io_uring completion queue.");
+
+			this->lpCompletionRing = 0;
+			this->Close();
+			return hlFalse;
+		}
+	}
+
+	this->uiSubmissionEntriesSize = Params.sq_entries * sizeof(io_uring_sqe);
+	this->lpSubmissionEntries = static_cast<io_uring_sqe *>(mmap(0, this->uiSubmissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->iRing, IORING_OFF_SQES));
+
+	if(this->lpSubmissionEntries == MAP_FAILED)
+	{
+		LastError.SetSystemErrorMessage("Failed to map io_uring submission entries.");
+
+		this->lpSubmissionEntries = 0;
+		this->Close();
+		return hlFalse;
+	}
+
+	hlByte *lpSubmissionRing = static_cast<hlByte *>(this->lpSubmissionRing);
+	this->lpSubmissionTail = reinterpret_cast<hlUInt *>(lpSubmissionRing + Params.sq_off.tail);
+	this->lpSubmissionMask = reinterpret_cast<hlUInt *>(lpSubmissionRing + Params.sq_off.ring_mask);
+	this->lpSubmissionArray = reinterpret_cast<hlUInt *>(lpSubmissionRing + Params.sq_off.array);
+
+	hlByte *lpCompletionRing = static_cast<hlByte *>(this->lpCompletionRing);
+	this->lpCompletionHead = reinterpret_cast<hlUInt *>(lpCompletionRing + Params.cq_off.head);
+	this->lpCompletionTail = reinterpret_cast<hlUInt *>(lpCompletionRing + Params.cq_off.tail);
+	this->lpCompletionMask = reinterpret_cast<hlUInt *>(lpCompletionRing + Params.cq_off.ring_mask);
+	this->lpCompletionEntries = reinterpret_cast<io_uring_cqe *>(lpCompletionRing + Params.cq_off.cqes);
+
+	return hlTrue;
+#else
+	LastError.SetErrorMessage("io_uring is not supported on this platform.");
+
+	return hlFalse;
+#endif
+}
+
+hlVoid CIOUring::Close()
+{
+#ifdef HL_IO_URING
+	if(this->lpSubmissionEntries != 0)
+	{
+		munmap(this->lpSubmissionEntries, this->uiSubmissionEntriesSize);
+		this->lpSubmissionEntries = 0;
+	}
+
+	if(this->lpCompletionRing != 0 && this->lpCompletionRing != this->lpSubmissionRing)
+	{
+		munmap(this->lpCompletionRing, this->uiCompletionRingSize);
+	}
+	this->lpCompletionRing = 0;
+
+	if(this->lpSubmissionRing != 0)
+	{
+		munmap(this->lpSubmissionRing, this->uiSubmissionRingSize);
+		this->lpSubmissionRing = 0;
+	}
+
+	if(this->iRing >= 0)
+	{
+		close(this->iRing);
+		this->iRing = -1;
+	}
+#endif
+
+	this->uiEntries = 0;
+}
+
+//
+// Read()
+// Reads every request, keeping up to one ring's worth of them in flight.  Short
+// reads are resubmitted for the remainder until the end of the file is reached.
+// Returns false if any read failed; uiBytesRead is set for every request.
+//
+hlBool CIOUring::Read(hlInt iFile, StreamReadRequest *lpRequests, hlUInt uiCount)
+{
+	if(!this->GetOpened())
+	{
+		return hlFalse;
+	}
+
+#ifdef HL_IO_URING
+	hlBool bResult = hlTrue;
+
+	std::vector<iovec> Vectors(uiCount);
+	std::vector<hlUInt> Pending;
+
+	Pending.reserve(uiCount);
+	for(hlUInt i = uiCount; i > 0; i--)
+	{
+		lpRequests[i - 1].uiBytesRead = 0;
+		if(lpRequests[i - 1].uiBytes != 0)
+		{
+			Pending.push_back(i - 1);
+		}
+	}
+
+	hlUInt uiInFlight = 0, uiQueued = 0;
+	while(!Pending.empty() || uiInFlight != 0)
+	{
+		// Fill the submission queue.
+		hlUInt uiTail = *this->lpSubmissionTail;
+		while(!Pending.empty() && uiInFlight + uiQueued < this->uiEntries)
+		{
+			hlUInt uiIndex = Pending.back();
+			Pending.pop_back();
+
+			StreamReadRequest &Request = lpRequests[uiIndex];
+
+			Vectors[uiIndex].iov_base = static_cast<hlByte *>(Request.lpData) + Request.uiBytesRead;
+			Vectors[uiIndex].iov_len = Request.uiBytes - Request.uiBytesRead;
+
+			hlUInt uiSlot = uiTail & *this->lpSubmissionMask;
+			io_uring_sqe &Entry = this->lpSubmissionEntries[uiSlot];
+
+			memset(&Entry, 0, sizeof(Entry));
+			Entry.opcode = IORING_OP_READV;
+			Entry.fd = iFile;
+			Entry.off = Request.uiOffset + Request.uiBytesRead;
+			Entry.addr = reinterpret_cast<hlULongLong>(&Vectors[uiIndex]);
+			Entry.len = 1;
+			Entry.user_data = uiIndex;
+
+			this->lpSubmissionArray[uiSlot] = uiSlot;
+
+			uiTail++;
+			uiQueued++;
+		}
+		__atomic_store_n(this->lpSubmissionTail, uiTail, __ATOMIC_RELEASE);
+
+		// Submit and wait for at least one completion.  Entries the kernel did not
+		// take stay in the queue and go with the next call.
+		hlInt iResult = static_cast<hlInt>(syscall(__NR_io_uring_enter, this->iRing, uiQueued, 1, IORING_ENTER_GETEVENTS, 0, 0));
+
+		if(iResult < 0)
+		{
+			if(errno != EINTR && errno != EAGAIN && errno != EBUSY)
+			{
+				LastError.SetSystemErrorMessage("io_uring_enter() failed.");
+
+				// Reads in flight still point into lpRequests and Vectors.  Withdraw the
+				// entries the kernel never took and wait for the rest before returning.
+				__atomic_store_n(this->lpSubmissionTail, uiTail - uiQueued, __ATOMIC_RELEASE);
+				this->Drain(uiInFlight);
+
+				return hlFalse;
+			}
+
+			// Transient; reap what has completed and try again.
+			iResult = 0;
+		}
+
+		uiQueued -= static_cast<hlUInt>(iResult);
+		uiInFlight += static_cast<hlUInt>(iResult);
+
+		// Drain the completion queue.
+		hlUInt uiHead = *this->lpCompletionHead;
+		hlUInt uiCompletionTail = __atomic_load_n(this->lpCompletionTail, __ATOMIC_ACQUIRE);
+		while(uiHead != uiCompletionTail)
+		{
+			const io_uring_cqe &Completion = this->lpCompletionEntries[uiHead & *this->lpCompletionMask];
+			StreamReadRequest &Request = lpRequests[static_cast<hlUInt>(Completion.user_data)];
+
+			if(Completion.res > 0)
+			{
+				Request.uiBytesRead += static_cast<hlUInt>(Completion.res);
+				if(Request.uiBytesRead < Request.uiBytes)
+				{
+					Pending.push_back(static_cast<hlUInt>(Completion.user_data));
+				}
+			}
+			else if(Completion.res == -EINTR || Completion.res == -EAGAIN)
+			{
+				Pending.push_back(static_cast<hlUInt>(Completion.user_data));
+			}
+			else if(Completion.res < 0)
+			{
+				errno = -Completion.res;
+				LastError.SetSystemErrorMessage("io_uring read failed.");
+				bResult = hlFalse;
+			}
+
+			uiHead++;
+			uiInFlight--;
+		}
+		__atomic_store_n(this->lpCompletionHead, uiHead, __ATOMIC_RELEASE);
+	}
+
+	return bResult;
+#else
+	return hlFalse;
+#endif
+}
+
+#ifdef HL_IO_URING
+//
+// Drain()
+// Waits for uiInFlight completions and discards them.  If the ring can't be waited
+// on it is closed, which cancels whatever is still in flight.
+//
+hlVoid CIOUring::Drain(hlUInt uiInFlight)
+{
+	while(uiInFlight != 0)
+	{
+		if(syscall(__NR_io_uring_enter, this->iRing, 0, 1, IORING_ENTER_GETEVENTS, 0, 0) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+		{
+			this->Close();
+			return;
+		}
+
+		hlUInt uiHead = *this->lpCompletionHead;
+		hlUInt uiCompletionTail = __atomic_load_n(this->lpCompletionTail, __ATOMIC_ACQUIRE);
+		while(uiHead != uiCompletionTail && uiInFlight != 0)
+		{
+			uiHead++;
+			uiInFlight--;
+		}
+		__atomic_store_n(this->lpCompletionHead, uiHead, __ATOMIC_RELEASE);
+	}
+}
+#endif
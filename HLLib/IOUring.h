@@ -0,0 +1,81 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#ifndef IOURING_H
+#define IOURING_H
+
+#include "stdafx.h"
+#include "Stream.h"
+
+#if defined(__linux__) && defined(__has_include)
+#	if __has_include(<linux/io_uring.h>)
+#		define HL_IO_URING
+#	endif
+#endif
+
+#ifdef HL_IO_URING
+struct io_uring_sqe;
+struct io_uring_cqe;
+#endif
+
+namespace HLLib
+{
+	namespace Streams
+	{
+		//
+		// Minimal io_uring submission and completion queue, driven with raw system
+		// calls so that no liburing is needed.  Only used to keep many positional
+		// reads in flight at once; Open() fails when the kernel has no io_uring.
+		//
+		class CIOUring
+		{
+		private:
+			hlInt iRing;
+			hlUInt uiEntries;
+
+#ifdef HL_IO_URING
+			hlVoid *lpSubmissionRing;
+			hlULongLong uiSubmissionRingSize;
+			hlVoid *lpCompletionRing;
+			hlULongLong uiCompletionRingSize;
+			io_uring_sqe *lpSubmissionEntries;
+			hlULongLong uiSubmissionEntriesSize;
+
+			hlUInt *lpSubmissionTail;
+			hlUInt *lpSubmissionMask;
+			hlUInt *lpSubmissionArray;
+
+			hlUInt *lpCompletionHead;
+			hlUInt *lpCompletionTail;
+			hlUInt *lpCompletionMask;
+			io_uring_cqe *lpCompletionEntries;
+#endif
+
+		public:
+			CIOUring();
+			~CIOUring();
+
+			hlBool GetOpened() const;
+
+			hlBool Open(hlUInt uiEntries);
+			hlVoid Close();
+
+			hlBool Read(hlInt iFile, StreamReadRequest *lpRequests, hlUInt uiCount);
+
+#ifdef HL_IO_URING
+		private:
+			hlVoid Drain(hlUInt uiInFlight);
+#endif
+		};
+	}
+}
+
+#endif
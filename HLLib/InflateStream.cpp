@@ -0,0 +1,553 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#include "HLLib.h"
+#include "InflateStream.h"
+#include "Mapping.h"
+
+#if USE_ZLIB
+#	ifdef _WIN32
+#		define ZLIB_WINAPI
+#	endif
+#	include <zlib.h>
+#endif
+
+using namespace HLLib;
+using namespace HLLib::Streams;
+
+CInflateIndex::CInflateIndex()
+{
+
+}
+
+CInflateIndex::~CInflateIndex()
+{
+	for(CInflateCheckpointVector::iterator i = this->Checkpoints.begin(); i != this->Checkpoints.end(); ++i)
+	{
+		delete *i;
+	}
+
+	Mapping::CMapping::FreeMemory(static_cast<hlULongLong>(this->Checkpoints.size()) * sizeof(InflateCheckpoint));
+}
+
+hlUInt CInflateIndex::GetCount() const
+{
+	return static_cast<hlUInt>(this->Checkpoints.size());
+}
+
+const CInflateIndex::InflateCheckpoint *CInflateIndex::Find(hlULongLong uiOutputOffset) const
+{
+	// Checkpoints are added in output order, so binary search for the last one at or before the offset.
+	hlUInt uiLow = 0, uiHigh = static_cast<hlUInt>(this->Checkpoints.size());
+	while(uiLow < uiHigh)
+	{
+		hlUInt uiMiddle = uiLow + (uiHigh - uiLow) / 2;
+		if(this->Checkpoints[uiMiddle]->uiOutputOffset <= uiOutputOffset)
+		{
+			uiLow = uiMiddle + 1;
+		}
+		else
+		{
+			uiHigh = uiMiddle;
+		}
+	}
+
+	return uiLow == 0 ? 0 : this->Checkpoints[uiLow - 1];
+}
+
+const CInflateIndex::InflateCheckpoint *CInflateIndex::GetLast() const
+{
+	return this->Checkpoints.empty() ? 0 : this->Checkpoints.back();
+}
+
+//
+// Add()
+// Checkpoint windows count against HL_MAPPING_MEMORY_BUDGET.  Idle mapping memory
+// is evicted to make room for them; once that isn't enough no more checkpoints are
+// added and seeks inflate forward from the last one kept.
+//
+CInflateIndex::InflateCheckpoint *CInflateIndex::Add()
+{
+	Mapping::CMapping::AllocateMemory(sizeof(InflateCheckpoint));
+
+	if(uiMappingMemoryBudget != 0 && Mapping::CMapping::GetGlobalMemoryUsed() > uiMappingMemoryBudget)
+	{
+		Mapping::CMapping::FreeMemory(sizeof(InflateCheckpoint));
+		return 0;
+	}
+
+	InflateCheckpoint *pCheckpoint = new InflateCheckpoint();
+	this->Checkpoints.push_back(pCheckpoint);
+	return pCheckpoint;
+}
+
+CInflateStream::CInflateStream(IStream *pStream, hlBool bDeleteStream, hlULongLong uiLength, hlBool bRaw, CInflateIndex *pIndex, hlUInt uiBufferSize) : pStream(pStream), bDeleteStream(bDeleteStream), bRaw(bRaw), pIndex(pIndex), bOpened(hlFalse), uiMode(HL_MODE_INVALID), pZStream(0), bStreamEnd(hlFalse), lpInputBuffer(0), lpOutputBuffer(0), uiBufferSize(uiBufferSize), uiInputOffset(0), uiOutputOffset(0), uiOutputLength(0), uiPointer(0), uiLength(uiLength)
+{
+	if(this->uiBufferSize == 0)
+	{
+		this->uiBufferSize = HL_DEFAULT_INFLATE_STREAM_BUFFER_SIZE;
+	}
+}
+
+CInflateStream::~CInflateStream()
+{
+	this->Close();
+
+	if(this->bDeleteStream)
+	{
+		delete this->pStream;
+	}
+}
+
+HLStreamType CInflateStream::GetType() const
+{
+	return HL_STREAM_INFLATE;
+}
+
+const IStream &CInflateStream::GetStream() const
+{
+	return *this->pStream;
+}
+
+const hlChar *CInflateStream::GetFileName() const
+{
+	return this->pStream->GetFileName();
+}
+
+hlBool CInflateStream::GetOpened() const
+{
+	return this->bOpened;
+}
+
+hlUInt CInflateStream::GetMode() const
+{
+	return this->uiMode;
+}
+
+hlBool CInflateStream::Open(hlUInt uiMode)
+{
+	this->Close();
+
+	if((uiMode & (HL_MODE_READ | HL_MODE_WRITE)) == 0)
+	{
+		LastError.SetErrorMessageFormated("Invalid open mode (%#.8x).", uiMode);
+		return hlFalse;
+	}
+
+	if((uiMode & HL_MODE_WRITE) != 0)
+	{
+		LastError.SetErrorMessage("Deflated data can only be opened for reading.");
+		return hlFalse;
+	}
+
+#if USE_ZLIB
+	if(!this->pStream->Open(uiMode))
+	{
+		return hlFalse;
+	}
+
+	z_stream *pZStream = new z_stream;
+	memset(pZStream, 0, sizeof(z_stream));
+
+	if(inflateInit2(pZStream, this->bRaw ? -MAX_WBITS : MAX_WBITS) != Z_OK)
+	{
+		delete pZStream;
+		this->pStream->Close();
+
+		LastError.SetErrorMessage("Deflate Error: Z_MEM_ERROR.");
+		return hlFalse;
+	}
+
+	this->pZStream = pZStream;
+
+	this->lpInputBuffer = new hlByte[this->uiBufferSize];
+	this->lpOutputBuffer = new hlByte[this->uiBufferSize];
+
+	this->bOpened = hlTrue;
+	this->uiMode = uiMode;
+
+	this->uiPointer = 0;
+
+	if(!this->Reset())
+	{
+		this->Close();
+		return hlFalse;
+	}
+
+	return hlTrue;
+#else
+	LastError.SetErrorMessage("Deflate Error: zlib support not compiled in.");
+	return hlFalse;
+#endif
+}
+
+hlVoid CInflateStream::Close()
+{
+#if USE_ZLIB
+	if(this->pZStream != 0)
+	{
+		inflateEnd(static_cast<z_stream *>(this->pZStream));
+		delete static_cast<z_stream *>(this->pZStream);
+		this->pZStream = 0;
+	}
+#endif
+
+	if(this->bOpened)
+	{
+		this->pStream->Close();
+	}
+
+	delete []this->lpInputBuffer;
+	this->lpInputBuffer = 0;
+
+	delete []this->lpOutputBuffer;
+	this->lpOutputBuffer = 0;
+
+	this->bOpened = hlFalse;
+	this->uiMode = HL_MODE_INVALID;
+
+	this->bStreamEnd = hlFalse;
+	this->uiInputOffset = 0;
+	this->uiOutputOffset = 0;
+	this->uiOutputLength = 0;
+
+	this->uiPointer = 0;
+}
+
+hlULongLong CInflateStream::GetStreamSize() const
+{
+	return this->bOpened ? this->uiLength : 0;
+}
+
+hlULongLong CInflateStream::GetStreamPointer() const
+{
+	return this->uiPointer;
+}
+
+//
+// Seek()
+// Only moves the stream pointer; Read() restarts from a checkpoint and inflates
+// up to it.
+//
+hlULongLong CInflateStream::Seek(hlLongLong iOffset, HLSeekMode eSeekMode)
+{
+	if(!this->bOpened)
+	{
+		return 0;
+	}
+
+	switch(eSeekMode)
+	{
+		case HL_SEEK_BEGINNING:
+			this->uiPointer = 0;
+			break;
+		case HL_SEEK_CURRENT:
+
+			break;
+		case HL_SEEK_END:
+			this->uiPointer = this->uiLength;
+			break;
+	}
+
+	hlLongLong iPointer = static_cast<hlLongLong>(this->uiPointer) + iOffset;
+
+	if(iPointer < 0)
+	{
+		iPointer = 0;
+	}
+	else if(iPointer > static_cast<hlLongLong>(this->uiLength))
+	{
+		iPointer = static_cast<hlLongLong>(this->uiLength);
+	}
+
+	this->uiPointer = static_cast<hlULongLong>(iPointer);
+
+	return this->uiPointer;
+}
+
+hlBool CInflateStream::Read(hlChar &cChar)
+{
+	return this->Read(&cChar, 1) == 1;
+}
+
+hlUInt CInflateStream::Read(hlVoid *lpData, hlUInt uiBytes)
+{
+	if(!this->bOpened)
+	{
+		return 0;
+	}
+
+	if(this->uiPointer + static_cast<hlULongLong>(uiBytes) > this->uiLength)
+	{
+		uiBytes = static_cast<hlUInt>(this->uiLength - this->uiPointer);
+	}
+
+	hlUInt uiOffset = 0;
+	while(uiOffset < uiBytes)
+	{
+		if(this->uiPointer < this->uiOutputOffset || this->uiPointer >= this->uiOutputOffset + static_cast<hlULongLong>(this->uiOutputLength))
+		{
+			// Restart from the closest checkpoint if it is past the current window.
+			const CInflateIndex::InflateCheckpoint *pCheckpoint = this->pIndex != 0 ? this->pIndex->Find(this->uiPointer) : 0;
+			if(pCheckpoint != 0 && (this->uiPointer < this->uiOutputOffset || pCheckpoint->uiOutputOffset > this->uiOutputOffset + static_cast<hlULongLong>(this->uiOutputLength)))
+			{
+				if(!this->Restore(*pCheckpoint))
+				{
+					break;
+				}
+			}
+			else if(this->uiPointer < this->uiOutputOffset)
+			{
+				if(!this->Reset())
+				{
+					break;
+				}
+			}
+		}
+
+		if(this->uiPointer >= this->uiOutputOffset + static_cast<hlULongLong>(this->uiOutputLength))
+		{
+			if(!this->Inflate())
+			{
+				break;
+			}
+			continue;
+		}
+
+		hlUInt uiWindowPointer = static_cast<hlUInt>(this->uiPointer - this->uiOutputOffset);
+		hlUInt uiWindowBytes = this->uiOutputLength - uiWindowPointer;
+		if(uiWindowBytes > uiBytes - uiOffset)
+		{
+			uiWindowBytes = uiBytes - uiOffset;
+		}
+
+		memcpy(static_cast<hlByte *>(lpData) + uiOffset, this->lpOutputBuffer + uiWindowPointer, uiWindowBytes);
+
+		this->uiPointer += static_cast<hlULongLong>(uiWindowBytes);
+		uiOffset += uiWindowBytes;
+	}
+
+	return uiOffset;
+}
+
+hlBool CInflateStream::Write(hlChar)
+{
+	if(!this->bOpened)
+	{
+		return hlFalse;
+	}
+
+	LastError.SetErrorMessage("Stream not in write mode.");
+	return hlFalse;
+}
+
+hlUInt CInflateStream::Write(const hlVoid *, hlUInt)
+{
+	if(!this->bOpened)
+	{
+		return 0;
+	}
+
+	LastError.SetErrorMessage("Stream not in write mode.");
+	return 0;
+}
+
+//
+// Advise()
+// Output offsets don't map onto the deflated data, so the hint is passed on for
+// all of it.
+//
+hlVoid CInflateStream::Advise(hlULongLong, hlULongLong, HLAccessHint eHint)
+{
+	if(!this->bOpened)
+	{
+		return;
+	}
+
+	this->pStream->Advise(0, this->pStream->GetStreamSize(), eHint);
+}
+
+//
+// Reset()
+// Rewinds the inflater to the start of the deflated data.
+//
+hlBool CInflateStream::Reset()
+{
+#if USE_ZLIB
+	z_stream *pZStream = static_cast<z_stream *>(this->pZStream);
+
+	if(inflateReset2(pZStream, this->bRaw ? -MAX_WBITS : MAX_WBITS) != Z_OK)
+	{
+		LastError.SetErrorMessage("Deflate Error: Z_STREAM_ERROR.");
+		return hlFalse;
+	}
+
+	pZStream->next_in = this->lpInputBuffer;
+	pZStream->avail_in = 0;
+
+	this->pStream->Seek(0, HL_SEEK_BEGINNING);
+	this->uiInputOffset = 0;
+
+	this->bStreamEnd = hlFalse;
+	this->uiOutputOffset = 0;
+	this->uiOutputLength = 0;
+
+	return hlTrue;
+#else
+	return hlFalse;
+#endif
+}
+
+//
+// Restore()
+// Moves the inflater to a checkpoint.  Checkpoints are on deflate block
+// boundaries, so inflating carries on as raw deflate whatever the wrapper.
+//
+hlBool CInflateStream::Restore(const CInflateIndex::InflateCheckpoint &Checkpoint)
+{
+#if USE_ZLIB
+	z_stream *pZStream = static_cast<z_stream *>(this->pZStream);
+
+	if(inflateReset2(pZStream, -MAX_WBITS) != Z_OK)
+	{
+		LastError.SetErrorMessage("Deflate Error: Z_STREAM_ERROR.");
+		return hlFalse;
+	}
+
+	pZStream->next_in = this->lpInputBuffer;
+	pZStream->avail_in = 0;
+
+	this->uiInputOffset = Checkpoint.uiInputOffset - (Checkpoint.uiBits != 0 ? 1 : 0);
+	this->pStream->Seek(static_cast<hlLongLong>(this->uiInputOffset), HL_SEEK_BEGINNING);
+
+	if(Checkpoint.uiBits != 0)
+	{
+		hlChar cByte;
+		if(!this->pStream->Read(cByte))
+		{
+			LastError.SetErrorMessage("Deflate Error: Z_BUF_ERROR.");
+			return hlFalse;
+		}
+		this->uiInputOffset++;
+
+		inflatePrime(pZStream, static_cast<int>(Checkpoint.uiBits), static_cast<hlByte>(cByte) >> (8 - Checkpoint.uiBits));
+	}
+
+	if(inflateSetDictionary(pZStream, Checkpoint.lpWindow, Checkpoint.uiWindowSize) != Z_OK)
+	{
+		LastError.SetErrorMessage("Deflate Error: Z_DATA_ERROR.");
+		return hlFalse;
+	}
+
+	this->bStreamEnd = hlFalse;
+	this->uiOutputOffset = Checkpoint.uiOutputOffset;
+	this->uiOutputLength = 0;
+
+	return hlTrue;
+#else
+	return hlFalse;
+#endif
+}
+
+//
+// Inflate()
+// Replaces the output window with the next window of inflated data.  With an
+// index, inflating stops at each block boundary so that a checkpoint can be
+// added once uiInflateCheckpointSpacing bytes have passed since the last one.
+//
+hlBool CInflateStream::Inflate()
+{
+#if USE_ZLIB
+	z_stream *pZStream = static_cast<z_stream *>(this->pZStream);
+
+	this->uiOutputOffset += static_cast<hlULongLong>(this->uiOutputLength);
+	this->uiOutputLength = 0;
+
+	pZStream->next_out = this->lpOutputBuffer;
+	pZStream->avail_out = this->uiBufferSize;
+
+	while(pZStream->avail_out != 0 && !this->bStreamEnd)
+	{
+		if(pZStream->avail_in == 0)
+		{
+			hlUInt uiBytes = this->pStream->Read(this->lpInputBuffer, this->uiBufferSize);
+			if(uiBytes == 0)
+			{
+				LastError.SetErrorMessage("Deflate Error: Z_BUF_ERROR.");
+				break;
+			}
+
+			pZStream->next_in = this->lpInputBuffer;
+			pZStream->avail_in = uiBytes;
+
+			this->uiInputOffset += static_cast<hlULongLong>(uiBytes);
+		}
+
+		hlBool bError = hlTrue;
+		switch(inflate(pZStream, this->pIndex != 0 && uiInflateCheckpointSpacing != 0 ? Z_BLOCK : Z_NO_FLUSH))
+		{
+		case Z_OK:
+			bError = hlFalse;
+			break;
+		case Z_STREAM_END:
+			this->bStreamEnd = hlTrue;
+			bError = hlFalse;
+			break;
+		case Z_MEM_ERROR:
+			LastError.SetErrorMessage("Deflate Error: Z_MEM_ERROR.");
+			break;
+		case Z_BUF_ERROR:
+			LastError.SetErrorMessage("Deflate Error: Z_BUF_ERROR.");
+			break;
+		case Z_NEED_DICT:
+		case Z_DATA_ERROR:
+			LastError.SetErrorMessage("Deflate Error: Z_DATA_ERROR.");
+			break;
+		default:
+			LastError.SetErrorMessage("Deflate Error: Unknown.");
+			break;
+		}
+
+		if(bError)
+		{
+			break;
+		}
+
+		// At the end of a block that isn't the last one?
+		if(this->pIndex != 0 && uiInflateCheckpointSpacing != 0 && (pZStream->data_type & 128) != 0 && (pZStream->data_type & 64) == 0)
+		{
+			hlULongLong uiOutputOffset = this->uiOutputOffset + static_cast<hlULongLong>(this->uiBufferSize - pZStream->avail_out);
+
+			const CInflateIndex::InflateCheckpoint *pLast = this->pIndex->GetLast();
+			if(uiOutputOffset >= (pLast != 0 ? pLast->uiOutputOffset : 0) + uiInflateCheckpointSpacing)
+			{
+				CInflateIndex::InflateCheckpoint *pCheckpoint = this->pIndex->Add();
+				if(pCheckpoint != 0)
+				{
+					pCheckpoint->uiOutputOffset = uiOutputOffset;
+					pCheckpoint->uiInputOffset = this->uiInputOffset - static_cast<hlULongLong>(pZStream->avail_in);
+					pCheckpoint->uiBits = static_cast<hlUInt>(pZStream->data_type & 7);
+
+					uInt uiWindowSize = HL_INFLATE_WINDOW_SIZE;
+					inflateGetDictionary(pZStream, pCheckpoint->lpWindow, &uiWindowSize);
+					pCheckpoint->uiWindowSize = static_cast<hlUInt>(uiWindowSize);
+				}
+			}
+		}
+	}
+
+	this->uiOutputLength = this->uiBufferSize - pZStream->avail_out;
+
+	return this->uiOutputLength != 0;
+#else
+	return hlFalse;
+#endif
+}
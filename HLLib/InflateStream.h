@@ -0,0 +1,128 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#ifndef INFLATESTREAM_H
+#define INFLATESTREAM_H
+
+#include "stdafx.h"
+#include "Stream.h"
+
+namespace HLLib
+{
+	namespace Streams
+	{
+		//
+		// Points in deflated data that inflating can be restarted from, recorded by
+		// CInflateStream as it inflates.  An index outlives the streams that use it,
+		// so later streams over the same data can seek without inflating from the start.
+		//
+		class HLLIB_API CInflateIndex
+		{
+		public:
+			struct InflateCheckpoint
+			{
+				hlULongLong uiOutputOffset;				// Offset in the inflated data.
+				hlULongLong uiInputOffset;				// Offset of the first whole byte in the deflated data.
+				hlUInt uiBits;							// Bits of the byte before uiInputOffset still to be inflated.
+				hlUInt uiWindowSize;
+				hlByte lpWindow[HL_INFLATE_WINDOW_SIZE];	// The inflated data leading up to the checkpoint.
+			};
+
+			typedef std::vector<InflateCheckpoint *> CInflateCheckpointVector;
+
+		private:
+			CInflateCheckpointVector Checkpoints;
+
+		public:
+			CInflateIndex();
+			~CInflateIndex();
+
+			hlUInt GetCount() const;
+
+			// Returns the last checkpoint at or before uiOutputOffset, or 0 if there is none.
+			const InflateCheckpoint *Find(hlULongLong uiOutputOffset) const;
+			const InflateCheckpoint *GetLast() const;
+
+			// Returns 0 if the checkpoint doesn't fit in HL_MAPPING_MEMORY_BUDGET.
+			InflateCheckpoint *Add();
+		};
+
+		//
+		// Read only stream over deflated data in another stream.  Data is inflated
+		// into a small window as it is read; seeking inflates forward from the nearest
+		// checkpoint in pIndex, or from the start if there is no index.
+		//
+		class HLLIB_API CInflateStream : public IStream
+		{
+		private:
+			IStream *pStream;
+			hlBool bDeleteStream;
+			hlBool bRaw;
+
+			CInflateIndex *pIndex;
+
+			hlBool bOpened;
+			hlUInt uiMode;
+
+			hlVoid *pZStream;
+			hlBool bStreamEnd;
+
+			hlByte *lpInputBuffer;
+			hlByte *lpOutputBuffer;
+			hlUInt uiBufferSize;
+
+			hlULongLong uiInputOffset;
+
+			hlULongLong uiOutputOffset;
+			hlUInt uiOutputLength;
+
+			hlULongLong uiPointer;
+			hlULongLong uiLength;
+
+		public:
+			// bRaw is set for raw deflate data (ZIP) and clear for zlib wrapped data.
+			// pIndex is optional and is not owned by the stream.
+			CInflateStream(IStream *pStream, hlBool bDeleteStream, hlULongLong uiLength, hlBool bRaw, CInflateIndex *pIndex = 0, hlUInt uiBufferSize = HL_DEFAULT_INFLATE_STREAM_BUFFER_SIZE);
+			~CInflateStream();
+
+			virtual HLStreamType GetType() const;
+
+			const IStream &GetStream() const;
+			virtual const hlChar *GetFileName() const;
+
+			virtual hlBool GetOpened() const;
+			virtual hlUInt GetMode() const;
+
+			virtual hlBool Open(hlUInt uiMode);
+			virtual hlVoid Close();
+
+			virtual hlULongLong GetStreamSize() const;
+			virtual hlULongLong GetStreamPointer() const;
+
+			virtual hlULongLong Seek(hlLongLong iOffset, HLSeekMode eSeekMode);
+
+			virtual hlBool Read(hlChar &cChar);
+			virtual hlUInt Read(hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlBool Write(hlChar cChar);
+			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlVoid Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
+		private:
+			hlBool Reset();
+			hlBool Restore(const CInflateIndex::InflateCheckpoint &Checkpoint);
+			hlBool Inflate();
+		};
+	}
+}
+
+#endif
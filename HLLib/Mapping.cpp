@@ -15,7 +15,29 @@
 using namespace HLLib;
 using namespace HLLib::Mapping;
 
-CView::CView(CMapping *pMapping, hlVoid *lpView, hlULongLong uiAllocationOffset, hlULongLong uiAllocationLength, hlULongLong uiOffset, hlULongLong uiLength) : pMapping(pMapping), lpView(lpView), uiOffset(uiOffset), uiLength(uiLength == 0 ? uiAllocationLength - uiOffset : uiLength), uiAllocationOffset(uiAllocationOffset), uiAllocationLength(uiAllocationLength)
+// Memory held by the views, windows and buffers of every mapping in the process.
+// Mappings on any thread update it, so only touch it through AddMappingMemory().
+static volatile hlULongLong uiMappingMemoryUsed = 0;
+
+// Idle windows and blocks of every mapping, most recently used first.
+static CMappingCacheList MappingCache;
+static CMutex MappingCacheMutex;
+
+//
+// AddMappingMemory()
+// Atomically adds to the memory counter (subtract by adding the negated length)
+// and returns the new total.
+//
+static hlULongLong AddMappingMemory(hlULongLong uiLength)
+{
+#ifdef _WIN32
+	return static_cast<hlULongLong>(InterlockedExchangeAdd64(reinterpret_cast<volatile LONGLONG *>(&uiMappingMemoryUsed), static_cast<LONGLONG>(uiLength))) + uiLength;
+#else
+	return __atomic_add_fetch(&uiMappingMemoryUsed, uiLength, __ATOMIC_RELAXED);
+#endif
+}
+
+CView::CView(CMapping *pMapping, hlVoid *lpView, hlULongLong uiAllocationOffset, hlULongLong uiAllocationLength, hlULongLong uiOffset, hlULongLong uiLength) : pMapping(pMapping), lpView(lpView), uiOffset(uiOffset), uiLength(uiLength == 0 ? uiAllocationLength - uiOffset : uiLength), uiAllocationOffset(uiAllocationOffset), uiAllocationLength(uiAllocationLength), uiSlot(0), uiPackageSlot(0)
 {
 	assert(this->uiOffset + this->uiLength <= this->uiAllocationLength);
 }
@@ -60,14 +82,16 @@ const hlVoid *CView::GetAllocationView() const
 	return this->lpView;
 }
 
-CMapping::CMapping() : pViews(0)
+CMapping::CMapping() : pViews(0), pFreeSlots(0), uiTotalAllocations(0), uiTotalMemoryAllocated(0), uiTotalMemoryUsed(0), uiEvictions(0)
 {
-
+	this->pMutex = new CMutex();
 }
 
 CMapping::~CMapping()
 {
 	assert(this->pViews == 0);
+
+	delete this->pMutex;
 }
 
 const hlChar *CMapping::GetFileName() const
@@ -77,51 +101,130 @@ const hlChar *CMapping::GetFileName() const
 
 hlUInt CMapping::GetTotalAllocations() const
 {
-	if(this->pViews == 0)
-	{
-		return 0;
-	}
-
-	return (hlUInt)this->pViews->size();
+	return this->uiTotalAllocations;
 }
 
 hlULongLong CMapping::GetTotalMemoryAllocated() const
 {
-	if(this->pViews == 0)
-	{
-		return 0;
-	}
-
-	hlULongLong uiTotal = 0;
-	for(CViewList::iterator i = this->pViews->begin(); i != this->pViews->end(); ++i)
-	{
-		uiTotal += (*i)->GetAllocationLength();
-	}
-	return uiTotal;
+	return this->uiTotalMemoryAllocated;
 }
 
 hlULongLong CMapping::GetTotalMemoryUsed() const
 {
-	if(this->pViews == 0)
+	return this->uiTotalMemoryUsed;
+}
+
+hlULongLong CMapping::GetEvictions() const
+{
+	return this->uiEvictions;
+}
+
+hlULongLong CMapping::GetGlobalMemoryUsed()
+{
+	return AddMappingMemory(0);
+}
+
+//
+// EnforceMemoryBudget()
+// Frees the least recently used idle windows and blocks, whatever mapping they
+// belong to, until the memory held by all mappings fits in the budget again.
+// Memory referenced by views is never freed, so the budget is a soft limit.
+// Quick file mappings hold the whole file for as long as they are open and
+// aren't counted at all.
+//
+// Mappings take their own mutex before the cache's, so the owner of an entry
+// is only try-locked here; entries of mappings busy on another thread are
+// skipped rather than waited for.
+//
+hlVoid CMapping::EnforceMemoryBudget()
+{
+	if(uiMappingMemoryBudget == 0)
 	{
-		return 0;
+		return;
 	}
 
-	hlULongLong uiTotal = 0;
-	for(CViewList::iterator i = this->pViews->begin(); i != this->pViews->end(); ++i)
+	CMutexLock Lock(MappingCacheMutex);
+
+	CMappingCacheList::iterator i = MappingCache.end();
+	while(AddMappingMemory(0) > uiMappingMemoryBudget && i != MappingCache.begin())
 	{
-		uiTotal += (*i)->GetLength();
+		--i;
+
+		CMapping *pMapping = i->pMapping;
+		if(!pMapping->pMutex->TryLock())
+		{
+			continue;
+		}
+
+		hlVoid *pItem = i->pItem;
+		i = MappingCache.erase(i);
+
+		pMapping->uiEvictions++;
+		pMapping->EvictInternal(pItem);
+
+		pMapping->pMutex->Unlock();
 	}
-	return uiTotal;
+}
+
+hlVoid CMapping::AllocateMemory(hlULongLong uiLength)
+{
+	AddMappingMemory(uiLength);
+
+	EnforceMemoryBudget();
+}
+
+hlVoid CMapping::FreeMemory(hlULongLong uiLength)
+{
+	hlULongLong uiUsed = AddMappingMemory(0 - uiLength) + uiLength;
+
+	assert(uiUsed >= uiLength);
+}
+
+//
+// InsertCacheEntry()
+// Makes an idle item available for eviction; the item must stay valid until it
+// is removed again or EvictInternal() is called for it.
+//
+CMappingCacheList::iterator CMapping::InsertCacheEntry(hlVoid *pItem)
+{
+	MappingCacheEntry Entry;
+	Entry.pMapping = this;
+	Entry.pItem = pItem;
+
+	CMutexLock Lock(MappingCacheMutex);
+
+	return MappingCache.insert(MappingCache.begin(), Entry);
+}
+
+hlVoid CMapping::TouchCacheEntry(CMappingCacheList::iterator Position)
+{
+	CMutexLock Lock(MappingCacheMutex);
+
+	MappingCache.splice(MappingCache.begin(), MappingCache, Position);
+}
+
+hlVoid CMapping::RemoveCacheEntry(CMappingCacheList::iterator Position)
+{
+	CMutexLock Lock(MappingCacheMutex);
+
+	MappingCache.erase(Position);
+}
+
+hlVoid CMapping::EvictInternal(hlVoid *)
+{
+
 }
 
 hlBool CMapping::Open(hlUInt uiMode)
 {
+	CMutexLock Lock(*this->pMutex);
+
 	this->Close();
 
 	if(this->OpenInternal(uiMode))
 	{
-		this->pViews = new CViewList();
+		this->pViews = new CViewVector();
+		this->pFreeSlots = new CViewSlotVector();
 		return hlTrue;
 	}
 	else
@@ -133,16 +236,29 @@ hlBool CMapping::Open(hlUInt uiMode)
 
 hlVoid CMapping::Close()
 {
+	CMutexLock Lock(*this->pMutex);
+
 	if(this->pViews != 0)
 	{
-		for(CViewList::iterator i = this->pViews->begin(); i != this->pViews->end(); ++i)
+		for(CViewVector::iterator i = this->pViews->begin(); i != this->pViews->end(); ++i)
 		{
-			this->UnmapInternal(**i);
+			if(*i != 0)
+			{
+				this->UnmapInternal(**i);
+			}
 		}
 		delete this->pViews;
 		this->pViews = 0;
+
+		delete this->pFreeSlots;
+		this->pFreeSlots = 0;
 	}
 
+	this->uiTotalAllocations = 0;
+	this->uiTotalMemoryAllocated = 0;
+	this->uiTotalMemoryUsed = 0;
+	this->uiEvictions = 0;
+
 	this->CloseInternal();
 }
 
@@ -164,15 +280,39 @@ hlBool CMapping::Map(CView *&pView, hlULongLong uiOffset, hlULongLong uiLength)
 
 		if(uiOffset >= pView->GetAllocationOffset() && uiOffset + uiLength <= pView->GetAllocationOffset() + pView->GetAllocationLength())
 		{
+			CMutexLock Lock(*this->pMutex);
+
+			this->uiTotalMemoryUsed -= pView->uiLength;
+
 			pView->uiOffset = uiOffset - pView->GetAllocationOffset();
 			pView->uiLength = uiLength;
+
+			this->uiTotalMemoryUsed += pView->uiLength;
 			return hlTrue;
 		}
 	}
 
+	// MapInternal() locks whatever it shares itself, so views read into their
+	// own buffers don't wait on each other.
 	if(this->Unmap(pView) && this->MapInternal(pView, uiOffset, uiLength))
 	{
-		this->pViews->push_back(pView);
+		CMutexLock Lock(*this->pMutex);
+
+		if(this->pFreeSlots->empty())
+		{
+			pView->uiSlot = static_cast<hlUInt>(this->pViews->size());
+			this->pViews->push_back(pView);
+		}
+		else
+		{
+			pView->uiSlot = this->pFreeSlots->back();
+			this->pFreeSlots->pop_back();
+			(*this->pViews)[pView->uiSlot] = pView;
+		}
+
+		this->uiTotalAllocations++;
+		this->uiTotalMemoryAllocated += pView->GetAllocationLength();
+		this->uiTotalMemoryUsed += pView->GetLength();
 		return hlTrue;
 	}
 
@@ -186,21 +326,22 @@ hlBool CMapping::Unmap(CView *&pView)
 		return hlTrue;
 	}
 
-	if(this->GetOpened() && pView->GetMapping() == this)
+	CMutexLock Lock(*this->pMutex);
+
+	if(this->GetOpened() && pView->GetMapping() == this && pView->uiSlot < this->pViews->size() && (*this->pViews)[pView->uiSlot] == pView)
 	{
-		for(CViewList::iterator i = this->pViews->begin(); i != this->pViews->end(); ++i)
-		{
-			if(*i == pView)
-			{
-				this->UnmapInternal(*pView);
-				delete pView;
-				pView = 0;
+		(*this->pViews)[pView->uiSlot] = 0;
+		this->pFreeSlots->push_back(pView->uiSlot);
 
-				this->pViews->erase(i);
-				return hlTrue;
-				break;
-			}
-		}
+		this->uiTotalAllocations--;
+		this->uiTotalMemoryAllocated -= pView->GetAllocationLength();
+		this->uiTotalMemoryUsed -= pView->GetLength();
+
+		this->UnmapInternal(*pView);
+		delete pView;
+		pView = 0;
+
+		return hlTrue;
 	}
 
 	LastError.SetErrorMessage("View does not belong to mapping.");
@@ -248,3 +389,39 @@ hlBool CMapping::CommitInternal(CView &, hlULongLong , hlULongLong )
 {
 	return hlTrue;
 }
+
+//
+// Advise()
+// Passes an access pattern hint for a range of the mapping on to the operating
+// system.  Hints are purely advisory; a mapping that cannot use them ignores them.
+//
+hlBool CMapping::Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint)
+{
+	if(!this->GetOpened())
+	{
+		return hlFalse;
+	}
+
+	hlULongLong uiMappingSize = this->GetMappingSize();
+
+	if(uiOffset >= uiMappingSize || uiLength == 0)
+	{
+		return hlTrue;
+	}
+
+	if(uiLength > uiMappingSize - uiOffset)
+	{
+		uiLength = uiMappingSize - uiOffset;
+	}
+
+	CMutexLock Lock(*this->pMutex);
+
+	this->AdviseInternal(uiOffset, uiLength, eHint);
+
+	return hlTrue;
+}
+
+hlVoid CMapping::AdviseInternal(hlULongLong , hlULongLong , HLAccessHint )
+{
+
+}
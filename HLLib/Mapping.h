@@ -13,9 +13,12 @@
 #define MAPPING_H
 
 #include "stdafx.h"
+#include "Mutex.h"
 
 namespace HLLib
 {
+	class CPackage;
+
 	namespace Mapping
 	{
 		class CMapping;
@@ -23,6 +26,7 @@ namespace HLLib
 		class HLLIB_API CView
 		{
 			friend class CMapping;
+			friend class HLLib::CPackage;
 
 		private:
 			CMapping *pMapping;
@@ -33,6 +37,13 @@ namespace HLLib
 			hlULongLong uiAllocationOffset;
 			hlULongLong uiAllocationLength;
 
+			// Index of the view in its mapping's registry.
+			hlUInt uiSlot;
+
+			// Index of the view in its package's registry, if it was handed out by
+			// CPackage::MapContents().
+			hlUInt uiPackageSlot;
+
 		public:
 			CView(CMapping *pMapping, hlVoid *lpView, hlULongLong uiAllocationOffset, hlULongLong uiAllocationLength, hlULongLong uiOffset = 0, hlULongLong uiLength = 0);
 			~CView();
@@ -47,12 +58,35 @@ namespace HLLib
 			hlULongLong GetAllocationLength() const;
 		};
 
-		typedef std::list<CView *> CViewList;
+		typedef std::vector<CView *> CViewVector;
+		typedef std::vector<hlUInt> CViewSlotVector;
+
+		// An idle window or block that may be freed to keep all mappings in the
+		// process under the mapping memory budget.
+		struct MappingCacheEntry
+		{
+			CMapping *pMapping;
+			hlVoid *pItem;
+		};
+
+		typedef std::list<MappingCacheEntry> CMappingCacheList;
 
 		class HLLIB_API CMapping
 		{
 		private:
-			CViewList *pViews;
+			// Live views by slot; unused slots are null and listed in pFreeSlots.
+			CViewVector *pViews;
+			CViewSlotVector *pFreeSlots;
+
+			hlUInt uiTotalAllocations;
+			hlULongLong uiTotalMemoryAllocated;
+			hlULongLong uiTotalMemoryUsed;
+			hlULongLong uiEvictions;
+
+		protected:
+			// Guards the views and anything a mapping shares between them, so views
+			// may be mapped and unmapped from several threads at once.
+			CMutex *pMutex;
 
 		public:
 			CMapping();
@@ -68,6 +102,15 @@ namespace HLLib
 			hlUInt GetTotalAllocations() const;
 			hlULongLong GetTotalMemoryAllocated() const;
 			hlULongLong GetTotalMemoryUsed() const;
+			hlULongLong GetEvictions() const;
+
+			// Memory held by all mappings in the process, and the budget it is held to.
+			static hlULongLong GetGlobalMemoryUsed();
+			static hlVoid EnforceMemoryBudget();
+
+			// Count memory held on behalf of mappings, such as inflate checkpoints, against the budget.
+			static hlVoid AllocateMemory(hlULongLong uiLength);
+			static hlVoid FreeMemory(hlULongLong uiLength);
 
 			hlBool Open(hlUInt uiMode);
 			hlVoid Close();
@@ -80,6 +123,14 @@ namespace HLLib
 			hlBool Commit(CView &View);
 			hlBool Commit(CView &View, hlULongLong uiOffset, hlULongLong uiLength);
 
+			// Tell the operating system how a range of the mapping is about to be accessed.
+			hlBool Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
+		protected:
+			CMappingCacheList::iterator InsertCacheEntry(hlVoid *pItem);
+			hlVoid TouchCacheEntry(CMappingCacheList::iterator Position);
+			hlVoid RemoveCacheEntry(CMappingCacheList::iterator Position);
+
 		private:
 			virtual hlBool OpenInternal(hlUInt uiMode) = 0;
 			virtual hlVoid CloseInternal() = 0;
@@ -88,6 +139,10 @@ namespace HLLib
 			virtual hlVoid UnmapInternal(CView &View);
 
 			virtual hlBool CommitInternal(CView &View, hlULongLong uiOffset, hlULongLong uiLength);
+
+			virtual hlVoid AdviseInternal(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
+			virtual hlVoid EvictInternal(hlVoid *pItem);
 		};
 	}
 }
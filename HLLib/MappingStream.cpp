@@ -11,18 +11,41 @@
 
 #include "HLLib.h"
 #include "MappingStream.h"
+#include "Utility.h"
 
 using namespace HLLib;
 using namespace HLLib::Streams;
 
-CMappingStream::CMappingStream(Mapping::CMapping &Mapping, hlULongLong uiMappingOffset, hlULongLong uiMappingSize, hlULongLong uiViewSize) : bOpened(hlFalse), uiMode(HL_MODE_INVALID), Mapping(Mapping), pView(NULL), uiMappingOffset(uiMappingOffset), uiMappingSize(uiMappingSize), uiViewSize(uiViewSize), uiPointer(0), uiLength(0)
+CMappingStream::CMappingStream(Mapping::CMapping &Mapping, hlULongLong uiMappingOffset, hlULongLong uiMappingSize, hlULongLong uiViewSize) : bOpened(hlFalse), uiMode(HL_MODE_INVALID), pMapping(&Mapping), pView(NULL), uiMappingOffset(0), uiMappingSize(0), uiViewSize(0), uiPointer(0), uiLength(0)
 {
+	this->Reset(Mapping, uiMappingOffset, uiMappingSize, uiViewSize);
+}
+
+CMappingStream::~CMappingStream()
+{
+	this->Close();
+}
+
+//
+// Reset()
+// Closes the stream and points it at another range, so that packages can
+// reuse released streams instead of allocating new ones.
+//
+hlVoid CMappingStream::Reset(Mapping::CMapping &Mapping, hlULongLong uiMappingOffset, hlULongLong uiMappingSize, hlULongLong uiViewSize)
+{
+	this->Close();
+
+	this->pMapping = &Mapping;
+	this->uiMappingOffset = uiMappingOffset;
+	this->uiMappingSize = uiMappingSize;
+	this->uiViewSize = uiViewSize;
+
 	if(this->uiViewSize == 0)
 	{
-		switch(this->Mapping.GetType())
+		switch(this->pMapping->GetType())
 		{
 		case HL_MAPPING_FILE:
-			if(this->Mapping.GetMode() & HL_MODE_QUICK_FILEMAPPING)
+			if(this->pMapping->GetMode() & HL_MODE_QUICK_FILEMAPPING)
 			{
 		case HL_MAPPING_MEMORY:
 				this->uiViewSize = this->uiMappingSize;
@@ -35,11 +58,6 @@ CMappingStream::CMappingStream(Mapping::CMapping &Mapping, hlULongLong uiMapping
 	}
 }
 
-CMappingStream::~CMappingStream()
-{
-	this->Close();
-}
-
 HLStreamType CMappingStream::GetType() const
 {
 	return HL_STREAM_MAPPING;
@@ -47,7 +65,7 @@ HLStreamType CMappingStream::GetType() const
 
 const Mapping::CMapping &CMappingStream::GetMapping() const
 {
-	return this->Mapping;
+	return *this->pMapping;
 }
 
 const hlChar *CMappingStream::GetFileName() const
@@ -75,13 +93,13 @@ hlBool CMappingStream::Open(hlUInt uiMode)
 		return hlFalse;
 	}
 
-	if((uiMode & HL_MODE_READ) != 0 && (this->Mapping.GetMode() & HL_MODE_READ) == 0)
+	if((uiMode & HL_MODE_READ) != 0 && (this->pMapping->GetMode() & HL_MODE_READ) == 0)
 	{
 		LastError.SetErrorMessage("Mapping does not have read permissions.");
 		return hlFalse;
 	}
 
-	if((uiMode & HL_MODE_WRITE) != 0 && (this->Mapping.GetMode() & HL_MODE_WRITE) == 0)
+	if((uiMode & HL_MODE_WRITE) != 0 && (this->pMapping->GetMode() & HL_MODE_WRITE) == 0)
 	{
 		LastError.SetErrorMessage("Mapping does not have write permissions.");
 		return hlFalse;
@@ -101,7 +119,7 @@ hlVoid CMappingStream::Close()
 	this->bOpened = hlFalse;
 	this->uiMode = HL_MODE_INVALID;
 
-	this->Mapping.Unmap(this->pView);
+	this->pMapping->Unmap(this->pView);
 
 	this->uiPointer = 0;
 	this->uiLength = 0;
@@ -189,52 +207,11 @@ hlBool CMappingStream::Read(hlChar &cChar)
 
 hlUInt CMappingStream::Read(hlVoid *lpData, hlUInt uiBytes)
 {
-	if(!this->bOpened)
-	{
-		return 0;
-	}
+	uiBytes = this->ReadAt(this->uiPointer, lpData, uiBytes);
 
-	if((this->uiMode & HL_MODE_READ) == 0)
-	{
-		LastError.SetErrorMessage("Stream not in read mode.");
-		return 0;
-	}
+	this->uiPointer += static_cast<hlULongLong>(uiBytes);
 
-	if(this->uiPointer == this->uiLength)
-	{
-		return 0;
-	}
-	else
-	{
-		hlULongLong uiOffset = 0;
-		while(uiBytes && this->uiPointer < this->uiLength)
-		{
-			if(!this->Map(this->uiPointer))
-			{
-				break;
-			}
-
-			hlULongLong uiViewPointer = this->uiPointer - (this->pView->GetAllocationOffset() + this->pView->GetOffset() - this->uiMappingOffset);
-			hlULongLong uiViewBytes = this->pView->GetLength() - uiViewPointer;
-
-			if(uiViewBytes >= uiBytes)
-			{
-				memcpy(static_cast<hlByte *>(lpData) + uiOffset, static_cast<const hlByte *>(this->pView->GetView()) + uiViewPointer, uiBytes);
-				this->uiPointer += static_cast<hlULongLong>(uiBytes);
-				uiOffset += uiBytes;
-				break;
-			}
-			else
-			{
-				memcpy(static_cast<hlByte *>(lpData) + uiOffset, static_cast<const hlByte *>(this->pView->GetView()) + uiViewPointer, static_cast<size_t>(uiViewBytes));
-				this->uiPointer += uiViewBytes;
-				uiOffset += uiViewBytes;
-				uiBytes -= static_cast<hlUInt>(uiViewBytes);
-			}
-		}
-
-		return static_cast<hlUInt>(uiOffset);
-	}
+	return uiBytes;
 }
 
 hlBool CMappingStream::Write(hlChar cChar)
@@ -278,58 +255,107 @@ hlBool CMappingStream::Write(hlChar cChar)
 }
 
 hlUInt CMappingStream::Write(const hlVoid *lpData, hlUInt uiBytes)
+{
+	uiBytes = this->WriteAt(this->uiPointer, lpData, uiBytes);
+
+	this->uiPointer += static_cast<hlULongLong>(uiBytes);
+
+	return uiBytes;
+}
+
+hlUInt CMappingStream::ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes)
 {
 	if(!this->bOpened)
 	{
 		return 0;
 	}
 
-	if((this->uiMode & HL_MODE_WRITE) == 0)
+	if((this->uiMode & HL_MODE_READ) == 0)
+	{
+		LastError.SetErrorMessage("Stream not in read mode.");
+		return 0;
+	}
+
+	hlULongLong uiCopied = 0;
+	while(uiBytes && uiOffset < this->uiLength)
+	{
+		if(!this->Map(uiOffset))
+		{
+			break;
+		}
+
+		hlULongLong uiViewPointer = uiOffset - (this->pView->GetAllocationOffset() + this->pView->GetOffset() - this->uiMappingOffset);
+		hlULongLong uiViewBytes = this->pView->GetLength() - uiViewPointer;
+
+		if(uiViewBytes > this->uiLength - uiOffset)
+		{
+			uiViewBytes = this->uiLength - uiOffset;
+		}
+
+		if(uiViewBytes >= uiBytes)
+		{
+			memcpy(static_cast<hlByte *>(lpData) + uiCopied, static_cast<const hlByte *>(this->pView->GetView()) + uiViewPointer, uiBytes);
+			uiCopied += uiBytes;
+			break;
+		}
+		else
+		{
+			memcpy(static_cast<hlByte *>(lpData) + uiCopied, static_cast<const hlByte *>(this->pView->GetView()) + uiViewPointer, static_cast<size_t>(uiViewBytes));
+			uiOffset += uiViewBytes;
+			uiCopied += uiViewBytes;
+			uiBytes -= static_cast<hlUInt>(uiViewBytes);
+		}
+	}
+
+	return static_cast<hlUInt>(uiCopied);
+}
+
+hlUInt CMappingStream::WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes)
+{
+	if(!this->bOpened)
 	{
-		LastError.SetErrorMessage("Stream not in write mode.");
 		return 0;
 	}
 
-	if(this->uiPointer == this->uiMappingSize)
+	if((this->uiMode & HL_MODE_WRITE) == 0)
 	{
+		LastError.SetErrorMessage("Stream not in write mode.");
 		return 0;
 	}
-	else
+
+	hlULongLong uiCopied = 0;
+	while(uiBytes && uiOffset < this->uiMappingSize)
 	{
-		hlULongLong uiOffset = 0;
-		while(uiBytes && this->uiPointer < this->uiMappingSize)
+		if(!this->Map(uiOffset))
 		{
-			if(!this->Map(this->uiPointer))
-			{
-				break;
-			}
+			break;
+		}
 
-			hlULongLong uiViewPointer = this->uiPointer - (this->pView->GetAllocationOffset() + this->pView->GetOffset() - this->uiMappingOffset);
-			hlULongLong uiViewBytes = this->pView->GetLength() - uiViewPointer;
+		hlULongLong uiViewPointer = uiOffset - (this->pView->GetAllocationOffset() + this->pView->GetOffset() - this->uiMappingOffset);
+		hlULongLong uiViewBytes = this->pView->GetLength() - uiViewPointer;
 
-			if(uiViewBytes >= uiBytes)
-			{
-				memcpy(static_cast<hlByte *>(const_cast<hlVoid *>(this->pView->GetView())) + uiViewPointer, static_cast<const hlByte *>(lpData) + uiOffset, uiBytes);
-				this->uiPointer += static_cast<hlULongLong>(uiBytes);
-				uiOffset += uiBytes;
-				break;
-			}
-			else
-			{
-				memcpy(static_cast<hlByte *>(const_cast<hlVoid *>(this->pView->GetView())) + uiViewPointer, static_cast<const hlByte *>(lpData) + uiOffset, static_cast<size_t>(uiViewBytes));
-				this->uiPointer += uiViewBytes;
-				uiOffset += uiViewBytes;
-				uiBytes -= static_cast<hlUInt>(uiViewBytes);
-			}
+		if(uiViewBytes >= uiBytes)
+		{
+			memcpy(static_cast<hlByte *>(const_cast<hlVoid *>(this->pView->GetView())) + uiViewPointer, static_cast<const hlByte *>(lpData) + uiCopied, uiBytes);
+			uiOffset += static_cast<hlULongLong>(uiBytes);
+			uiCopied += uiBytes;
+			break;
 		}
-
-		if(this->uiPointer > this->uiLength)
+		else
 		{
-			this->uiLength = this->uiPointer;
+			memcpy(static_cast<hlByte *>(const_cast<hlVoid *>(this->pView->GetView())) + uiViewPointer, static_cast<const hlByte *>(lpData) + uiCopied, static_cast<size_t>(uiViewBytes));
+			uiOffset += uiViewBytes;
+			uiCopied += uiViewBytes;
+			uiBytes -= static_cast<hlUInt>(uiViewBytes);
 		}
+	}
 
-		return static_cast<hlUInt>(uiOffset);
+	if(uiOffset > this->uiLength)
+	{
+		this->uiLength = uiOffset;
 	}
+
+	return static_cast<hlUInt>(uiCopied);
 }
 
 hlBool CMappingStream::Map(hlULongLong uiPointer)
@@ -346,5 +372,51 @@ hlBool CMappingStream::Map(hlULongLong uiPointer)
 
 	hlULongLong uiLength = uiPointer + this->uiViewSize > this->uiMappingSize ? this->uiMappingSize - uiPointer : this->uiViewSize;
 
-	return this->Mapping.Map(this->pView, this->uiMappingOffset + uiPointer, uiLength);
+	return this->pMapping->Map(this->pView, this->uiMappingOffset + uiPointer, uiLength);
+}
+
+//
+// ReadBatch()
+// Reads the requests in offset order, so that each view is only mapped once
+// however the requests are ordered.
+//
+hlBool CMappingStream::ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount)
+{
+	if(!this->bOpened)
+	{
+		return hlFalse;
+	}
+
+	if((this->uiMode & HL_MODE_READ) == 0)
+	{
+		LastError.SetErrorMessage("Stream not in read mode.");
+		return hlFalse;
+	}
+
+	std::vector<hlUInt> Order;
+	SortStreamSegments(lpRequests, uiCount, Order);
+
+	for(hlUInt i = 0; i < uiCount; i++)
+	{
+		StreamReadRequest &Request = lpRequests[Order[i]];
+
+		Request.uiBytesRead = this->ReadAt(Request.uiOffset, Request.lpData, Request.uiBytes);
+	}
+
+	return hlTrue;
+}
+
+hlVoid CMappingStream::Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint)
+{
+	if(!this->bOpened || uiOffset >= this->uiMappingSize)
+	{
+		return;
+	}
+
+	if(uiLength > this->uiMappingSize - uiOffset)
+	{
+		uiLength = this->uiMappingSize - uiOffset;
+	}
+
+	this->pMapping->Advise(this->uiMappingOffset + uiOffset, uiLength, eHint);
 }
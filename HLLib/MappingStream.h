@@ -26,7 +26,7 @@ namespace HLLib
 			hlBool bOpened;
 			hlUInt uiMode;
 
-			Mapping::CMapping &Mapping;
+			Mapping::CMapping *pMapping;
 			Mapping::CView *pView;
 
 			hlULongLong uiMappingOffset;
@@ -40,6 +40,8 @@ namespace HLLib
 			CMappingStream(Mapping::CMapping &Mapping, hlULongLong uiMappingOffset, hlULongLong uiMappingSize, hlULongLong uiViewSize = 0);
 			~CMappingStream();
 
+			hlVoid Reset(Mapping::CMapping &Mapping, hlULongLong uiMappingOffset, hlULongLong uiMappingSize, hlULongLong uiViewSize = 0);
+
 			virtual HLStreamType GetType() const;
 
 			const Mapping::CMapping &GetMapping() const;
@@ -62,6 +64,13 @@ namespace HLLib
 			virtual hlBool Write(hlChar cChar);
 			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes);
 
+			virtual hlUInt ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			virtual hlUInt WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlBool ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount);
+
+			virtual hlVoid Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
 		private:
 			hlBool Map(hlULongLong uiPointer);
 		};
@@ -13,3 +13,4 @@
 #include "FileMapping.h"
 #include "MemoryMapping.h"
 #include "StreamMapping.h"
+#include "SubMapping.h"
@@ -25,6 +25,18 @@ CMemoryStream::~CMemoryStream()
 
 }
 
+//
+// Reset()
+// Closes the stream and points it at another buffer, see CMappingStream::Reset().
+//
+hlVoid CMemoryStream::Reset(hlVoid *lpData, hlULongLong uiBufferSize)
+{
+	this->Close();
+
+	this->lpData = lpData;
+	this->uiBufferSize = uiBufferSize;
+}
+
 HLStreamType CMemoryStream::GetType() const
 {
 	return HL_STREAM_MEMORY;
@@ -159,39 +171,11 @@ hlBool CMemoryStream::Read(hlChar &cChar)
 
 hlUInt CMemoryStream::Read(hlVoid *lpData, hlUInt uiBytes)
 {
-	if(!this->bOpened)
-	{
-		return 0;
-	}
+	uiBytes = this->ReadAt(this->uiPointer, lpData, uiBytes);
 
-	if((this->uiMode & HL_MODE_READ) == 0)
-	{
-		LastError.SetErrorMessage("Stream not in read mode.");
-		return 0;
-	}
+	this->uiPointer += static_cast<hlULongLong>(uiBytes);
 
-	if(this->uiPointer == this->uiLength)
-	{
-		return 0;
-	}
-	else if(this->uiPointer + static_cast<hlULongLong>(uiBytes) > this->uiLength) // This right?
-	{
-		uiBytes = static_cast<hlUInt>(this->uiLength - this->uiPointer);
-
-		memcpy(lpData, (hlByte *)this->lpData + this->uiPointer, uiBytes);
-
-		this->uiPointer = this->uiLength;
-
-		return uiBytes;
-	}
-	else
-	{
-		memcpy(lpData, (hlByte *)this->lpData + this->uiPointer, uiBytes);
-
-		this->uiPointer += static_cast<hlULongLong>(uiBytes);
-
-		return uiBytes;
-	}
+	return uiBytes;
 }
 
 hlBool CMemoryStream::Write(hlChar cChar)
@@ -225,48 +209,71 @@ hlBool CMemoryStream::Write(hlChar cChar)
 }
 
 hlUInt CMemoryStream::Write(const hlVoid *lpData, hlUInt uiBytes)
+{
+	uiBytes = this->WriteAt(this->uiPointer, lpData, uiBytes);
+
+	this->uiPointer += static_cast<hlULongLong>(uiBytes);
+
+	return uiBytes;
+}
+
+hlUInt CMemoryStream::ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes)
 {
 	if(!this->bOpened)
 	{
 		return 0;
 	}
 
-	if((this->uiMode & HL_MODE_WRITE) == 0)
+	if((this->uiMode & HL_MODE_READ) == 0)
 	{
-		LastError.SetErrorMessage("Stream not in write mode.");
+		LastError.SetErrorMessage("Stream not in read mode.");
 		return 0;
 	}
 
-	if(this->uiPointer == this->uiBufferSize)
+	if(uiOffset >= this->uiLength)
 	{
 		return 0;
 	}
-	else if(this->uiPointer + static_cast<hlULongLong>(uiBytes) > this->uiBufferSize)
+
+	if(uiOffset + static_cast<hlULongLong>(uiBytes) > this->uiLength)
 	{
-		uiBytes = static_cast<hlUInt>(this->uiBufferSize - this->uiPointer);
+		uiBytes = static_cast<hlUInt>(this->uiLength - uiOffset);
+	}
 
-		memcpy((hlByte *)this->lpData + this->uiPointer, lpData, uiBytes);
+	memcpy(lpData, (hlByte *)this->lpData + uiOffset, uiBytes);
 
-		this->uiPointer = this->uiBufferSize;
+	return uiBytes;
+}
 
-		if(this->uiPointer > this->uiLength)
-		{
-			this->uiLength = this->uiPointer;
-		}
+hlUInt CMemoryStream::WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes)
+{
+	if(!this->bOpened)
+	{
+		return 0;
+	}
 
-		return uiBytes;
+	if((this->uiMode & HL_MODE_WRITE) == 0)
+	{
+		LastError.SetErrorMessage("Stream not in write mode.");
+		return 0;
 	}
-	else
+
+	if(uiOffset >= this->uiBufferSize)
 	{
-		memcpy((hlByte *)this->lpData + this->uiPointer, lpData, uiBytes);
+		return 0;
+	}
 
-		this->uiPointer += static_cast<hlULongLong>(uiBytes);
+	if(uiOffset + static_cast<hlULongLong>(uiBytes) > this->uiBufferSize)
+	{
+		uiBytes = static_cast<hlUInt>(this->uiBufferSize - uiOffset);
+	}
 
-		if(this->uiPointer > this->uiLength)
-		{
-			this->uiLength = this->uiPointer;
-		}
+	memcpy((hlByte *)this->lpData + uiOffset, lpData, uiBytes);
 
-		return uiBytes;
+	if(uiOffset + static_cast<hlULongLong>(uiBytes) > this->uiLength)
+	{
+		this->uiLength = uiOffset + static_cast<hlULongLong>(uiBytes);
 	}
+
+	return uiBytes;
 }
@@ -35,6 +35,8 @@ namespace HLLib
 			CMemoryStream(hlVoid *lpData, hlULongLong uiBufferSize);
 			~CMemoryStream();
 
+			hlVoid Reset(hlVoid *lpData, hlULongLong uiBufferSize);
+
 			virtual HLStreamType GetType() const;
 
 			const hlVoid *GetBuffer() const;
@@ -57,6 +59,9 @@ namespace HLLib
 
 			virtual hlBool Write(hlChar iChar);
 			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlUInt ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			virtual hlUInt WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes);
 		};
 	}
 }
@@ -0,0 +1,74 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#include "HLLib.h"
+#include "Mutex.h"
+
+using namespace HLLib;
+
+CMutex::CMutex()
+{
+#ifdef _WIN32
+	InitializeCriticalSection(&this->CriticalSection);
+#else
+	pthread_mutexattr_t Attributes;
+	pthread_mutexattr_init(&Attributes);
+	pthread_mutexattr_settype(&Attributes, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&this->Mutex, &Attributes);
+	pthread_mutexattr_destroy(&Attributes);
+#endif
+}
+
+CMutex::~CMutex()
+{
+#ifdef _WIN32
+	DeleteCriticalSection(&this->CriticalSection);
+#else
+	pthread_mutex_destroy(&this->Mutex);
+#endif
+}
+
+hlVoid CMutex::Lock()
+{
+#ifdef _WIN32
+	EnterCriticalSection(&this->CriticalSection);
+#else
+	pthread_mutex_lock(&this->Mutex);
+#endif
+}
+
+hlBool CMutex::TryLock()
+{
+#ifdef _WIN32
+	return TryEnterCriticalSection(&this->CriticalSection) != 0;
+#else
+	return pthread_mutex_trylock(&this->Mutex) == 0;
+#endif
+}
+
+hlVoid CMutex::Unlock()
+{
+#ifdef _WIN32
+	LeaveCriticalSection(&this->CriticalSection);
+#else
+	pthread_mutex_unlock(&this->Mutex);
+#endif
+}
+
+CMutexLock::CMutexLock(CMutex &Mutex) : Mutex(Mutex)
+{
+	this->Mutex.Lock();
+}
+
+CMutexLock::~CMutexLock()
+{
+	this->Mutex.Unlock();
+}
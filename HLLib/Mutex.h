@@ -0,0 +1,67 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#ifndef MUTEX_H
+#define MUTEX_H
+
+#include "stdafx.h"
+
+#ifndef _WIN32
+#	include <pthread.h>
+#endif
+
+namespace HLLib
+{
+	//
+	// A recursive lock.  A thread holding one mutex may only block on another in a
+	// fixed order; anything else must use TryLock().
+	//
+	class CMutex
+	{
+	private:
+#ifdef _WIN32
+		CRITICAL_SECTION CriticalSection;
+#else
+		pthread_mutex_t Mutex;
+#endif
+
+	public:
+		CMutex();
+		~CMutex();
+
+		hlVoid Lock();
+		hlBool TryLock();
+		hlVoid Unlock();
+
+	private:
+		CMutex(const CMutex &);
+		CMutex &operator=(const CMutex &);
+	};
+
+	//
+	// Holds a mutex until it goes out of scope.
+	//
+	class CMutexLock
+	{
+	private:
+		CMutex &Mutex;
+
+	public:
+		CMutexLock(CMutex &Mutex);
+		~CMutexLock();
+
+	private:
+		CMutexLock(const CMutexLock &);
+		CMutexLock &operator=(const CMutexLock &);
+	};
+}
+
+#endif
@@ -230,7 +230,7 @@ hlVoid CNCFFile::UnmapDataStructures()
 
 CDirectoryFolder *CNCFFile::CreateRoot()
 {
-	CDirectoryFolder *pRoot = new CDirectoryFolder("root", 0, 0, this, 0);
+	CDirectoryFolder *pRoot = new CDirectoryFolder("root", 0, 0, this, 0, &this->GetDirectoryArena());
 
 	this->CreateRoot(pRoot);
 
@@ -249,7 +249,7 @@ hlVoid CNCFFile::CreateRoot(CDirectoryFolder *pFolder)
 		if((this->lpDirectoryEntries[uiIndex].uiDirectoryFlags & HL_NCF_FLAG_FILE) == 0)
 		{
 			// Add the directory item to the current folder.
-			CDirectoryFolder *pSubFolder = pFolder->AddFolder(this->lpDirectoryNames + this->lpDirectoryEntries[uiIndex].uiNameOffset, uiIndex);
+			CDirectoryFolder *pSubFolder = pFolder->AddFolder(this->lpDirectoryNames + this->lpDirectoryEntries[uiIndex].uiNameOffset, uiIndex, 0, hlFalse);
 
 			// Build the new folder.
 			this->CreateRoot(pSubFolder);
@@ -257,7 +257,7 @@ hlVoid CNCFFile::CreateRoot(CDirectoryFolder *pFolder)
 		else
 		{
 			// Add the directory item to the current folder.
-			pFolder->AddFile(this->lpDirectoryNames + this->lpDirectoryEntries[uiIndex].uiNameOffset, uiIndex);
+			pFolder->AddFile(this->lpDirectoryNames + this->lpDirectoryEntries[uiIndex].uiNameOffset, uiIndex, 0, hlFalse);
 		}
 
 		// Get the next directory item.
@@ -560,7 +560,7 @@ hlBool CNCFFile::CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStr
 			if(this->lpDirectoryEntries[pFile->GetID()].uiItemSize == 0)
 			{
 				// Fake an empty stream.
-				pStream = new Streams::CNullStream();
+				pStream = this->CreateNullStream();
 				return hlTrue;
 			}
 			else
@@ -80,7 +80,7 @@ hlVoid CPAKFile::UnmapDataStructures()
 
 CDirectoryFolder *CPAKFile::CreateRoot()
 {
-	CDirectoryFolder *pRoot = new CDirectoryFolder(this);
+	CDirectoryFolder *pRoot = new CDirectoryFolder(this, &this->GetDirectoryArena());
 
 	hlUInt uiItemCount = this->pHeader->uiDirectoryLength / sizeof(PAKDirectoryItem);
 
@@ -151,7 +151,14 @@ hlBool CPAKFile::CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStr
 {
 	const PAKDirectoryItem *pDirectoryItem = this->lpDirectoryItems + pFile->GetID();
 
-	pStream = new Streams::CMappingStream(*this->pMapping, pDirectoryItem->uiItemOffset, pDirectoryItem->uiItemLength);
+	pStream = this->CreateMappingStream(*this->pMapping, pDirectoryItem->uiItemOffset, pDirectoryItem->uiItemLength);
 
 	return hlTrue;
 }
+
+hlBool CPAKFile::MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const
+{
+	const PAKDirectoryItem *pDirectoryItem = this->lpDirectoryItems + pFile->GetID();
+
+	return this->pMapping->Map(pView, pDirectoryItem->uiItemOffset, pDirectoryItem->uiItemLength);
+}
@@ -16,9 +16,31 @@
 
 using namespace HLLib;
 
-CPackage::CPackage() : bDeleteStream(hlFalse), bDeleteMapping(hlFalse), pStream(0), pMapping(0), pRoot(0), pStreams(0)
+// Index of the pool released streams of type eType are kept in, or -1 if
+// they can't be reset for reuse.
+static hlInt GetStreamPoolIndex(HLStreamType eType)
 {
+	switch(eType)
+	{
+	case HL_STREAM_GCF:
+		return 0;
+	case HL_STREAM_MAPPING:
+		return 1;
+	case HL_STREAM_MEMORY:
+		return 2;
+	case HL_STREAM_NULL:
+		return 3;
+	default:
+		return -1;
+	}
+}
 
+CPackage::CPackage() : bDeleteStream(hlFalse), bDeleteMapping(hlFalse), pStream(0), pStreamPackage(0), pMapping(0), pRoot(0), pDirectoryArena(0), pStreams(0), pFreeStreamSlots(0), pViews(0), pFreeViewSlots(0), pInflateIndices(0)
+{
+	for(hlUInt i = 0; i < HL_PACKAGE_STREAM_POOL_COUNT; i++)
+	{
+		this->lpStreamPools[i] = 0;
+	}
 }
 
 CPackage::~CPackage()
@@ -26,7 +48,10 @@ CPackage::~CPackage()
 	assert(this->pStream == 0);
 	assert(this->pMapping == 0);
 	assert(this->pRoot == 0);
+	assert(this->pDirectoryArena == 0);
 	assert(this->pStreams == 0);
+	assert(this->pViews == 0);
+	assert(this->pInflateIndices == 0);
 }
 
 hlBool CPackage::GetOpened() const
@@ -46,10 +71,18 @@ hlBool CPackage::Open(Mapping::CMapping &Mapping, hlUInt uiMode)
 
 hlBool CPackage::Open(const hlChar *lpFileName, hlUInt uiMode)
 {
-	if(uiMode & HL_MODE_NO_FILEMAPPING)
+	// Asynchronous and direct I/O need a stream, memory mapped files fault their
+	// pages in through the page cache.
+	if(uiMode & HL_MODE_DIRECT_IO)
 	{
+		// The file stream already buffers unaligned direct I/O itself.
 		return this->Open(new Streams::CFileStream(lpFileName), uiMode, hlTrue);
 	}
+	else if(uiMode & (HL_MODE_NO_FILEMAPPING | HL_MODE_ASYNC_IO))
+	{
+		// Buffer small reads and writes so they don't each cost a system call.
+		return this->Open(new Streams::CBufferedStream(new Streams::CFileStream(lpFileName), hlTrue), uiMode, hlTrue);
+	}
 	else
 	{
 		return this->Open(new Mapping::CFileMapping(lpFileName), uiMode, hlTrue);
@@ -63,7 +96,87 @@ hlBool CPackage::Open(hlVoid *lpData, hlUInt uiBufferSize, hlUInt uiMode)
 
 hlBool CPackage::Open(hlVoid *pUserData, hlUInt uiMode)
 {
-	return this->Open(new Streams::CProcStream(pUserData), uiMode, hlTrue);
+	Streams::CProcStream *pStream = new Streams::CProcStream(pUserData);
+
+	// Map memory resident backends in place instead of copying them through a
+	// stream mapping.  The proc stream stays open until the package is closed.
+	if(pGetPointerProc != 0 && (uiMode & HL_MODE_WRITE) == 0 && pStream->Open(uiMode))
+	{
+		if(pStream->GetBuffer() != 0)
+		{
+			if(!this->Open(new Mapping::CMemoryMapping(const_cast<hlVoid *>(pStream->GetBuffer()), pStream->GetBufferSize()), uiMode, hlTrue))
+			{
+				delete pStream;
+				return hlFalse;
+			}
+
+			this->pStream = pStream;
+			this->bDeleteStream = hlTrue;
+
+			return hlTrue;
+		}
+
+		pStream->Close();
+	}
+
+	return this->Open(pStream, uiMode, hlTrue);
+}
+
+//
+// Open()
+// Opens a file inside another package as a package.  Files stored contiguously
+// are parsed straight off the other package's mapping, anything else through
+// one of its streams.  The other package has to stay open until this one is
+// closed.
+//
+hlBool CPackage::Open(const CDirectoryFile &File, hlUInt uiMode)
+{
+	const CPackage *pPackage = File.GetPackage();
+
+	if(pPackage == this)
+	{
+		LastError.SetErrorMessage("Package can't be opened inside itself.");
+		return hlFalse;
+	}
+
+	if(!pPackage->GetOpened())
+	{
+		LastError.SetErrorMessage("Package not opened.");
+		return hlFalse;
+	}
+
+	// Stream mappings would read the whole file in to map it.
+	if((uiMode & HL_MODE_WRITE) == 0 && pPackage->GetMapping()->GetType() != HL_MAPPING_STREAM)
+	{
+		Mapping::CView *pView = 0;
+		if(pPackage->MapContents(&File, pView))
+		{
+			Mapping::CMapping *pMapping = pView->GetMapping();
+			hlULongLong uiOffset = pView->GetAllocationOffset() + pView->GetOffset();
+			hlULongLong uiLength = pView->GetLength();
+
+			pPackage->UnmapContents(pView);
+
+			return this->Open(new Mapping::CSubMapping(*pMapping, uiOffset, uiLength), uiMode, hlTrue);
+		}
+	}
+
+	Streams::IStream *pStream = 0;
+	if(!pPackage->CreateStream(&File, pStream))
+	{
+		return hlFalse;
+	}
+
+	if(!this->Open(pStream, uiMode, hlFalse))
+	{
+		pPackage->ReleaseStream(pStream);
+		return hlFalse;
+	}
+
+	this->bDeleteStream = hlTrue;
+	this->pStreamPackage = pPackage;
+
+	return hlTrue;
 }
 
 hlBool CPackage::Open(Streams::IStream *pStream, hlUInt uiMode, hlBool bDeleteStream)
@@ -89,7 +202,14 @@ hlBool CPackage::Open(Streams::IStream *pStream, hlUInt uiMode, hlBool bDeleteSt
 		return hlFalse;
 	}
 
-	this->pStreams = new CStreamList();
+	this->pStreams = new CStreamVector();
+	this->pFreeStreamSlots = new CStreamSlotVector();
+	for(hlUInt i = 0; i < HL_PACKAGE_STREAM_POOL_COUNT; i++)
+	{
+		this->lpStreamPools[i] = new CStreamVector();
+	}
+	this->pViews = new Mapping::CViewVector();
+	this->pFreeViewSlots = new Mapping::CViewSlotVector();
 
 	return hlTrue;
 }
@@ -114,7 +234,14 @@ hlBool CPackage::Open(Mapping::CMapping *pMapping, hlUInt uiMode, hlBool bDelete
 		return hlFalse;
 	}
 
-	this->pStreams = new CStreamList();
+	this->pStreams = new CStreamVector();
+	this->pFreeStreamSlots = new CStreamSlotVector();
+	for(hlUInt i = 0; i < HL_PACKAGE_STREAM_POOL_COUNT; i++)
+	{
+		this->lpStreamPools[i] = new CStreamVector();
+	}
+	this->pViews = new Mapping::CViewVector();
+	this->pFreeViewSlots = new Mapping::CViewSlotVector();
 
 	return hlTrue;
 }
@@ -123,26 +250,71 @@ hlVoid CPackage::Close()
 {
 	if(this->pStreams != 0)
 	{
-		for(CStreamList::iterator i = this->pStreams->begin(); i != this->pStreams->end(); ++i)
+		for(CStreamVector::iterator i = this->pStreams->begin(); i != this->pStreams->end(); ++i)
 		{
 			Streams::IStream *pStream = *i;
 
-			pStream->Close();
-			this->ReleaseStreamInternal(*pStream);
-			delete pStream;
+			if(pStream != 0)
+			{
+				pStream->Close();
+				this->ReleaseStreamInternal(*pStream);
+				delete pStream;
+			}
 		}
 
 		delete this->pStreams;
 		this->pStreams = 0;
+
+		delete this->pFreeStreamSlots;
+		this->pFreeStreamSlots = 0;
 	}
 
-	if(this->pMapping != 0)
+	for(hlUInt i = 0; i < HL_PACKAGE_STREAM_POOL_COUNT; i++)
 	{
-		this->UnmapDataStructures();
+		if(this->lpStreamPools[i] != 0)
+		{
+			for(CStreamVector::iterator j = this->lpStreamPools[i]->begin(); j != this->lpStreamPools[i]->end(); ++j)
+			{
+				delete *j;
+			}
 
-		this->pMapping->Close();
+			delete this->lpStreamPools[i];
+			this->lpStreamPools[i] = 0;
+		}
+	}
+
+	if(this->pViews != 0)
+	{
+		for(Mapping::CViewVector::iterator i = this->pViews->begin(); i != this->pViews->end(); ++i)
+		{
+			Mapping::CView *pView = *i;
+
+			if(pView != 0)
+			{
+				pView->GetMapping()->Unmap(pView);
+			}
+		}
+
+		delete this->pViews;
+		this->pViews = 0;
+
+		delete this->pFreeViewSlots;
+		this->pFreeViewSlots = 0;
+	}
+
+	if(this->pInflateIndices != 0)
+	{
+		for(CInflateIndexMap::iterator i = this->pInflateIndices->begin(); i != this->pInflateIndices->end(); ++i)
+		{
+			delete i->second;
+		}
+
+		delete this->pInflateIndices;
+		this->pInflateIndices = 0;
 	}
 
+	// Items can name themselves straight out of the mapped directory, so the tree
+	// goes before the data structures it points into.
 	if(this->pRoot != 0)
 	{
 		this->ReleaseRoot();
@@ -150,6 +322,16 @@ hlVoid CPackage::Close()
 		this->pRoot = 0;
 	}
 
+	if(this->pMapping != 0)
+	{
+		this->UnmapDataStructures();
+
+		this->pMapping->Close();
+	}
+
+	delete this->pDirectoryArena;
+	this->pDirectoryArena = 0;
+
 	if(this->bDeleteMapping)
 	{
 		delete this->pMapping;
@@ -159,10 +341,18 @@ hlVoid CPackage::Close()
 
 	if(this->bDeleteStream)
 	{
-		delete this->pStream;
+		if(this->pStreamPackage != 0)
+		{
+			this->pStreamPackage->ReleaseStream(this->pStream);
+		}
+		else
+		{
+			delete this->pStream;
+		}
 		this->bDeleteStream = hlFalse;
 	}
 	this->pStream = 0;
+	this->pStreamPackage = 0;
 }
 
 hlBool CPackage::Defragment()
@@ -209,6 +399,7 @@ CDirectoryFolder *CPackage::GetRoot()
 	{
 		this->pRoot = this->CreateRoot();
 		this->pRoot->Sort();
+		this->pRoot->BuildPathIndex();
 	}
 
 	return this->pRoot;
@@ -229,6 +420,22 @@ hlVoid CPackage::ReleaseRoot()
 
 }
 
+//
+// GetDirectoryArena()
+// Returns the arena CreateRoot() and MapDataStructures() allocate the directory
+// tree and per-entry structures from.  It is released after ReleaseRoot() and
+// UnmapDataStructures() on Close(), so nothing allocated from it needs freeing.
+//
+CDirectoryArena &CPackage::GetDirectoryArena()
+{
+	if(this->pDirectoryArena == 0)
+	{
+		this->pDirectoryArena = new CDirectoryArena();
+	}
+
+	return *this->pDirectoryArena;
+}
+
 hlUInt CPackage::GetAttributeCount() const
 {
 	if(!this->GetOpened())
@@ -404,28 +611,36 @@ hlBool CPackage::CreateStream(const CDirectoryFile *pFile, Streams::IStream *&pS
 		return hlFalse;
 	}
 
-	this->pStreams->push_back(pStream);
+	if(this->pFreeStreamSlots->empty())
+	{
+		pStream->uiSlot = static_cast<hlUInt>(this->pStreams->size());
+		this->pStreams->push_back(pStream);
+	}
+	else
+	{
+		pStream->uiSlot = this->pFreeStreamSlots->back();
+		this->pFreeStreamSlots->pop_back();
+		(*this->pStreams)[pStream->uiSlot] = pStream;
+	}
+
 	return hlTrue;
 }
 
 hlVoid CPackage::ReleaseStream(Streams::IStream *pStream) const
 {
-	if(!this->GetOpened())
+	if(!this->GetOpened() || pStream == 0)
 	{
 		return;
 	}
 
-	for(CStreamList::iterator i = this->pStreams->begin(); i != this->pStreams->end(); ++i)
+	if(pStream->uiSlot < this->pStreams->size() && (*this->pStreams)[pStream->uiSlot] == pStream)
 	{
-		if(*i == pStream)
-		{
-			pStream->Close();
-			this->ReleaseStreamInternal(*pStream);
-			delete pStream;
+		(*this->pStreams)[pStream->uiSlot] = 0;
+		this->pFreeStreamSlots->push_back(pStream->uiSlot);
 
-			this->pStreams->erase(i);
-			break;
-		}
+		pStream->Close();
+		this->ReleaseStreamInternal(*pStream);
+		this->DeleteStream(pStream);
 	}
 }
 
@@ -433,3 +648,164 @@ hlVoid CPackage::ReleaseStreamInternal(Streams::IStream &) const
 {
 
 }
+
+//
+// MapContents()
+// Maps the on disk data of a file directly so that it can be read without
+// copying.  Only possible when the file is stored uncompressed in a single
+// contiguous range of the package (or one of its archives).  Without file
+// mapping the package sits on a stream mapping, which reads the range into a
+// buffer of its own, so the view is a copy held until UnmapContents().
+//
+hlBool CPackage::MapContents(const CDirectoryFile *pFile, Mapping::CView *&pView) const
+{
+	pView = 0;
+
+	if(!this->GetOpened() || pFile == 0 || pFile->GetPackage() != this)
+	{
+		LastError.SetErrorMessage("File does not belong to package.");
+		return hlFalse;
+	}
+
+	// A zero length view would cover the whole allocation, so there is nothing to map.
+	hlUInt uiSize = 0;
+	if(!this->GetFileSizeInternal(pFile, uiSize))
+	{
+		return hlFalse;
+	}
+
+	if(uiSize == 0)
+	{
+		LastError.SetErrorMessage("File is empty.");
+		return hlFalse;
+	}
+
+	if(!this->MapContentsInternal(pFile, pView))
+	{
+		return hlFalse;
+	}
+
+	if(this->pFreeViewSlots->empty())
+	{
+		pView->uiPackageSlot = static_cast<hlUInt>(this->pViews->size());
+		this->pViews->push_back(pView);
+	}
+	else
+	{
+		pView->uiPackageSlot = this->pFreeViewSlots->back();
+		this->pFreeViewSlots->pop_back();
+		(*this->pViews)[pView->uiPackageSlot] = pView;
+	}
+
+	return hlTrue;
+}
+
+hlVoid CPackage::UnmapContents(Mapping::CView *pView) const
+{
+	if(!this->GetOpened() || pView == 0)
+	{
+		return;
+	}
+
+	if(pView->uiPackageSlot < this->pViews->size() && (*this->pViews)[pView->uiPackageSlot] == pView)
+	{
+		(*this->pViews)[pView->uiPackageSlot] = 0;
+		this->pFreeViewSlots->push_back(pView->uiPackageSlot);
+
+		pView->GetMapping()->Unmap(pView);
+	}
+}
+
+hlBool CPackage::MapContentsInternal(const CDirectoryFile *, Mapping::CView *&) const
+{
+	LastError.SetErrorMessage("File contents are not stored contiguously.");
+	return hlFalse;
+}
+
+Streams::CInflateIndex *CPackage::GetInflateIndex(hlULongLong uiOffset, hlULongLong uiLength) const
+{
+	if(uiInflateCheckpointSpacing == 0 || uiLength <= uiInflateCheckpointSpacing)
+	{
+		return 0;
+	}
+
+	if(this->pInflateIndices == 0)
+	{
+		this->pInflateIndices = new CInflateIndexMap();
+	}
+
+	CInflateIndexMap::iterator i = this->pInflateIndices->find(uiOffset);
+	if(i == this->pInflateIndices->end())
+	{
+		i = this->pInflateIndices->insert(CInflateIndexMap::value_type(uiOffset, new Streams::CInflateIndex())).first;
+	}
+
+	return i->second;
+}
+
+Streams::IStream *CPackage::CreateMappingStream(Mapping::CMapping &Mapping, hlULongLong uiMappingOffset, hlULongLong uiMappingSize) const
+{
+	Streams::CMappingStream *pStream = static_cast<Streams::CMappingStream *>(this->GetPooledStream(HL_STREAM_MAPPING));
+	if(pStream == 0)
+	{
+		return new Streams::CMappingStream(Mapping, uiMappingOffset, uiMappingSize);
+	}
+
+	pStream->Reset(Mapping, uiMappingOffset, uiMappingSize);
+	return pStream;
+}
+
+Streams::IStream *CPackage::CreateMemoryStream(hlVoid *lpData, hlULongLong uiBufferSize) const
+{
+	Streams::CMemoryStream *pStream = static_cast<Streams::CMemoryStream *>(this->GetPooledStream(HL_STREAM_MEMORY));
+	if(pStream == 0)
+	{
+		return new Streams::CMemoryStream(lpData, uiBufferSize);
+	}
+
+	pStream->Reset(lpData, uiBufferSize);
+	return pStream;
+}
+
+Streams::IStream *CPackage::CreateNullStream() const
+{
+	Streams::IStream *pStream = this->GetPooledStream(HL_STREAM_NULL);
+	if(pStream == 0)
+	{
+		return new Streams::CNullStream();
+	}
+
+	return pStream;
+}
+
+Streams::IStream *CPackage::GetPooledStream(HLStreamType eType) const
+{
+	hlInt iPool = GetStreamPoolIndex(eType);
+	if(iPool < 0 || this->lpStreamPools[iPool] == 0 || this->lpStreamPools[iPool]->empty())
+	{
+		return 0;
+	}
+
+	Streams::IStream *pStream = this->lpStreamPools[iPool]->back();
+	this->lpStreamPools[iPool]->pop_back();
+
+	return pStream;
+}
+
+//
+// DeleteStream()
+// Keeps closed streams that can be reset for reuse, up to HL_STREAM_POOL_SIZE of
+// each type, and deletes the rest.
+//
+hlVoid CPackage::DeleteStream(Streams::IStream *pStream) const
+{
+	hlInt iPool = GetStreamPoolIndex(pStream->GetType());
+	if(iPool >= 0 && this->lpStreamPools[iPool] != 0 && static_cast<hlULongLong>(this->lpStreamPools[iPool]->size()) < uiStreamPoolSize)
+	{
+		this->lpStreamPools[iPool]->push_back(pStream);
+	}
+	else
+	{
+		delete pStream;
+	}
+}
@@ -16,10 +16,15 @@
 #include "DirectoryItems.h"
 #include "Mapping.h"
 #include "Stream.h"
+#include "InflateStream.h"
 
 namespace HLLib
 {
-	typedef std::list<Streams::IStream *> CStreamList;
+	typedef std::vector<Streams::IStream *> CStreamVector;
+	typedef std::vector<hlUInt> CStreamSlotVector;
+	typedef std::map<hlULongLong, Streams::CInflateIndex *> CInflateIndexMap;
+
+	#define HL_PACKAGE_STREAM_POOL_COUNT 4
 
 	class HLLIB_API CPackage
 	{
@@ -28,13 +33,31 @@ namespace HLLib
 		hlBool bDeleteMapping;
 		Streams::IStream *pStream;
 
+		// Package pStream was created by, which has to release it.
+		const CPackage *pStreamPackage;
+
 	protected:
 		Mapping::CMapping *pMapping;
 
 		CDirectoryFolder *pRoot;
 
 	private:
-		mutable CStreamList *pStreams;
+		// Holds the directory tree and per-entry structures; released on Close().
+		CDirectoryArena *pDirectoryArena;
+
+		// Live streams by slot; unused slots are null and listed in pFreeStreamSlots.
+		mutable CStreamVector *pStreams;
+		mutable CStreamSlotVector *pFreeStreamSlots;
+
+		// Released streams kept for reuse, one pool per reusable stream type.
+		mutable CStreamVector *lpStreamPools[HL_PACKAGE_STREAM_POOL_COUNT];
+
+		// Views handed out by MapContents() by slot; unused slots are null and listed
+		// in pFreeViewSlots.
+		mutable Mapping::CViewVector *pViews;
+		mutable Mapping::CViewSlotVector *pFreeViewSlots;
+
+		mutable CInflateIndexMap *pInflateIndices;
 
 	public:
 		CPackage();
@@ -51,6 +74,7 @@ namespace HLLib
 		hlBool Open(const hlChar *lpFileName, hlUInt uiMode);
 		hlBool Open(hlVoid *lpData, hlUInt uiBufferSize, hlUInt uiMode);
 		hlBool Open(hlVoid *pUserData, hlUInt uiMode);
+		hlBool Open(const CDirectoryFile &File, hlUInt uiMode);
 		hlVoid Close();
 
 		hlBool Defragment();
@@ -75,6 +99,9 @@ namespace HLLib
 		hlBool CreateStream(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
 		hlVoid ReleaseStream(Streams::IStream *pStream) const;
 
+		hlBool MapContents(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
+		hlVoid UnmapContents(Mapping::CView *pView) const;
+
 	protected:
 		virtual hlBool MapDataStructures() = 0;
 		virtual hlVoid UnmapDataStructures() = 0;
@@ -100,9 +127,27 @@ namespace HLLib
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const = 0;
 		virtual hlVoid ReleaseStreamInternal(Streams::IStream &Stream) const;
 
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
+
+		// Returns the inflate checkpoints of the deflated data at uiOffset in the mapping
+		// or 0 if uiLength is too short to need any.  Kept until the package is closed.
+		Streams::CInflateIndex *GetInflateIndex(hlULongLong uiOffset, hlULongLong uiLength) const;
+
+		// Stream factories for CreateStreamInternal() that reuse released streams.
+		Streams::IStream *CreateMappingStream(Mapping::CMapping &Mapping, hlULongLong uiMappingOffset, hlULongLong uiMappingSize) const;
+		Streams::IStream *CreateMemoryStream(hlVoid *lpData, hlULongLong uiBufferSize) const;
+		Streams::IStream *CreateNullStream() const;
+
+		// Takes a released stream of type eType out of its pool, or returns 0.
+		Streams::IStream *GetPooledStream(HLStreamType eType) const;
+
+		CDirectoryArena &GetDirectoryArena();
+
 	private:
 		hlBool Open(Streams::IStream *pStream, hlUInt uiMode, hlBool bDeleteStream);
 		hlBool Open(Mapping::CMapping *pMapping, hlUInt uiMode, hlBool bDeleteMapping);
+
+		hlVoid DeleteStream(Streams::IStream *pStream) const;
 	};
 }
 
@@ -15,7 +15,7 @@
 using namespace HLLib;
 using namespace HLLib::Streams;
 
-CProcStream::CProcStream(hlVoid *pUserData) : bOpened(hlFalse), uiMode(HL_MODE_INVALID), pUserData(pUserData)
+CProcStream::CProcStream(hlVoid *pUserData) : bOpened(hlFalse), uiMode(HL_MODE_INVALID), pUserData(pUserData), lpData(0), uiBufferSize(0)
 {
 
 }
@@ -35,6 +35,16 @@ const hlChar *CProcStream::GetFileName() const
 	return "";
 }
 
+const hlVoid *CProcStream::GetBuffer() const
+{
+	return this->lpData;
+}
+
+hlULongLong CProcStream::GetBufferSize() const
+{
+	return this->uiBufferSize;
+}
+
 hlBool CProcStream::GetOpened() const
 {
 	return this->bOpened;
@@ -64,6 +74,17 @@ hlBool CProcStream::Open(hlUInt uiMode)
 	this->bOpened = hlTrue;
 	this->uiMode = uiMode;
 
+	// The pointer is only any use with the size to go with it; without a size proc
+	// the stream is read through the procs like any other.
+	if(pGetPointerProc != 0 && (pSizeExProc != 0 || pSizeProc != 0))
+	{
+		this->lpData = pGetPointerProc(this->pUserData);
+		if(this->lpData != 0)
+		{
+			this->uiBufferSize = this->GetStreamSize();
+		}
+	}
+
 	return hlTrue;
 }
 
@@ -77,6 +98,9 @@ hlVoid CProcStream::Close()
 		}
 		this->bOpened = hlFalse;
 		this->uiMode = HL_MODE_INVALID;
+
+		this->lpData = 0;
+		this->uiBufferSize = 0;
 	}
 }
 
@@ -255,3 +279,152 @@ hlUInt CProcStream::Write(const hlVoid *lpData, hlUInt uiBytes)
 
 	return uiBytesWritten;
 }
+
+//
+// ReadAt()
+// Copies straight out of memory resident backends and uses pReadAtProc when
+// it is set.  Otherwise seek there, read, and seek back to where the caller
+// left the stream; that fallback is not positional and must not run
+// alongside Read() or another ReadAt() on the same stream.
+//
+hlUInt CProcStream::ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes)
+{
+	if(!this->bOpened)
+	{
+		return 0;
+	}
+
+	if((this->uiMode & HL_MODE_READ) == 0)
+	{
+		LastError.SetErrorMessage("Stream not in read mode.");
+		return 0;
+	}
+
+	if(this->lpData != 0)
+	{
+		if(uiOffset >= this->uiBufferSize)
+		{
+			return 0;
+		}
+
+		if(static_cast<hlULongLong>(uiBytes) > this->uiBufferSize - uiOffset)
+		{
+			uiBytes = static_cast<hlUInt>(this->uiBufferSize - uiOffset);
+		}
+
+		memcpy(lpData, static_cast<const hlByte *>(this->lpData) + uiOffset, uiBytes);
+
+		return uiBytes;
+	}
+
+	if(pReadAtProc != 0)
+	{
+		hlUInt uiBytesRead = static_cast<hlUInt>(pReadAtProc(lpData, uiBytes, uiOffset, this->pUserData));
+
+		// Nothing read is only a failure before the end of the stream.
+		if(uiBytesRead == 0 && uiBytes != 0 && uiOffset < this->GetStreamSize())
+		{
+			LastError.SetErrorMessage("pReadAtProc() failed.");
+		}
+
+		return uiBytesRead;
+	}
+
+	if(pReadProc == 0)
+	{
+		LastError.SetErrorMessage("pReadProc not set.");
+		return 0;
+	}
+
+	hlULongLong uiPointer = this->GetStreamPointer();
+
+	if(this->Seek(static_cast<hlLongLong>(uiOffset), HL_SEEK_BEGINNING) != uiOffset)
+	{
+		return 0;
+	}
+
+	hlUInt uiBytesRead = pReadProc(lpData, uiBytes, this->pUserData);
+
+	if(uiBytesRead == 0 && uiBytes != 0 && uiOffset < this->GetStreamSize())
+	{
+		LastError.SetErrorMessage("pReadProc() failed.");
+	}
+
+	this->Seek(static_cast<hlLongLong>(uiPointer), HL_SEEK_BEGINNING);
+
+	return uiBytesRead;
+}
+
+hlUInt CProcStream::WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes)
+{
+	if(!this->bOpened)
+	{
+		return 0;
+	}
+
+	if((this->uiMode & HL_MODE_WRITE) == 0)
+	{
+		LastError.SetErrorMessage("Stream not in write mode.");
+		return 0;
+	}
+
+	if(pWriteProc == 0)
+	{
+		LastError.SetErrorMessage("pWriteProc not set.");
+		return 0;
+	}
+
+	hlULongLong uiPointer = this->GetStreamPointer();
+
+	if(this->Seek(static_cast<hlLongLong>(uiOffset), HL_SEEK_BEGINNING) != uiOffset)
+	{
+		return 0;
+	}
+
+	hlUInt uiBytesWritten = pWriteProc(lpData, uiBytes, this->pUserData);
+
+	if(uiBytesWritten == 0)
+	{
+		LastError.SetErrorMessage("pWriteProc() failed.");
+	}
+
+	this->Seek(static_cast<hlLongLong>(uiPointer), HL_SEEK_BEGINNING);
+
+	return uiBytesWritten;
+}
+
+//
+// ReadBatch()
+// Hands the whole batch to pReadVProc when it is set.
+//
+hlBool CProcStream::ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount)
+{
+	if(!this->bOpened)
+	{
+		return hlFalse;
+	}
+
+	if((this->uiMode & HL_MODE_READ) == 0)
+	{
+		LastError.SetErrorMessage("Stream not in read mode.");
+		return hlFalse;
+	}
+
+	if(this->lpData != 0 || pReadVProc == 0)
+	{
+		return IStream::ReadBatch(lpRequests, uiCount);
+	}
+
+	for(hlUInt i = 0; i < uiCount; i++)
+	{
+		lpRequests[i].uiBytesRead = 0;
+	}
+
+	if(!pReadVProc(lpRequests, uiCount, this->pUserData))
+	{
+		LastError.SetErrorMessage("pReadVProc() failed.");
+		return hlFalse;
+	}
+
+	return hlTrue;
+}
@@ -27,6 +27,9 @@ namespace HLLib
 
 			hlVoid *pUserData;
 
+			const hlVoid *lpData;
+			hlULongLong uiBufferSize;
+
 		public:
 			CProcStream(hlVoid *pUserData);
 			~CProcStream();
@@ -35,6 +38,12 @@ namespace HLLib
 
 			virtual const hlChar *GetFileName() const;
 
+			// The data of a memory resident backend (see HL_PROC_GET_POINTER) or 0.
+			// The buffer is the whole stream, so its size is the stream size; a
+			// backend without a size proc isn't treated as memory resident.
+			const hlVoid *GetBuffer() const;
+			hlULongLong GetBufferSize() const;
+
 			virtual hlBool GetOpened() const;
 			virtual hlUInt GetMode() const;
 
@@ -51,6 +60,11 @@ namespace HLLib
 
 			virtual hlBool Write(hlChar cChar);
 			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlUInt ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			virtual hlUInt WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlBool ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount);
 		};
 	}
 }
@@ -15,13 +15,6 @@
 #include "Checksum.h"
 #include "Utility.h"
 
-#if USE_ZLIB
-#	ifdef _WIN32
-#		define ZLIB_WINAPI
-#	endif
-#	include <zlib.h>
-#endif
-
 using namespace HLLib;
 
 #define HL_SGA_CHECKSUM_LENGTH 0x00008000
@@ -181,9 +174,9 @@ hlBool CSGAFile::CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStr
 	return this->pDirectory->CreateStreamInternal(pFile, pStream);
 }
 
-hlVoid CSGAFile::ReleaseStreamInternal(Streams::IStream &Stream) const
+hlBool CSGAFile::MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const
 {
-	return this->pDirectory->ReleaseStreamInternal(Stream);
+	return this->pDirectory->MapContentsInternal(pFile, pView);
 }
 
 
@@ -352,7 +345,7 @@ hlVoid CSGAFile::CSGADirectory<TSGAHeader, TSGADirectoryHeader, TSGASection, TSG
 template<typename TSGAHeader, typename TSGADirectoryHeader, typename TSGASection, typename TSGAFolder, typename TSGAFile>
 CDirectoryFolder *CSGAFile::CSGADirectory<TSGAHeader, TSGADirectoryHeader, TSGASection, TSGAFolder, TSGAFile>::CreateRoot()
 {
-	CDirectoryFolder *pRoot = new CDirectoryFolder(&this->File);
+	CDirectoryFolder *pRoot = new CDirectoryFolder(&this->File, &this->File.GetDirectoryArena());
 
 	for(hlUInt i = 0; i < this->pDirectoryHeader->uiSectionCount; i++)
 	{
@@ -396,8 +389,8 @@ hlVoid CSGAFile::CSGADirectory<TSGAHeader, TSGADirectoryHeader, TSGASection, TSG
 		CDirectoryItem *pItem = pParent->GetItem(lpName);
 		if(pItem == 0 || pItem->GetType() == HL_ITEM_FILE)
 		{
-			// It doesn't, create it.
-			pParent = pParent->AddFolder(lpName);
+			// It doesn't, create it.  The name is in the mapped string table.
+			pParent = pParent->AddFolder(lpName, HL_ID_INVALID, 0, hlFalse);
 		}
 		else
 		{
@@ -412,7 +405,7 @@ hlVoid CSGAFile::CSGADirectory<TSGAHeader, TSGADirectoryHeader, TSGASection, TSG
 	for(hlUInt i = this->lpFolders[uiFolderIndex].uiFileStartIndex; i < this->lpFolders[uiFolderIndex].uiFileEndIndex; i++)
 	{
 		const hlChar* lpName = this->lpStringTable + this->lpFiles[i].uiNameOffset;
-		pParent->AddFile(lpName, i);
+		pParent->AddFile(lpName, i, 0, hlFalse);
 	}
 }
 
@@ -654,39 +647,34 @@ hlBool CSGAFile::CSGASpecializedDirectory<TSGAHeader, TSGADirectoryHeader, TSGAS
 	}
 #endif
 
-	Mapping::CView *pFileHeaderDataView = 0;
-	if(this->File.pMapping->Map(pFileHeaderDataView, static_cast<const SGAHeader *>(this->File.pHeader)->uiFileDataOffset + File.uiOffset - sizeof(SGAFileHeader), File.uiSizeOnDisk + sizeof(SGAFileHeader)))
+	Mapping::CView *pFileHeaderView = 0;
+	if(!this->File.pMapping->Map(pFileHeaderView, static_cast<const SGAHeader *>(this->File.pHeader)->uiFileDataOffset + File.uiOffset - sizeof(SGAFileHeader), sizeof(SGAFileHeader)))
 	{
-		hlULong uiChecksum = 0;
-		const SGAFileHeader* pFileHeader = static_cast<const SGAFileHeader*>(pFileHeaderDataView->GetView());
-		const hlByte* lpBuffer = reinterpret_cast<const hlByte *>(pFileHeader) + sizeof(SGAFileHeader);
-#if USE_ZLIB
-		hlByte *lpInflateBuffer = 0;
-		if(File.uiType != 0)
-		{
-			lpInflateBuffer = new hlByte[File.uiSize];
-			uLongf iInflateSize = File.uiSize;
-			switch(uncompress(lpInflateBuffer, &iInflateSize, lpBuffer, static_cast<uLong>(File.uiSizeOnDisk)))
-			{
-			case Z_OK:
-				lpBuffer = lpInflateBuffer;
-				break;
-			default:
-				delete []lpInflateBuffer;
-				lpInflateBuffer = 0;
-				eValidation = HL_VALIDATES_ERROR;
-				break;
-			}
-		}
-		if(File.uiType == 0 || lpInflateBuffer != 0)
-#endif
+		eValidation = HL_VALIDATES_ERROR;
+		return hlTrue;
+	}
+
+	hlULong uiCRC32 = static_cast<hlULong>(static_cast<const SGAFileHeader *>(pFileHeaderView->GetView())->uiCRC32);
+
+	this->File.pMapping->Unmap(pFileHeaderView);
+
+	// The checksum is of the inflated data, so compute it as the stream inflates it.
+	hlULong uiChecksum = 0;
+	Streams::IStream *pStream = 0;
+	if(this->CreateStreamInternal(pFile, pStream))
+	{
+		if(pStream->Open(HL_MODE_READ))
 		{
-			hlULongLong uiTotalBytes = 0, uiFileBytes = File.uiSize;
+			pStream->Advise(0, pStream->GetStreamSize(), HL_ACCESS_HINT_SEQUENTIAL);
+
+			hlULongLong uiTotalBytes = 0, uiFileBytes = pStream->GetStreamSize();
+			hlUInt uiBufferSize;
+			hlByte lpBuffer[HL_SGA_CHECKSUM_LENGTH];
 
 			hlBool bCancel = hlFalse;
 			hlValidateFileProgress(const_cast<CDirectoryFile *>(pFile), uiTotalBytes, uiFileBytes, &bCancel);
 
-			while(uiTotalBytes < uiFileBytes)
+			while((uiBufferSize = pStream->Read(lpBuffer, sizeof(lpBuffer))) != 0)
 			{
 				if(bCancel)
 				{
@@ -694,30 +682,38 @@ hlBool CSGAFile::CSGASpecializedDirectory<TSGAHeader, TSGADirectoryHeader, TSGAS
 					break;
 				}
 
-				hlUInt uiBufferSize = static_cast<hlUInt>(uiTotalBytes + HL_SGA_CHECKSUM_LENGTH <= uiFileBytes ? HL_SGA_CHECKSUM_LENGTH : uiFileBytes - uiTotalBytes);
 				uiChecksum = CRC32(lpBuffer, uiBufferSize, uiChecksum);
 
-				lpBuffer += uiBufferSize;
 				uiTotalBytes += static_cast<hlULongLong>(uiBufferSize);
 
 				hlValidateFileProgress(const_cast<CDirectoryFile *>(pFile), uiTotalBytes, uiFileBytes, &bCancel);
 			}
+
+			if(eValidation == HL_VALIDATES_ASSUMED_OK && uiTotalBytes != uiFileBytes)
+			{
+				eValidation = HL_VALIDATES_ERROR;
+			}
+
+			pStream->Advise(0, pStream->GetStreamSize(), HL_ACCESS_HINT_NORMAL);
+			pStream->Close();
 		}
-#if USE_ZLIB
-		delete []lpInflateBuffer;
-#endif
-		if(eValidation == HL_VALIDATES_ASSUMED_OK)
+		else
 		{
-			eValidation = static_cast<hlULong>(pFileHeader->uiCRC32) == uiChecksum ? HL_VALIDATES_OK : HL_VALIDATES_CORRUPT;
+			eValidation = HL_VALIDATES_ERROR;
 		}
 
-		this->File.pMapping->Unmap(pFileHeaderDataView);
+		delete pStream;
 	}
 	else
 	{
 		eValidation = HL_VALIDATES_ERROR;
 	}
 
+	if(eValidation == HL_VALIDATES_ASSUMED_OK)
+	{
+		eValidation = uiCRC32 == uiChecksum ? HL_VALIDATES_OK : HL_VALIDATES_CORRUPT;
+	}
+
 	return hlTrue;
 }
 
@@ -873,54 +869,32 @@ hlBool CSGAFile::CSGADirectory<TSGAHeader, TSGADirectoryHeader, TSGASection, TSG
 
 	if(File.uiType == 0)
 	{
-		pStream = new Streams::CMappingStream(*this->File.pMapping, static_cast<const SGAHeader *>(this->File.pHeader)->uiFileDataOffset + File.uiOffset, File.uiSizeOnDisk);
+		pStream = this->File.CreateMappingStream(*this->File.pMapping, static_cast<const SGAHeader *>(this->File.pHeader)->uiFileDataOffset + File.uiOffset, File.uiSizeOnDisk);
 		return hlTrue;
 	}
 	else
 	{
 #if USE_ZLIB
-		Mapping::CView *pFileDataView = 0;
-		if(this->File.pMapping->Map(pFileDataView, static_cast<const SGAHeader *>(this->File.pHeader)->uiFileDataOffset + File.uiOffset, File.uiSizeOnDisk))
-		{
-			hlBool bResult = hlFalse;
-			hlByte *lpInflateBuffer = new hlByte[File.uiSize];
-			uLongf iInflateSize = File.uiSize;
-			switch(uncompress(lpInflateBuffer, &iInflateSize, static_cast<const hlByte *>(pFileDataView->GetView()), (uLong)File.uiSizeOnDisk))
-			{
-			case Z_OK:
-				pStream = new Streams::CMemoryStream(lpInflateBuffer, iInflateSize);
-				bResult = hlTrue;
-				break;
-			case Z_MEM_ERROR:
-				delete []lpInflateBuffer;
-				LastError.SetErrorMessage("Deflate Error: Z_MEM_ERROR.");
-				break;
-			case Z_BUF_ERROR:
-				delete []lpInflateBuffer;
-				LastError.SetErrorMessage("Deflate Error: Z_BUF_ERROR.");
-				break;
-			case Z_DATA_ERROR:
-				delete []lpInflateBuffer;
-				LastError.SetErrorMessage("Deflate Error: Z_DATA_ERROR.");
-				break;
-			default:
-				delete []lpInflateBuffer;
-				LastError.SetErrorMessage("Deflate Error: Unknown.");
-				break;
-			}
-			this->File.pMapping->Unmap(pFileDataView);
-			return bResult;
-		}
-#endif
+		hlULongLong uiOffset = static_cast<const SGAHeader *>(this->File.pHeader)->uiFileDataOffset + File.uiOffset;
+		Streams::IStream *pDeflateStream = new Streams::CMappingStream(*this->File.pMapping, uiOffset, File.uiSizeOnDisk);
+		pStream = new Streams::CInflateStream(pDeflateStream, hlTrue, File.uiSize, hlFalse, this->File.GetInflateIndex(uiOffset, File.uiSize));
+		return hlTrue;
+#else
 		return hlFalse;
+#endif
 	}
 }
 
 template<typename TSGAHeader, typename TSGADirectoryHeader, typename TSGASection, typename TSGAFolder, typename TSGAFile>
-hlVoid CSGAFile::CSGADirectory<TSGAHeader, TSGADirectoryHeader, TSGASection, TSGAFolder, TSGAFile>::ReleaseStreamInternal(Streams::IStream &Stream) const
+hlBool CSGAFile::CSGADirectory<TSGAHeader, TSGADirectoryHeader, TSGASection, TSGAFolder, TSGAFile>::MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const
 {
-	if(Stream.GetType() == HL_STREAM_MEMORY)
+	const SGAFile &File = this->lpFiles[pFile->GetID()];
+
+	if(File.uiType != 0)
 	{
-		delete []static_cast<const hlByte *>(static_cast<Streams::CMemoryStream &>(Stream).GetBuffer());
+		LastError.SetErrorMessage("File is compressed.");
+		return hlFalse;
 	}
+
+	return this->File.pMapping->Map(pView, static_cast<const SGAHeader *>(this->File.pHeader)->uiFileDataOffset + File.uiOffset, File.uiSizeOnDisk);
 }
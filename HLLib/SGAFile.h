@@ -155,7 +155,8 @@ namespace HLLib
 			virtual hlBool GetFileSizeOnDiskInternal(const CDirectoryFile *pFile, hlUInt &uiSize) const = 0;
 
 			virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const = 0;
-			virtual hlVoid ReleaseStreamInternal(Streams::IStream &Stream) const = 0;
+
+			virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const = 0;
 		};
 
 		// Specialization SGAFile7 and up where the CRC moved to the header and the CRC is of the compressed data and there are stronger hashes.
@@ -271,7 +272,8 @@ namespace HLLib
 			virtual hlBool GetFileSizeOnDiskInternal(const CDirectoryFile *pFile, hlUInt &uiSize) const;
 
 			virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
-			virtual hlVoid ReleaseStreamInternal(Streams::IStream &Stream) const;
+
+			virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
 
 		private:
 			hlVoid CreateFolder(CDirectoryFolder *pParent, hlUInt uiFolderIndex);
@@ -325,7 +327,8 @@ namespace HLLib
 		virtual hlBool GetFileSizeOnDiskInternal(const CDirectoryFile *pFile, hlUInt &uiSize) const;
 
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
-		virtual hlVoid ReleaseStreamInternal(Streams::IStream &Stream) const;
+
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
 	};
 }
 
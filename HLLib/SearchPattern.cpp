@@ -0,0 +1,245 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#include "HLLib.h"
+#include "SearchPattern.h"
+
+using namespace HLLib;
+
+static inline hlChar FoldCharacter(hlChar cChar)
+{
+	return cChar >= 'a' && cChar <= 'z' ? cChar - ('a' - 'A') : cChar;
+}
+
+CSearchPattern::CSearchPattern(const hlChar *lpSearch, HLFindType eFind) : bCaseSensitive((eFind & HL_FIND_CASE_SENSITIVE) != 0), bExact(hlFalse), bAnchorStart(hlFalse), bAnchorEnd(hlFalse), lpPattern(this->lpPatternBuffer), lpSegments(this->lpSegmentBuffer), uiSegmentCount(0)
+{
+	hlUInt uiLength = (hlUInt)strlen(lpSearch);
+	hlBool bWildcard = (eFind & (HL_FIND_MODE_STRING | HL_FIND_MODE_SUBSTRING)) == 0;
+
+	if(uiLength + 1 > HL_SEARCH_PATTERN_BUFFER_SIZE)
+	{
+		this->lpPattern = new hlChar[uiLength + 1];
+	}
+
+	hlUInt uiSegments = 1;
+	if(bWildcard)
+	{
+		for(const hlChar *lpTemp = lpSearch; *lpTemp; lpTemp++)
+		{
+			if(*lpTemp == '*')
+			{
+				uiSegments++;
+			}
+		}
+	}
+
+	if(uiSegments > HL_SEARCH_PATTERN_SEGMENT_COUNT)
+	{
+		this->lpSegments = new SearchPatternSegment[uiSegments];
+	}
+
+	for(hlUInt i = 0; i <= uiLength; i++)
+	{
+		this->lpPattern[i] = this->bCaseSensitive ? lpSearch[i] : FoldCharacter(lpSearch[i]);
+	}
+
+	if(!bWildcard)
+	{
+		// Strings and substrings are a single literal segment.
+		this->bExact = (eFind & HL_FIND_MODE_STRING) != 0;
+		this->bAnchorStart = this->bExact;
+		this->bAnchorEnd = this->bExact;
+
+		this->lpSegments[0].uiOffset = 0;
+		this->lpSegments[0].uiLength = uiLength;
+		this->lpSegments[0].bWildcard = hlFalse;
+		this->uiSegmentCount = 1;
+
+		return;
+	}
+
+	this->bExact = uiSegments == 1;
+	this->bAnchorStart = uiLength == 0 || lpSearch[0] != '*';
+	this->bAnchorEnd = uiLength == 0 || lpSearch[uiLength - 1] != '*';
+
+	// Split at each *, dropping the empty segments runs of * leave.
+	hlUInt uiStart = 0;
+	for(hlUInt i = 0; i <= uiLength; i++)
+	{
+		if(i == uiLength || lpSearch[i] == '*')
+		{
+			if(i > uiStart || this->bExact)
+			{
+				SearchPatternSegment &Segment = this->lpSegments[this->uiSegmentCount++];
+				Segment.uiOffset = uiStart;
+				Segment.uiLength = i - uiStart;
+				Segment.bWildcard = memchr(lpSearch + uiStart, '?', i - uiStart) != 0;
+			}
+
+			uiStart = i + 1;
+		}
+	}
+}
+
+CSearchPattern::~CSearchPattern()
+{
+	if(this->lpPattern != this->lpPatternBuffer)
+	{
+		delete []this->lpPattern;
+	}
+
+	if(this->lpSegments != this->lpSegmentBuffer)
+	{
+		delete []this->lpSegments;
+	}
+}
+
+hlBool CSearchPattern::Match(const hlChar *lpString) const
+{
+	hlUInt uiLength = (hlUInt)strlen(lpString);
+
+	if(this->bExact)
+	{
+		return uiLength == this->lpSegments[0].uiLength && this->MatchSegment(lpString, this->lpSegments[0]);
+	}
+
+	const hlChar *lpBegin = lpString;
+	const hlChar *lpEnd = lpString + uiLength;
+
+	hlUInt uiFirst = 0;
+	hlUInt uiLast = this->uiSegmentCount;
+
+	if(this->bAnchorStart)
+	{
+		const SearchPatternSegment &Segment = this->lpSegments[uiFirst++];
+		if(uiLength < Segment.uiLength || !this->MatchSegment(lpBegin, Segment))
+		{
+			return hlFalse;
+		}
+		lpBegin += Segment.uiLength;
+	}
+
+	if(this->bAnchorEnd)
+	{
+		const SearchPatternSegment &Segment = this->lpSegments[--uiLast];
+		if(static_cast<hlUInt>(lpEnd - lpBegin) < Segment.uiLength || !this->MatchSegment(lpEnd - Segment.uiLength, Segment))
+		{
+			return hlFalse;
+		}
+		lpEnd -= Segment.uiLength;
+	}
+
+	// Segments are fixed length, so taking the leftmost match of each never loses one.
+	for(hlUInt i = uiFirst; i < uiLast; i++)
+	{
+		const hlChar *lpFound = this->FindSegment(lpBegin, lpEnd, this->lpSegments[i]);
+		if(lpFound == 0)
+		{
+			return hlFalse;
+		}
+		lpBegin = lpFound + this->lpSegments[i].uiLength;
+	}
+
+	return hlTrue;
+}
+
+//
+// MatchSegment()
+// Returns true if Segment matches the characters at lpString, which has to
+// have at least Segment.uiLength of them.
+//
+hlBool CSearchPattern::MatchSegment(const hlChar *lpString, const SearchPatternSegment &Segment) const
+{
+	const hlChar *lpSegment = this->lpPattern + Segment.uiOffset;
+
+	if(this->bCaseSensitive && !Segment.bWildcard)
+	{
+		return memcmp(lpString, lpSegment, Segment.uiLength) == 0;
+	}
+
+	for(hlUInt i = 0; i < Segment.uiLength; i++)
+	{
+		if(Segment.bWildcard && lpSegment[i] == '?')
+		{
+			continue;
+		}
+
+		if(lpSegment[i] != (this->bCaseSensitive ? lpString[i] : FoldCharacter(lpString[i])))
+		{
+			return hlFalse;
+		}
+	}
+
+	return hlTrue;
+}
+
+//
+// FindSegment()
+// Returns the first position in [lpBegin, lpEnd) Segment matches at, or 0.
+//
+const hlChar *CSearchPattern::FindSegment(const hlChar *lpBegin, const hlChar *lpEnd, const SearchPatternSegment &Segment) const
+{
+	if(static_cast<hlUInt>(lpEnd - lpBegin) < Segment.uiLength)
+	{
+		return 0;
+	}
+
+	if(Segment.uiLength == 0)
+	{
+		return lpBegin;
+	}
+
+	// Last position a match can start at.
+	const hlChar *lpLast = lpEnd - Segment.uiLength;
+	hlChar cFirst = this->lpPattern[Segment.uiOffset];
+
+	if(Segment.bWildcard && cFirst == '?')
+	{
+		for(const hlChar *lpTest = lpBegin; lpTest <= lpLast; lpTest++)
+		{
+			if(this->MatchSegment(lpTest, Segment))
+			{
+				return lpTest;
+			}
+		}
+
+		return 0;
+	}
+
+	// Scan for the first character, in both cases if it is a letter and case doesn't matter.
+	hlChar cOther = cFirst;
+	if(!this->bCaseSensitive && cFirst >= 'A' && cFirst <= 'Z')
+	{
+		cOther = cFirst + ('a' - 'A');
+	}
+
+	const hlChar *lpFirst = static_cast<const hlChar *>(memchr(lpBegin, cFirst, lpLast - lpBegin + 1));
+	const hlChar *lpOther = cOther != cFirst ? static_cast<const hlChar *>(memchr(lpBegin, cOther, lpLast - lpBegin + 1)) : 0;
+	while(lpFirst != 0 || lpOther != 0)
+	{
+		const hlChar *lpTest = lpOther == 0 || (lpFirst != 0 && lpFirst < lpOther) ? lpFirst : lpOther;
+		if(this->MatchSegment(lpTest, Segment))
+		{
+			return lpTest;
+		}
+
+		if(lpTest == lpFirst)
+		{
+			lpFirst = lpTest < lpLast ? static_cast<const hlChar *>(memchr(lpTest + 1, cFirst, lpLast - lpTest)) : 0;
+		}
+		else
+		{
+			lpOther = lpTest < lpLast ? static_cast<const hlChar *>(memchr(lpTest + 1, cOther, lpLast - lpTest)) : 0;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#ifndef SEARCHPATTERN_H
+#define SEARCHPATTERN_H
+
+#include "stdafx.h"
+
+#define HL_SEARCH_PATTERN_BUFFER_SIZE 128
+#define HL_SEARCH_PATTERN_SEGMENT_COUNT 16
+
+namespace HLLib
+{
+	//
+	// A search string compiled once for matching many directory item names.  Wild card
+	// patterns are split at each * into fixed length segments; the first and last are
+	// matched in place and the others are found left to right with memchr().
+	//
+	class HLLIB_API CSearchPattern
+	{
+	private:
+		struct SearchPatternSegment
+		{
+			hlUInt uiOffset;	// Offset into lpPattern.
+			hlUInt uiLength;
+			hlBool bWildcard;	// Contains ?.
+		};
+
+	private:
+		hlBool bCaseSensitive;
+
+		hlBool bExact;			// No *, the only segment has to match the whole name.
+		hlBool bAnchorStart;	// First segment has to match at the start of the name.
+		hlBool bAnchorEnd;		// Last segment has to match at the end of the name.
+
+		hlChar *lpPattern;		// Upper case unless bCaseSensitive.
+		SearchPatternSegment *lpSegments;
+		hlUInt uiSegmentCount;
+
+		hlChar lpPatternBuffer[HL_SEARCH_PATTERN_BUFFER_SIZE];
+		SearchPatternSegment lpSegmentBuffer[HL_SEARCH_PATTERN_SEGMENT_COUNT];
+
+	public:
+		CSearchPattern(const hlChar *lpSearch, HLFindType eFind);
+		~CSearchPattern();
+
+		hlBool Match(const hlChar *lpString) const;
+
+	private:
+		hlBool MatchSegment(const hlChar *lpString, const SearchPatternSegment &Segment) const;
+		const hlChar *FindSegment(const hlChar *lpBegin, const hlChar *lpEnd, const SearchPatternSegment &Segment) const;
+
+		// lpPattern and lpSegments may point into the object itself.
+		CSearchPattern(const CSearchPattern &);
+		CSearchPattern &operator=(const CSearchPattern &);
+	};
+}
+
+#endif
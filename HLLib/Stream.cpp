@@ -14,7 +14,148 @@
 using namespace HLLib;
 using namespace HLLib::Streams;
 
+IStream::IStream() : uiSlot(0)
+{
+
+}
+
 IStream::~IStream()
 {
 
 }
+
+//
+// ReadAt()
+// Default positional read for streams that have no native support, emulated
+// with Seek() and Read().  The stream pointer is restored afterwards.
+//
+hlUInt IStream::ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes)
+{
+	if(!this->GetOpened())
+	{
+		return 0;
+	}
+
+	hlULongLong uiPointer = this->GetStreamPointer();
+
+	if(this->Seek(static_cast<hlLongLong>(uiOffset), HL_SEEK_BEGINNING) != uiOffset)
+	{
+		this->Seek(static_cast<hlLongLong>(uiPointer), HL_SEEK_BEGINNING);
+		return 0;
+	}
+
+	hlUInt uiBytesRead = this->Read(lpData, uiBytes);
+
+	this->Seek(static_cast<hlLongLong>(uiPointer), HL_SEEK_BEGINNING);
+
+	return uiBytesRead;
+}
+
+//
+// WriteAt()
+// Default positional write, see ReadAt().
+//
+hlUInt IStream::WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes)
+{
+	if(!this->GetOpened())
+	{
+		return 0;
+	}
+
+	hlULongLong uiPointer = this->GetStreamPointer();
+
+	if(this->Seek(static_cast<hlLongLong>(uiOffset), HL_SEEK_BEGINNING) != uiOffset)
+	{
+		this->Seek(static_cast<hlLongLong>(uiPointer), HL_SEEK_BEGINNING);
+		return 0;
+	}
+
+	hlUInt uiBytesWritten = this->Write(lpData, uiBytes);
+
+	this->Seek(static_cast<hlLongLong>(uiPointer), HL_SEEK_BEGINNING);
+
+	return uiBytesWritten;
+}
+
+//
+// ReadBatch()
+// Default batched read, see ReadAt().  uiBytesRead is set for every request.
+//
+hlBool IStream::ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount)
+{
+	if(!this->GetOpened())
+	{
+		return hlFalse;
+	}
+
+	for(hlUInt i = 0; i < uiCount; i++)
+	{
+		lpRequests[i].uiBytesRead = this->ReadAt(lpRequests[i].uiOffset, lpRequests[i].lpData, lpRequests[i].uiBytes);
+	}
+
+	return hlTrue;
+}
+
+//
+// ReadV()
+// Reads every segment relative to the stream pointer, then moves the pointer
+// past the furthest byte read.  uiBytesRead is set for every segment.
+//
+hlULongLong IStream::ReadV(StreamReadRequest *lpSegments, hlUInt uiCount)
+{
+	hlULongLong uiPointer = this->GetStreamPointer();
+	hlULongLong uiBytesRead = this->ReadVAt(uiPointer, lpSegments, uiCount);
+
+	if(uiBytesRead == 0)
+	{
+		return 0;
+	}
+
+	hlULongLong uiEnd = uiPointer;
+	for(hlUInt i = 0; i < uiCount; i++)
+	{
+		if(lpSegments[i].uiBytesRead != 0 && uiPointer + lpSegments[i].uiOffset + lpSegments[i].uiBytesRead > uiEnd)
+		{
+			uiEnd = uiPointer + lpSegments[i].uiOffset + lpSegments[i].uiBytesRead;
+		}
+	}
+
+	if(uiEnd != uiPointer)
+	{
+		this->Seek(static_cast<hlLongLong>(uiEnd), HL_SEEK_BEGINNING);
+	}
+
+	return uiBytesRead;
+}
+
+//
+// ReadVAt()
+// Reads every segment relative to uiOffset with a single batch, so streams get
+// to see all of the segments at once.  uiBytesRead is set for every segment.
+// Returns 0 with LastError set if the batch failed.
+//
+hlULongLong IStream::ReadVAt(hlULongLong uiOffset, StreamReadRequest *lpSegments, hlUInt uiCount)
+{
+	for(hlUInt i = 0; i < uiCount; i++)
+	{
+		lpSegments[i].uiOffset += uiOffset;
+		lpSegments[i].uiBytesRead = 0;
+	}
+
+	hlBool bResult = this->ReadBatch(lpSegments, uiCount);
+
+	hlULongLong uiBytesRead = 0;
+	for(hlUInt i = 0; i < uiCount; i++)
+	{
+		lpSegments[i].uiOffset -= uiOffset;
+		uiBytesRead += lpSegments[i].uiBytesRead;
+	}
+
+	// Don't let a failed batch pass for a short read at the end of the stream.
+	return bResult ? uiBytesRead : 0;
+}
+
+hlVoid IStream::Advise(hlULongLong , hlULongLong , HLAccessHint )
+{
+
+}
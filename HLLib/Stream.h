@@ -16,11 +16,23 @@
 
 namespace HLLib
 {
+	class CPackage;
+
 	namespace Streams
 	{
+		// One range of a batched positional read.
+		typedef HLStreamSegment StreamReadRequest;
+
 		class HLLIB_API IStream
 		{
+			friend class HLLib::CPackage;
+
+		private:
+			// Index of the stream in its package's registry.
+			hlUInt uiSlot;
+
 		public:
+			IStream();
 			virtual ~IStream();
 
 			virtual HLStreamType GetType() const = 0;
@@ -43,6 +55,23 @@ namespace HLLib
 
 			virtual hlBool Write(hlChar cChar) = 0;
 			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes) = 0;
+
+			// Positional I/O; does not use or move the stream pointer.
+			virtual hlUInt ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			virtual hlUInt WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes);
+
+			// Reads many ranges at once.  Streams that can keep several reads in flight
+			// override this; the default issues them one at a time with ReadAt().
+			virtual hlBool ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount);
+
+			// Scatter reads built on ReadBatch(); segment offsets are relative to the stream
+			// pointer or to uiOffset.  Return the total number of bytes read, 0 if the
+			// batch failed.
+			hlULongLong ReadV(StreamReadRequest *lpSegments, hlUInt uiCount);
+			hlULongLong ReadVAt(hlULongLong uiOffset, StreamReadRequest *lpSegments, hlUInt uiCount);
+
+			// Access pattern hint for a range of the stream; ignored by default.
+			virtual hlVoid Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
 		};
 	}
 }
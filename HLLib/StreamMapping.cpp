@@ -15,7 +15,7 @@
 using namespace HLLib;
 using namespace HLLib::Mapping;
 
-CStreamMapping::CStreamMapping(Streams::IStream &Stream) : Stream(Stream)
+CStreamMapping::CStreamMapping(Streams::IStream &Stream) : Stream(Stream), uiCacheSize(0), uiCacheUsed(0), uiCacheHits(0), uiCacheMisses(0), pCacheBlockList(0), pCacheBlockMap(0), uiReadAheadOffset(0), uiReadAheadEnd(0)
 {
 	this->Stream.Close();
 }
@@ -61,11 +61,30 @@ hlBool CStreamMapping::OpenInternal(hlUInt uiMode)
 		return hlFalse;
 	}
 
-	return this->Stream.Open(uiMode);
+	if(!this->Stream.Open(uiMode))
+	{
+		return hlFalse;
+	}
+
+	// Writable or volatile streams can change under us, so don't cache them.
+	this->uiCacheHits = 0;
+	this->uiCacheMisses = 0;
+	this->uiReadAheadOffset = 0;
+	this->uiReadAheadEnd = 0;
+	if(uiStreamMappingCacheSize != 0 && (uiMode & (HL_MODE_WRITE | HL_MODE_VOLATILE)) == 0)
+	{
+		this->uiCacheSize = uiStreamMappingCacheSize;
+		this->pCacheBlockList = new CStreamMappingBlockList();
+		this->pCacheBlockMap = new CStreamMappingBlockMap();
+	}
+
+	return hlTrue;
 }
 
 hlVoid CStreamMapping::CloseInternal()
 {
+	this->ClearCache();
+
 	this->Stream.Close();
 }
 
@@ -74,34 +93,111 @@ hlULongLong CStreamMapping::GetMappingSize() const
 	return this->Stream.GetStreamSize();
 }
 
+hlULongLong CStreamMapping::GetCacheMemoryUsed() const
+{
+	return this->uiCacheUsed;
+}
+
+hlULongLong CStreamMapping::GetCacheHits() const
+{
+	return this->uiCacheHits;
+}
+
+hlULongLong CStreamMapping::GetCacheMisses() const
+{
+	return this->uiCacheMisses;
+}
+
 hlBool CStreamMapping::MapInternal(CView *&pView, hlULongLong uiOffset, hlULongLong uiLength)
 {
 	assert(this->GetOpened());
 
-	if(uiOffset + uiLength > this->Stream.GetStreamSize())
+	hlULongLong uiMappingSize = this->Stream.GetStreamSize();
+
+	if(uiOffset + uiLength > uiMappingSize)
 	{
 #ifdef _WIN32
-		LastError.SetErrorMessageFormated("Requested view (%I64u, %I64u) does not fit inside mapping, (%I64u, %I64u).", uiOffset, uiLength, 0, this->Stream.GetStreamSize());
+		LastError.SetErrorMessageFormated("Requested view (%I64u, %I64u) does not fit inside mapping, (%I64u, %I64u).", uiOffset, uiLength, 0ULL, uiMappingSize);
 #else
-		LastError.SetErrorMessageFormated("Requested view (%llu, %llu) does not fit inside mapping, (%llu, %llu).", uiOffset, uiLength, 0, this->Stream.GetStreamSize());
+		LastError.SetErrorMessageFormated("Requested view (%llu, %llu) does not fit inside mapping, (%llu, %llu).", uiOffset, uiLength, 0ULL, uiMappingSize);
 #endif
 		return hlFalse;
 	}
 
-	if(Stream.Seek(static_cast<hlLongLong>(uiOffset), HL_SEEK_BEGINNING) != uiOffset)
+	// Large views (directory trees, whole files) would only flush the cache,
+	// so read them straight into their own buffer.
+	if(this->pCacheBlockMap == 0 || uiLength == 0 || uiLength > this->uiCacheSize / 4)
 	{
-		return hlFalse;
+		hlByte *lpData = new hlByte[static_cast<hlUInt>(uiLength)];
+
+		if(this->Stream.ReadAt(uiOffset, lpData, static_cast<hlUInt>(uiLength)) != uiLength)
+		{
+			delete []lpData;
+			return hlFalse;
+		}
+
+		this->AllocateMemory(uiLength);
+
+		pView = new CView(this, lpData, uiOffset, uiLength);
+
+		return hlTrue;
 	}
 
-	hlByte *lpData = new hlByte[static_cast<hlUInt>(uiLength)];
+	// The block cache is shared by every view, misses are read under the lock.
+	CMutexLock Lock(*this->pMutex);
 
-	if(Stream.Read(lpData, static_cast<hlUInt>(uiLength)) != uiLength)
+	hlULongLong uiFirstBlock = uiOffset / HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE;
+	hlULongLong uiLastBlock = (uiOffset + uiLength - 1) / HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE;
+
+	if(uiFirstBlock == uiLastBlock)
 	{
-		delete []lpData;
-		return hlFalse;
+		// The view fits in a single block, point straight into it.
+		StreamMappingBlock *pBlock = this->GetBlock(uiFirstBlock, uiMappingSize);
+
+		if(pBlock == 0)
+		{
+			return hlFalse;
+		}
+
+		if(pBlock->uiReferences++ == 0)
+		{
+			this->RemoveCacheEntry(pBlock->CachePosition);
+		}
+
+		hlULongLong uiBlockOffset = uiFirstBlock * HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE;
+		pView = new CView(this, pBlock->lpData, uiBlockOffset, pBlock->uiLength, uiOffset - uiBlockOffset, uiLength);
 	}
+	else
+	{
+		// The view spans several blocks, assemble a copy.
+		hlByte *lpData = new hlByte[static_cast<hlUInt>(uiLength)];
+
+		this->FetchBlocks(uiFirstBlock, uiLastBlock, uiMappingSize);
+
+		for(hlULongLong i = uiFirstBlock; i <= uiLastBlock; i++)
+		{
+			StreamMappingBlock *pBlock = this->GetBlock(i, uiMappingSize);
+
+			if(pBlock == 0)
+			{
+				delete []lpData;
+				this->EvictBlocks();
+				return hlFalse;
+			}
 
-	pView = new CView(this, lpData, uiOffset, uiLength);
+			hlULongLong uiBlockOffset = i * HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE;
+			hlULongLong uiStart = uiOffset > uiBlockOffset ? uiOffset : uiBlockOffset;
+			hlULongLong uiEnd = uiOffset + uiLength < uiBlockOffset + pBlock->uiLength ? uiOffset + uiLength : uiBlockOffset + pBlock->uiLength;
+
+			memcpy(lpData + (uiStart - uiOffset), pBlock->lpData + (uiStart - uiBlockOffset), static_cast<size_t>(uiEnd - uiStart));
+		}
+
+		this->AllocateMemory(uiLength);
+
+		pView = new CView(this, lpData, uiOffset, uiLength);
+	}
+
+	this->EvictBlocks();
 
 	return hlTrue;
 }
@@ -111,7 +207,52 @@ hlVoid CStreamMapping::UnmapInternal(CView &View)
 	assert(this->GetOpened());
 	assert(View.GetMapping() == this);
 
+	if(this->pCacheBlockMap != 0 && View.GetAllocationOffset() % HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE == 0)
+	{
+		CStreamMappingBlockMap::iterator i = this->pCacheBlockMap->find(View.GetAllocationOffset() / HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE);
+
+		if(i != this->pCacheBlockMap->end() && i->second->lpData == View.GetAllocationView())
+		{
+			assert(i->second->uiReferences > 0);
+
+			if(--i->second->uiReferences == 0)
+			{
+				i->second->CachePosition = this->InsertCacheEntry(i->second);
+			}
+			this->EvictBlocks();
+			return;
+		}
+	}
+
 	delete [](hlByte *)View.GetAllocationView();
+
+	this->FreeMemory(View.GetAllocationLength());
+}
+
+hlVoid CStreamMapping::AdviseInternal(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint)
+{
+	this->Stream.Advise(uiOffset, uiLength, eHint);
+
+	switch(eHint)
+	{
+	case HL_ACCESS_HINT_SEQUENTIAL:
+		this->uiReadAheadOffset = uiOffset;
+		this->uiReadAheadEnd = uiOffset + uiLength;
+		break;
+	case HL_ACCESS_HINT_WILL_NEED:
+		if(this->pCacheBlockMap != 0 && uiLength <= this->uiCacheSize / 2)
+		{
+			this->FetchBlocks(uiOffset / HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE, (uiOffset + uiLength - 1) / HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE, this->Stream.GetStreamSize());
+			this->EvictBlocks();
+		}
+		break;
+	case HL_ACCESS_HINT_DONT_NEED:
+		break;
+	default:
+		this->uiReadAheadOffset = 0;
+		this->uiReadAheadEnd = 0;
+		break;
+	}
 }
 
 hlBool CStreamMapping::CommitInternal(CView &View, hlULongLong uiOffset, hlULongLong uiLength)
@@ -120,15 +261,237 @@ hlBool CStreamMapping::CommitInternal(CView &View, hlULongLong uiOffset, hlULong
 
 	hlULongLong uiFileOffset = View.GetAllocationOffset() + View.GetOffset() + uiOffset;
 
-	if(Stream.Seek(static_cast<hlLongLong>(uiFileOffset), HL_SEEK_BEGINNING) != uiFileOffset)
+	if(this->Stream.WriteAt(uiFileOffset, (const hlByte *)View.GetView() + uiOffset, static_cast<hlUInt>(uiLength)) != uiLength)
 	{
 		return hlFalse;
 	}
 
-	if(Stream.Write((const hlByte *)View.GetView() + uiOffset, static_cast<hlUInt>(uiLength)) != uiLength)
+	return hlTrue;
+}
+
+CStreamMapping::StreamMappingBlock *CStreamMapping::GetBlock(hlULongLong uiIndex, hlULongLong uiMappingSize)
+{
+	CStreamMappingBlockMap::iterator i = this->pCacheBlockMap->find(uiIndex);
+
+	if(i != this->pCacheBlockMap->end())
 	{
-		return hlFalse;
+		StreamMappingBlock *pBlock = i->second;
+
+		// Move to the front of the LRU list.
+		this->pCacheBlockList->splice(this->pCacheBlockList->begin(), *this->pCacheBlockList, pBlock->Position);
+		if(pBlock->uiReferences == 0)
+		{
+			this->TouchCacheEntry(pBlock->CachePosition);
+		}
+
+		this->uiCacheHits++;
+		return pBlock;
 	}
 
-	return hlTrue;
+	hlULongLong uiBlockOffset = uiIndex * HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE;
+
+	if(uiBlockOffset >= this->uiReadAheadOffset && uiBlockOffset < this->uiReadAheadEnd)
+	{
+		// Inside a sequential range, read this block and the ones after it together.
+		hlULongLong uiReadAheadBlocks = this->uiCacheSize / 2 / HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE;
+		if(uiReadAheadBlocks > HL_DEFAULT_IO_URING_DEPTH)
+		{
+			uiReadAheadBlocks = HL_DEFAULT_IO_URING_DEPTH;
+		}
+		else if(uiReadAheadBlocks == 0)
+		{
+			uiReadAheadBlocks = 1;
+		}
+
+		hlULongLong uiLastBlock = (this->uiReadAheadEnd - 1) / HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE;
+		if(uiIndex + uiReadAheadBlocks - 1 < uiLastBlock)
+		{
+			uiLastBlock = uiIndex + uiReadAheadBlocks - 1;
+		}
+
+		this->FetchBlocks(uiIndex, uiLastBlock, uiMappingSize);
+
+		i = this->pCacheBlockMap->find(uiIndex);
+
+		if(i != this->pCacheBlockMap->end())
+		{
+			return i->second;
+		}
+
+		// The read failed, or the rest of the batch pushed the block back out
+		// to stay under the mapping memory budget; read it on its own.
+	}
+
+	this->uiCacheMisses++;
+
+	hlUInt uiBlockLength = uiBlockOffset + HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE > uiMappingSize ? static_cast<hlUInt>(uiMappingSize - uiBlockOffset) : HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE;
+
+	hlByte *lpData = new hlByte[uiBlockLength];
+
+	if(this->Stream.ReadAt(uiBlockOffset, lpData, uiBlockLength) != uiBlockLength)
+	{
+		delete []lpData;
+		return 0;
+	}
+
+	return this->InsertBlock(uiIndex, lpData, uiBlockLength);
+}
+
+CStreamMapping::StreamMappingBlock *CStreamMapping::InsertBlock(hlULongLong uiIndex, hlByte *lpData, hlUInt uiLength)
+{
+	this->AllocateMemory(uiLength);
+
+	StreamMappingBlock *pBlock = new StreamMappingBlock;
+	pBlock->uiIndex = uiIndex;
+	pBlock->lpData = lpData;
+	pBlock->uiLength = uiLength;
+	pBlock->uiReferences = 0;
+	pBlock->Position = this->pCacheBlockList->insert(this->pCacheBlockList->begin(), pBlock);
+	pBlock->CachePosition = this->InsertCacheEntry(pBlock);
+
+	this->pCacheBlockMap->insert(CStreamMappingBlockMap::value_type(uiIndex, pBlock));
+	this->uiCacheUsed += uiLength;
+
+	return pBlock;
+}
+
+//
+// FetchBlocks()
+// Reads every block in the range that is not cached yet with one batched read,
+// which lets streams with asynchronous I/O keep all of them in flight.
+//
+hlVoid CStreamMapping::FetchBlocks(hlULongLong uiFirstBlock, hlULongLong uiLastBlock, hlULongLong uiMappingSize)
+{
+	std::vector<Streams::StreamReadRequest> Requests;
+	std::vector<hlULongLong> Indices;
+
+	for(hlULongLong i = uiFirstBlock; i <= uiLastBlock; i++)
+	{
+		hlULongLong uiBlockOffset = i * HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE;
+
+		if(uiBlockOffset >= uiMappingSize)
+		{
+			break;
+		}
+
+		if(this->pCacheBlockMap->find(i) != this->pCacheBlockMap->end())
+		{
+			continue;
+		}
+
+		Streams::StreamReadRequest Request;
+		Request.uiOffset = uiBlockOffset;
+		Request.uiBytes = uiBlockOffset + HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE > uiMappingSize ? static_cast<hlUInt>(uiMappingSize - uiBlockOffset) : HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE;
+		Request.lpData = new hlByte[Request.uiBytes];
+		Request.uiBytesRead = 0;
+
+		Requests.push_back(Request);
+		Indices.push_back(i);
+	}
+
+	if(Requests.empty())
+	{
+		return;
+	}
+
+	this->Stream.ReadBatch(&Requests[0], static_cast<hlUInt>(Requests.size()));
+
+	for(std::vector<Streams::StreamReadRequest>::size_type i = 0; i < Requests.size(); i++)
+	{
+		this->uiCacheMisses++;
+
+		if(Requests[i].uiBytesRead == Requests[i].uiBytes)
+		{
+			this->InsertBlock(Indices[i], static_cast<hlByte *>(Requests[i].lpData), Requests[i].uiBytes);
+		}
+		else
+		{
+			delete [](hlByte *)Requests[i].lpData;
+		}
+	}
+}
+
+//
+// EvictBlocks()
+// Frees least recently used blocks that no view references until the cache
+// is back under budget.
+//
+hlVoid CStreamMapping::EvictBlocks()
+{
+	if(this->pCacheBlockList == 0)
+	{
+		return;
+	}
+
+	CStreamMappingBlockList::iterator i = this->pCacheBlockList->end();
+	while(this->uiCacheUsed > this->uiCacheSize && i != this->pCacheBlockList->begin())
+	{
+		--i;
+
+		StreamMappingBlock *pBlock = *i;
+
+		if(pBlock->uiReferences != 0)
+		{
+			continue;
+		}
+
+		++i;
+
+		this->RemoveCacheEntry(pBlock->CachePosition);
+		this->EvictBlock(pBlock);
+	}
+}
+
+//
+// EvictInternal()
+// Frees an idle block to bring the process back under the mapping memory budget.
+//
+hlVoid CStreamMapping::EvictInternal(hlVoid *pItem)
+{
+	this->EvictBlock(static_cast<StreamMappingBlock *>(pItem));
+}
+
+hlVoid CStreamMapping::EvictBlock(StreamMappingBlock *pBlock)
+{
+	assert(pBlock->uiReferences == 0);
+
+	this->uiCacheUsed -= pBlock->uiLength;
+	this->pCacheBlockMap->erase(pBlock->uiIndex);
+	this->pCacheBlockList->erase(pBlock->Position);
+
+	this->FreeMemory(pBlock->uiLength);
+
+	delete []pBlock->lpData;
+	delete pBlock;
+}
+
+hlVoid CStreamMapping::ClearCache()
+{
+	if(this->pCacheBlockList != 0)
+	{
+		for(CStreamMappingBlockList::iterator i = this->pCacheBlockList->begin(); i != this->pCacheBlockList->end(); ++i)
+		{
+			if((*i)->uiReferences == 0)
+			{
+				this->RemoveCacheEntry((*i)->CachePosition);
+			}
+
+			this->FreeMemory((*i)->uiLength);
+
+			delete [](*i)->lpData;
+			delete *i;
+		}
+
+		delete this->pCacheBlockList;
+		this->pCacheBlockList = 0;
+	}
+
+	if(this->pCacheBlockMap != 0)
+	{
+		delete this->pCacheBlockMap;
+		this->pCacheBlockMap = 0;
+	}
+
+	this->uiCacheSize = 0;
+	this->uiCacheUsed = 0;
 }
@@ -22,9 +22,37 @@ namespace HLLib
 	{
 		class HLLIB_API CStreamMapping : public CMapping
 		{
+		private:
+			struct StreamMappingBlock;
+
+			typedef std::list<StreamMappingBlock *> CStreamMappingBlockList;
+			typedef std::map<hlULongLong, StreamMappingBlock *> CStreamMappingBlockMap;
+
+			struct StreamMappingBlock
+			{
+				hlULongLong uiIndex;
+				hlByte *lpData;
+				hlUInt uiLength;
+				hlUInt uiReferences;
+				CStreamMappingBlockList::iterator Position;
+				CMappingCacheList::iterator CachePosition;
+			};
+
 		private:
 			Streams::IStream &Stream;
 
+			// Block cache, only used in read-only, non-volatile mode.  Guarded by pMutex.
+			hlULongLong uiCacheSize;
+			hlULongLong uiCacheUsed;
+			hlULongLong uiCacheHits;
+			hlULongLong uiCacheMisses;
+			CStreamMappingBlockList *pCacheBlockList;
+			CStreamMappingBlockMap *pCacheBlockMap;
+
+			// Range last declared sequential; misses inside it read ahead in a batch.
+			hlULongLong uiReadAheadOffset;
+			hlULongLong uiReadAheadEnd;
+
 		public:
 			CStreamMapping(Streams::IStream &Stream);
 			virtual ~CStreamMapping();
@@ -39,6 +67,10 @@ namespace HLLib
 
 			virtual hlULongLong GetMappingSize() const;
 
+			hlULongLong GetCacheMemoryUsed() const;
+			hlULongLong GetCacheHits() const;
+			hlULongLong GetCacheMisses() const;
+
 		private:
 			virtual hlBool OpenInternal(hlUInt uiMode);
 			virtual hlVoid CloseInternal();
@@ -46,7 +78,18 @@ namespace HLLib
 			virtual hlBool MapInternal(CView *&pView, hlULongLong uiOffset, hlULongLong uiLength);
 			virtual hlVoid UnmapInternal(CView &View);
 
+			virtual hlVoid AdviseInternal(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
 			virtual hlBool CommitInternal(CView &View, hlULongLong uiOffset, hlULongLong uiLength);
+
+			virtual hlVoid EvictInternal(hlVoid *pItem);
+
+			StreamMappingBlock *GetBlock(hlULongLong uiIndex, hlULongLong uiMappingSize);
+			StreamMappingBlock *InsertBlock(hlULongLong uiIndex, hlByte *lpData, hlUInt uiLength);
+			hlVoid FetchBlocks(hlULongLong uiFirstBlock, hlULongLong uiLastBlock, hlULongLong uiMappingSize);
+			hlVoid EvictBlocks();
+			hlVoid EvictBlock(StreamMappingBlock *pBlock);
+			hlVoid ClearCache();
 		};
 	}
 }
@@ -10,8 +10,10 @@
  */
 
 #include "Stream.h"
+#include "BufferedStream.h"
 #include "FileStream.h"
 #include "GCFStream.h"
+#include "InflateStream.h"
 #include "MappingStream.h"
 #include "MemoryStream.h"
 #include "NullStream.h"
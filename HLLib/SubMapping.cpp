@@ -0,0 +1,149 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#include "HLLib.h"
+#include "SubMapping.h"
+
+using namespace HLLib;
+using namespace HLLib::Mapping;
+
+CSubMapping::CSubMapping(CMapping &Mapping, hlULongLong uiMappingOffset, hlULongLong uiMappingSize) : bOpened(hlFalse), uiMode(HL_MODE_INVALID), Mapping(Mapping), uiMappingOffset(uiMappingOffset), uiMappingSize(uiMappingSize), pSubViews(0)
+{
+
+}
+
+CSubMapping::~CSubMapping()
+{
+	this->Close();
+}
+
+HLMappingType CSubMapping::GetType() const
+{
+	return HL_MAPPING_SUB;
+}
+
+const CMapping &CSubMapping::GetMapping() const
+{
+	return this->Mapping;
+}
+
+hlULongLong CSubMapping::GetMappingOffset() const
+{
+	return this->uiMappingOffset;
+}
+
+hlBool CSubMapping::GetOpened() const
+{
+	return this->bOpened;
+}
+
+hlUInt CSubMapping::GetMode() const
+{
+	return this->uiMode;
+}
+
+hlBool CSubMapping::OpenInternal(hlUInt uiMode)
+{
+	assert(!this->GetOpened());
+
+	if((uiMode & HL_MODE_READ) == 0 || (uiMode & HL_MODE_WRITE) != 0)
+	{
+		LastError.SetErrorMessageFormated("Invalid open mode (%#.8x).", uiMode);
+		return hlFalse;
+	}
+
+	if(!this->Mapping.GetOpened())
+	{
+		LastError.SetErrorMessage("Mapping not open.");
+		return hlFalse;
+	}
+
+	if(this->uiMappingOffset + this->uiMappingSize > this->Mapping.GetMappingSize())
+	{
+#ifdef _WIN32
+		LastError.SetErrorMessageFormated("Requested range (%I64u, %I64u) does not fit inside mapping, (%I64u, %I64u).", this->uiMappingOffset, this->uiMappingSize, 0ULL, this->Mapping.GetMappingSize());
+#else
+		LastError.SetErrorMessageFormated("Requested range (%llu, %llu) does not fit inside mapping, (%llu, %llu).", this->uiMappingOffset, this->uiMappingSize, 0ULL, this->Mapping.GetMappingSize());
+#endif
+		return hlFalse;
+	}
+
+	this->pSubViews = new CSubViewMap();
+
+	this->bOpened = hlTrue;
+	this->uiMode = uiMode;
+
+	return hlTrue;
+}
+
+hlVoid CSubMapping::CloseInternal()
+{
+	if(this->pSubViews != 0)
+	{
+		// CMapping::Close() has already unmapped our views.
+		assert(this->pSubViews->empty());
+
+		delete this->pSubViews;
+		this->pSubViews = 0;
+	}
+
+	this->bOpened = hlFalse;
+	this->uiMode = HL_MODE_INVALID;
+}
+
+hlULongLong CSubMapping::GetMappingSize() const
+{
+	return this->bOpened ? this->uiMappingSize : 0;
+}
+
+hlBool CSubMapping::MapInternal(CView *&pView, hlULongLong uiOffset, hlULongLong uiLength)
+{
+	assert(this->GetOpened());
+
+	if(uiOffset + uiLength > this->uiMappingSize)
+	{
+#ifdef _WIN32
+		LastError.SetErrorMessageFormated("Requested view (%I64u, %I64u) does not fit inside mapping, (%I64u, %I64u).", uiOffset, uiLength, 0ULL, this->uiMappingSize);
+#else
+		LastError.SetErrorMessageFormated("Requested view (%llu, %llu) does not fit inside mapping, (%llu, %llu).", uiOffset, uiLength, 0ULL, this->uiMappingSize);
+#endif
+		return hlFalse;
+	}
+
+	CView *pSubView = 0;
+	if(!this->Mapping.Map(pSubView, this->uiMappingOffset + uiOffset, uiLength))
+	{
+		return hlFalse;
+	}
+
+	pView = new CView(this, const_cast<hlVoid *>(pSubView->GetView()), uiOffset, uiLength);
+
+	CMutexLock Lock(*this->pMutex);
+
+	this->pSubViews->insert(CSubViewMap::value_type(pView, pSubView));
+
+	return hlTrue;
+}
+
+hlVoid CSubMapping::UnmapInternal(CView &View)
+{
+	CSubViewMap::iterator i = this->pSubViews->find(&View);
+	if(i != this->pSubViews->end())
+	{
+		this->Mapping.Unmap(i->second);
+		this->pSubViews->erase(i);
+	}
+}
+
+hlVoid CSubMapping::AdviseInternal(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint)
+{
+	this->Mapping.Advise(this->uiMappingOffset + uiOffset, uiLength, eHint);
+}
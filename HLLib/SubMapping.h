@@ -0,0 +1,69 @@
+/*
+ * HLLib
+ * Copyright (C) 2006-2010 Ryan Gregg
+
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later
+ * version.
+ */
+
+#ifndef SUBMAPPING_H
+#define SUBMAPPING_H
+
+#include "stdafx.h"
+#include "Mapping.h"
+
+namespace HLLib
+{
+	namespace Mapping
+	{
+		//
+		// Read only window over a range of another mapping, used to open packages
+		// stored inside other packages without copying them.  Views are views of
+		// the other mapping, which has to stay open while this one is.
+		//
+		class HLLIB_API CSubMapping : public CMapping
+		{
+		private:
+			typedef std::map<const CView *, CView *> CSubViewMap;
+
+		private:
+			hlBool bOpened;
+			hlUInt uiMode;
+
+			CMapping &Mapping;
+			hlULongLong uiMappingOffset;
+			hlULongLong uiMappingSize;
+
+			// Views of Mapping backing each of our views.
+			CSubViewMap *pSubViews;
+
+		public:
+			CSubMapping(CMapping &Mapping, hlULongLong uiMappingOffset, hlULongLong uiMappingSize);
+			virtual ~CSubMapping();
+
+			virtual HLMappingType GetType() const;
+
+			const CMapping &GetMapping() const;
+			hlULongLong GetMappingOffset() const;
+
+			virtual hlBool GetOpened() const;
+			virtual hlUInt GetMode() const;
+
+			virtual hlULongLong GetMappingSize() const;
+
+		private:
+			virtual hlBool OpenInternal(hlUInt uiMode);
+			virtual hlVoid CloseInternal();
+
+			virtual hlBool MapInternal(CView *&pView, hlULongLong uiOffset, hlULongLong uiLength);
+			virtual hlVoid UnmapInternal(CView &View);
+
+			virtual hlVoid AdviseInternal(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+		};
+	}
+}
+
+#endif
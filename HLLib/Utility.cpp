@@ -218,4 +218,107 @@ hlUInt HLLib::WStringToString(const hlWChar *lpSource, hlChar* lpDest, hlUInt ui
 	}
 	return uiCharsWritten;
 #endif
-}
\ No newline at end of file
+}
+
+namespace
+{
+	class CSegmentOffsetLess
+	{
+	private:
+		const HLStreamSegment *lpSegments;
+
+	public:
+		CSegmentOffsetLess(const HLStreamSegment *lpSegments) : lpSegments(lpSegments)
+		{
+
+		}
+
+		hlBool operator()(hlUInt uiLeft, hlUInt uiRight) const
+		{
+			return this->lpSegments[uiLeft].uiOffset < this->lpSegments[uiRight].uiOffset;
+		}
+	};
+}
+
+//
+// SortStreamSegments()
+// Fills Order with the indices of the segments sorted by offset, so that they
+// can be read in a single forward pass over a stream.
+//
+hlVoid HLLib::SortStreamSegments(const HLStreamSegment *lpSegments, hlUInt uiCount, std::vector<hlUInt> &Order)
+{
+	Order.resize(uiCount);
+	for(hlUInt i = 0; i < uiCount; i++)
+	{
+		Order[i] = i;
+	}
+
+	std::stable_sort(Order.begin(), Order.end(), CSegmentOffsetLess(lpSegments));
+}
+
+#ifndef _WIN32
+//
+// AdviseFile()
+// Passes an access hint for a byte range of a file descriptor on to the page cache.
+//
+hlVoid HLLib::AdviseFile(hlInt iFile, hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint)
+{
+#ifdef POSIX_FADV_NORMAL
+	hlInt iAdvice;
+	switch(eHint)
+	{
+	case HL_ACCESS_HINT_SEQUENTIAL:
+		iAdvice = POSIX_FADV_SEQUENTIAL;
+		break;
+	case HL_ACCESS_HINT_RANDOM:
+		iAdvice = POSIX_FADV_RANDOM;
+		break;
+	case HL_ACCESS_HINT_WILL_NEED:
+		iAdvice = POSIX_FADV_WILLNEED;
+		break;
+	case HL_ACCESS_HINT_DONT_NEED:
+		iAdvice = POSIX_FADV_DONTNEED;
+		break;
+	default:
+		iAdvice = POSIX_FADV_NORMAL;
+		break;
+	}
+
+	posix_fadvise(iFile, static_cast<off_t>(uiOffset), static_cast<off_t>(uiLength), iAdvice);
+#endif
+}
+
+//
+// AdviseMemory()
+// Passes an access hint for a range of mapped memory on to the virtual memory system.
+// The range is widened to page boundaries.
+//
+hlVoid HLLib::AdviseMemory(const hlVoid *lpData, hlULongLong uiLength, HLAccessHint eHint)
+{
+	hlInt iAdvice;
+	switch(eHint)
+	{
+	case HL_ACCESS_HINT_SEQUENTIAL:
+		iAdvice = MADV_SEQUENTIAL;
+		break;
+	case HL_ACCESS_HINT_RANDOM:
+		iAdvice = MADV_RANDOM;
+		break;
+	case HL_ACCESS_HINT_WILL_NEED:
+		iAdvice = MADV_WILLNEED;
+		break;
+	case HL_ACCESS_HINT_DONT_NEED:
+		iAdvice = MADV_DONTNEED;
+		break;
+	default:
+		iAdvice = MADV_NORMAL;
+		break;
+	}
+
+	hlULongLong uiPageSize = static_cast<hlULongLong>(sysconf(_SC_PAGESIZE));
+	hlULongLong uiStart = reinterpret_cast<hlULongLong>(lpData);
+	hlULongLong uiAlignedStart = uiStart - uiStart % uiPageSize;
+
+	madvise(reinterpret_cast<hlVoid *>(uiAlignedStart), static_cast<size_t>(uiLength + (uiStart - uiAlignedStart)), iAdvice);
+}
+#endif
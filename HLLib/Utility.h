@@ -30,6 +30,13 @@ namespace HLLib
 	extern hlChar NibbleToChar(hlByte uiNibble);
 	extern hlUInt BufferToHexString(const hlByte *lpBuffer, hlUInt uiBufferSize, hlChar* lpString, hlUInt uiStringSize);
 	extern hlUInt WStringToString(const hlWChar *lpSource, hlChar* lpDest, hlUInt uiDestSize);
+
+	extern hlVoid SortStreamSegments(const HLStreamSegment *lpSegments, hlUInt uiCount, std::vector<hlUInt> &Order);
+
+#ifndef _WIN32
+	extern hlVoid AdviseFile(hlInt iFile, hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+	extern hlVoid AdviseMemory(const hlVoid *lpData, hlULongLong uiLength, HLAccessHint eHint);
+#endif
 }
 
 #endif
@@ -199,7 +199,7 @@ hlVoid CVBSPFile::UnmapDataStructures()
 
 CDirectoryFolder *CVBSPFile::CreateRoot()
 {
-	CDirectoryFolder *pRoot = new CDirectoryFolder(this);
+	CDirectoryFolder *pRoot = new CDirectoryFolder(this, &this->GetDirectoryArena());
 
 	hlChar lpFileName[256];
 
@@ -637,11 +637,11 @@ hlBool CVBSPFile::CreateStreamInternal(const CDirectoryFile *pFile, Streams::ISt
 			return hlFalse;
 		}
 
-		pStream = new Streams::CMappingStream(*this->pMapping, this->pHeader->lpLumps[HL_VBSP_LUMP_PAKFILE].uiOffset + pDirectoryItem->uiRelativeOffsetOfLocalHeader + sizeof(ZIPLocalFileHeader) + DirectoryEntry.uiFileNameLength + DirectoryEntry.uiExtraFieldLength, DirectoryEntry.uiUncompressedSize);
+		pStream = this->CreateMappingStream(*this->pMapping, this->pHeader->lpLumps[HL_VBSP_LUMP_PAKFILE].uiOffset + pDirectoryItem->uiRelativeOffsetOfLocalHeader + sizeof(ZIPLocalFileHeader) + DirectoryEntry.uiFileNameLength + DirectoryEntry.uiExtraFieldLength, DirectoryEntry.uiUncompressedSize);
 	}
 	else if(pFile->GetID() < HL_VBSP_LUMP_COUNT)
 	{
-		pStream = new Streams::CMappingStream(*this->pMapping, this->pHeader->lpLumps[pFile->GetID()].uiOffset, this->pHeader->lpLumps[pFile->GetID()].uiLength);
+		pStream = this->CreateMappingStream(*this->pMapping, this->pHeader->lpLumps[pFile->GetID()].uiOffset, this->pHeader->lpLumps[pFile->GetID()].uiLength);
 	}
 	else
 	{
@@ -665,7 +665,7 @@ hlBool CVBSPFile::CreateStreamInternal(const CDirectoryFile *pFile, Streams::ISt
 
 		memcpy(lpBuffer + sizeof(LMPHeader), pLumpView->GetView(), this->pHeader->lpLumps[uiID].uiLength);
 
-		pStream = new Streams::CMemoryStream(lpBuffer, uiBufferSize);
+		pStream = this->CreateMemoryStream(lpBuffer, uiBufferSize);
 
 		this->pMapping->Unmap(pLumpView);
 	}
@@ -681,6 +681,59 @@ hlVoid CVBSPFile::ReleaseStreamInternal(Streams::IStream &Stream) const
 	}
 }
 
+hlBool CVBSPFile::MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const
+{
+	if(pFile->GetData())
+	{
+		const ZIPFileHeader *pDirectoryItem = static_cast<const ZIPFileHeader *>(pFile->GetData());
+
+		if(pDirectoryItem->uiCompressionMethod != 0)
+		{
+			LastError.SetErrorMessage("File is compressed.");
+			return hlFalse;
+		}
+
+		if((pDirectoryItem->uiFlags & 0x01u) != 0)
+		{
+			LastError.SetErrorMessage("File is encrypted.");
+			return hlFalse;
+		}
+
+		if(pDirectoryItem->uiDiskNumberStart != this->pEndOfCentralDirectoryRecord->uiNumberOfThisDisk)
+		{
+			LastError.SetErrorMessageFormated("File resides on disk %u.", pDirectoryItem->uiDiskNumberStart);
+			return hlFalse;
+		}
+
+		Mapping::CView *pDirectoryEntryView = 0;
+
+		if(!this->pMapping->Map(pDirectoryEntryView, this->pHeader->lpLumps[HL_VBSP_LUMP_PAKFILE].uiOffset + pDirectoryItem->uiRelativeOffsetOfLocalHeader, sizeof(ZIPLocalFileHeader)))
+		{
+			return hlFalse;
+		}
+
+		const ZIPLocalFileHeader DirectoryEntry = *static_cast<const ZIPLocalFileHeader *>(pDirectoryEntryView->GetView());
+
+		this->pMapping->Unmap(pDirectoryEntryView);
+
+		if(DirectoryEntry.uiSignature != HL_VBSP_ZIP_LOCAL_FILE_HEADER_SIGNATURE)
+		{
+			LastError.SetErrorMessage("Invalid file data offset.");
+			return hlFalse;
+		}
+
+		// The central directory always holds the sizes, even when the local header defers them.
+		return this->pMapping->Map(pView, this->pHeader->lpLumps[HL_VBSP_LUMP_PAKFILE].uiOffset + pDirectoryItem->uiRelativeOffsetOfLocalHeader + sizeof(ZIPLocalFileHeader) + DirectoryEntry.uiFileNameLength + DirectoryEntry.uiExtraFieldLength, pDirectoryItem->uiUncompressedSize);
+	}
+	else if(pFile->GetID() < HL_VBSP_LUMP_COUNT)
+	{
+		return this->pMapping->Map(pView, this->pHeader->lpLumps[pFile->GetID()].uiOffset, this->pHeader->lpLumps[pFile->GetID()].uiLength);
+	}
+
+	// .lmp files are built in memory with a header in front of the lump.
+	return CPackage::MapContentsInternal(pFile, pView);
+}
+
 hlVoid CVBSPFile::GetFileName(hlChar *lpBuffer, hlUInt uiBufferSize)
 {
 	if(lpBuffer == 0 || uiBufferSize == 0)
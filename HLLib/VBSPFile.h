@@ -147,6 +147,8 @@ namespace HLLib
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
 		virtual hlVoid ReleaseStreamInternal(Streams::IStream &Stream) const;
 
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
+
 	private:
 		hlVoid GetFileName(hlChar *lpBuffer, hlUInt uiBufferSize);
 	};
@@ -15,6 +15,13 @@
 #include "Streams.h"
 #include "Checksum.h"
 
+#include <new>
+
+// Directory items are constructed in the arena with placement new.
+#if DEBUG_TRACK_MEMORY
+#	undef new
+#endif
+
 using namespace HLLib;
 
 #define HL_VPK_SIGNATURE 0x55aa1234
@@ -186,7 +193,7 @@ hlBool CVPKFile::MapDataStructures()
 					}
 				}
 
-				this->pDirectoryItems->push_back(new VPKDirectoryItem(lpExtension, lpPath, lpName, pDirectoryEntry, lpPreloadData));
+				this->pDirectoryItems->push_back(new(this->GetDirectoryArena().Allocate(sizeof(VPKDirectoryItem))) VPKDirectoryItem(lpExtension, lpPath, lpName, pDirectoryEntry, lpPreloadData));
 			}
 		}
 	}
@@ -210,12 +217,21 @@ hlBool CVPKFile::MapDataStructures()
 				{
 					strcat(lpArchiveNumber + iPrinted, lpExtension);
 
-					if(this->pMapping->GetMode() & HL_MODE_NO_FILEMAPPING)
+					// Back the archives the same way CPackage::Open() backs a file.
+					hlUInt uiMode = this->pMapping->GetMode();
+					if(uiMode & (HL_MODE_DIRECT_IO | HL_MODE_NO_FILEMAPPING | HL_MODE_ASYNC_IO))
 					{
-						this->lpArchives[i].pStream = new Streams::CFileStream(lpArchiveFileName);
+						if(uiMode & HL_MODE_DIRECT_IO)
+						{
+							this->lpArchives[i].pStream = new Streams::CFileStream(lpArchiveFileName);
+						}
+						else
+						{
+							this->lpArchives[i].pStream = new Streams::CBufferedStream(new Streams::CFileStream(lpArchiveFileName), hlTrue);
+						}
 						this->lpArchives[i].pMapping = new Mapping::CStreamMapping(*this->lpArchives[i].pStream);
 
-						if(!this->lpArchives[i].pMapping->Open(this->pMapping->GetMode()))
+						if(!this->lpArchives[i].pMapping->Open(uiMode))
 						{
 							delete this->lpArchives[i].pMapping;
 							this->lpArchives[i].pMapping = 0;
@@ -228,7 +244,7 @@ hlBool CVPKFile::MapDataStructures()
 					{
 						this->lpArchives[i].pMapping = new Mapping::CFileMapping(lpArchiveFileName);
 
-						if(!this->lpArchives[i].pMapping->Open(this->pMapping->GetMode()))
+						if(!this->lpArchives[i].pMapping->Open(uiMode))
 						{
 							delete this->lpArchives[i].pMapping;
 							this->lpArchives[i].pMapping = 0;
@@ -269,22 +285,15 @@ hlVoid CVPKFile::UnmapDataStructures()
 	this->lpArchives = 0;
 
 	this->pHeader = 0;
-	if(this->pDirectoryItems != 0)
-	{
-		for(CDirectoryItemList::iterator i = this->pDirectoryItems->begin(); i != this->pDirectoryItems->end(); ++i)
-		{
-			delete *i;
-		}
-		delete this->pDirectoryItems;
-		this->pDirectoryItems = 0;
-	}
+	delete this->pDirectoryItems;
+	this->pDirectoryItems = 0;
 
 	this->pMapping->Unmap(this->pView);
 }
 
 CDirectoryFolder *CVPKFile::CreateRoot()
 {
-	CDirectoryFolder *pRoot = new CDirectoryFolder(this);
+	CDirectoryFolder *pRoot = new CDirectoryFolder(this, &this->GetDirectoryArena());
 
 	const hlChar *lpLastPath = 0;
 	CDirectoryFolder *pLastInsertFolder = 0;
@@ -305,9 +314,9 @@ CDirectoryFolder *CVPKFile::CreateRoot()
 
 			if(*pDirectoryItem->lpPath != '\0' && strcmp(pDirectoryItem->lpPath, " ") != 0)
 			{
-				// Tokenize the file path and create the directories.
-				hlChar *lpPath = new hlChar[strlen(pDirectoryItem->lpPath) + 1];
-				strcpy(lpPath, pDirectoryItem->lpPath);
+				// Tokenize a copy of the file path in the arena and create the directories,
+				// new directories keep their token as their name.
+				hlChar *lpPath = const_cast<hlChar *>(this->GetDirectoryArena().CopyString(pDirectoryItem->lpPath));
 				hlChar *lpToken = strtok(lpPath, "/\\");
 				while(lpToken != 0)
 				{
@@ -316,7 +325,7 @@ CDirectoryFolder *CVPKFile::CreateRoot()
 					if(pItem == 0 || pItem->GetType() == HL_ITEM_FILE)
 					{
 						// It doesn't, create it.
-						pInsertFolder = pInsertFolder->AddFolder(lpToken);
+						pInsertFolder = pInsertFolder->AddFolder(lpToken, HL_ID_INVALID, 0, hlFalse);
 					}
 					else
 					{
@@ -325,21 +334,18 @@ CDirectoryFolder *CVPKFile::CreateRoot()
 					}
 					lpToken = strtok(0, "/\\");
 				}
-				delete []lpPath;
 			}
 
 			lpLastPath = pDirectoryItem->lpPath;
 			pLastInsertFolder = pInsertFolder;
 		}
 
-		hlChar *lpFileName = new hlChar[strlen(pDirectoryItem->lpName) + 1 + strlen(pDirectoryItem->lpExtention) + 1];
+		hlChar *lpFileName = static_cast<hlChar *>(this->GetDirectoryArena().Allocate((hlUInt)(strlen(pDirectoryItem->lpName) + 1 + strlen(pDirectoryItem->lpExtention) + 1)));
 		strcpy(lpFileName, pDirectoryItem->lpName);
 		strcat(lpFileName, ".");
 		strcat(lpFileName, pDirectoryItem->lpExtention);
 
-		pInsertFolder->AddFile(lpFileName, -1, const_cast<VPKDirectoryItem *>(pDirectoryItem));
-
-		delete []lpFileName;
+		pInsertFolder->AddFile(lpFileName, -1, const_cast<VPKDirectoryItem *>(pDirectoryItem), hlFalse);
 	}
 
 	return pRoot;
@@ -461,6 +467,8 @@ hlBool CVPKFile::GetFileValidationInternal(const CDirectoryFile *pFile, HLValida
 			{
 				if(pStream->Open(HL_MODE_READ))
 				{
+					pStream->Advise(0, pStream->GetStreamSize(), HL_ACCESS_HINT_SEQUENTIAL);
+
 					hlULong uiChecksum = 0;
 					eValidation = HL_VALIDATES_OK;
 
@@ -496,6 +504,7 @@ hlBool CVPKFile::GetFileValidationInternal(const CDirectoryFile *pFile, HLValida
 						}
 					}
 
+					pStream->Advise(0, pStream->GetStreamSize(), HL_ACCESS_HINT_NORMAL);
 					pStream->Close();
 				}
 				else
@@ -550,11 +559,11 @@ hlBool CVPKFile::CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStr
 	{
 		if(pDirectoryItem->lpPreloadData != 0)
 		{
-			pStream = new Streams::CMemoryStream(const_cast<hlVoid *>(pDirectoryItem->lpPreloadData), pDirectoryItem->pDirectoryEntry->uiEntryLength + pDirectoryItem->pDirectoryEntry->uiPreloadBytes);
+			pStream = this->CreateMemoryStream(const_cast<hlVoid *>(pDirectoryItem->lpPreloadData), pDirectoryItem->pDirectoryEntry->uiEntryLength + pDirectoryItem->pDirectoryEntry->uiPreloadBytes);
 		}
 		else if(pDirectoryItem->pDirectoryEntry->uiPreloadBytes == 0 && pDirectoryItem->pDirectoryEntry->uiEntryLength == 0)
 		{
-			pStream = new Streams::CNullStream();
+			pStream = this->CreateNullStream();
 		}
 		else
 		{
@@ -581,11 +590,11 @@ hlBool CVPKFile::CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStr
 
 				this->lpArchives[pDirectoryItem->pDirectoryEntry->uiArchiveIndex].pMapping->Unmap(pView);
 
-				pStream = new Streams::CMemoryStream(lpBuffer, uiBufferSize);
+				pStream = this->CreateMemoryStream(lpBuffer, uiBufferSize);
 			}
 			else
 			{
-				pStream = new Streams::CMappingStream(*this->lpArchives[pDirectoryItem->pDirectoryEntry->uiArchiveIndex].pMapping, pDirectoryItem->pDirectoryEntry->uiEntryOffset, pDirectoryItem->pDirectoryEntry->uiEntryLength);
+				pStream = this->CreateMappingStream(*this->lpArchives[pDirectoryItem->pDirectoryEntry->uiArchiveIndex].pMapping, pDirectoryItem->pDirectoryEntry->uiEntryOffset, pDirectoryItem->pDirectoryEntry->uiEntryLength);
 			}
 		}
 		else
@@ -595,11 +604,11 @@ hlBool CVPKFile::CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStr
 	}
 	else if(pDirectoryItem->pDirectoryEntry->uiPreloadBytes != 0)
 	{
-		pStream = new Streams::CMemoryStream(const_cast<hlVoid *>(pDirectoryItem->lpPreloadData), pDirectoryItem->pDirectoryEntry->uiPreloadBytes);
+		pStream = this->CreateMemoryStream(const_cast<hlVoid *>(pDirectoryItem->lpPreloadData), pDirectoryItem->pDirectoryEntry->uiPreloadBytes);
 	}
 	else
 	{
-		pStream = new Streams::CNullStream();
+		pStream = this->CreateNullStream();
 	}
 
 	return hlTrue;
@@ -617,3 +626,22 @@ hlVoid CVPKFile::ReleaseStreamInternal(Streams::IStream &Stream) const
 		}
 	}
 }
+
+hlBool CVPKFile::MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const
+{
+	const VPKDirectoryItem *pDirectoryItem = static_cast<const VPKDirectoryItem *>(pFile->GetData());
+
+	// Entries with preload data are split between the directory and an archive.
+	if(pDirectoryItem->pDirectoryEntry->uiArchiveIndex == HL_VPK_NO_ARCHIVE || pDirectoryItem->pDirectoryEntry->uiPreloadBytes != 0 || pDirectoryItem->pDirectoryEntry->uiEntryLength == 0)
+	{
+		return CPackage::MapContentsInternal(pFile, pView);
+	}
+
+	if(this->lpArchives[pDirectoryItem->pDirectoryEntry->uiArchiveIndex].pMapping == 0)
+	{
+		LastError.SetErrorMessage("Archive not found.");
+		return hlFalse;
+	}
+
+	return this->lpArchives[pDirectoryItem->pDirectoryEntry->uiArchiveIndex].pMapping->Map(pView, pDirectoryItem->pDirectoryEntry->uiEntryOffset, pDirectoryItem->pDirectoryEntry->uiEntryLength);
+}
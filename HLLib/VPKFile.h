@@ -78,7 +78,8 @@ namespace HLLib
 			const hlVoid *lpPreloadData;
 		};
 
-		typedef std::list<VPKDirectoryItem *> CDirectoryItemList;
+		// Items are allocated from the package's directory arena.
+		typedef std::vector<VPKDirectoryItem *> CDirectoryItemList;
 
 	private:
 		static const char *lpAttributeNames[];
@@ -124,6 +125,8 @@ namespace HLLib
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
 		virtual hlVoid ReleaseStreamInternal(Streams::IStream &Stream) const;
 
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
+
 	private:
 		hlBool MapString(const hlChar *&lpViewData, const hlChar *lpViewDirectoryDataEnd, const hlChar *&lpString);
 	};
@@ -88,7 +88,7 @@ hlVoid CWADFile::UnmapDataStructures()
 
 CDirectoryFolder *CWADFile::CreateRoot()
 {
-	CDirectoryFolder *pRoot = new CDirectoryFolder(this);
+	CDirectoryFolder *pRoot = new CDirectoryFolder(this, &this->GetDirectoryArena());
 
 	// Loop through each lump in the WAD file.
 	for(hlUInt i = 0; i < this->pHeader->uiLumpCount; i++)
@@ -418,7 +418,7 @@ hlBool CWADFile::CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStr
 
 	this->pMapping->Unmap(pView);
 
-	pStream = new Streams::CMemoryStream(lpBuffer, uiBufferSize);
+	pStream = this->CreateMemoryStream(lpBuffer, uiBufferSize);
 
 	return hlTrue;
 }
@@ -223,6 +223,16 @@ HLLIB_API HLDirectoryItem *hlFolderFindNext(HLDirectoryItem *pFolder, HLDirector
 	return 0;
 }
 
+HLLIB_API hlUInt hlFolderFindAll(HLDirectoryItem *pFolder, const hlChar *lpSearch, HLFindType eFind, HLDirectoryItem **lpItems, hlUInt uiItemCount)
+{
+	if(static_cast<CDirectoryItem *>(pFolder)->GetType() == HL_ITEM_FOLDER)
+	{
+		return static_cast<CDirectoryFolder *>(pFolder)->FindAll(lpSearch, reinterpret_cast<CDirectoryItem **>(lpItems), uiItemCount, eFind);
+	}
+
+	return 0;
+}
+
 HLLIB_API hlUInt hlFolderGetSize(const HLDirectoryItem *pItem, hlBool bRecurse)
 {
 	if(static_cast<const CDirectoryItem *>(pItem)->GetType() == HL_ITEM_FOLDER)
@@ -283,6 +293,49 @@ HLLIB_API hlUInt hlFolderGetFileCount(const HLDirectoryItem *pItem, hlBool bRecu
 	return 0;
 }
 
+//
+// Directory Iterator
+//
+
+HLLIB_API hlBool hlIteratorCreate(HLDirectoryItem *pFolder, const hlChar *lpSearch, HLFindType eFind, HLDirectoryIterator **pIterator)
+{
+	*pIterator = 0;
+
+	if(static_cast<CDirectoryItem *>(pFolder)->GetType() == HL_ITEM_FOLDER)
+	{
+		*pIterator = new CDirectoryIterator(static_cast<CDirectoryFolder *>(pFolder), lpSearch, eFind);
+
+		return hlTrue;
+	}
+
+	return hlFalse;
+}
+
+HLLIB_API hlVoid hlIteratorDelete(HLDirectoryIterator *pIterator)
+{
+	delete static_cast<CDirectoryIterator *>(pIterator);
+}
+
+HLLIB_API HLDirectoryItem *hlIteratorGetItem(const HLDirectoryIterator *pIterator)
+{
+	return const_cast<CDirectoryItem *>(static_cast<const CDirectoryIterator *>(pIterator)->GetItem());
+}
+
+HLLIB_API HLDirectoryItem *hlIteratorNext(HLDirectoryIterator *pIterator)
+{
+	return const_cast<CDirectoryItem *>(static_cast<CDirectoryIterator *>(pIterator)->Next());
+}
+
+HLLIB_API hlVoid hlIteratorSkipSubtree(HLDirectoryIterator *pIterator)
+{
+	static_cast<CDirectoryIterator *>(pIterator)->SkipSubtree();
+}
+
+HLLIB_API hlVoid hlIteratorReset(HLDirectoryIterator *pIterator)
+{
+	static_cast<CDirectoryIterator *>(pIterator)->Reset();
+}
+
 //
 // Directory File
 //
@@ -351,6 +404,36 @@ HLLIB_API hlVoid hlFileReleaseStream(HLDirectoryItem *pItem, HLStream *pStream)
 	}
 }
 
+HLLIB_API hlBool hlFileMapContents(HLDirectoryItem *pItem, const hlVoid **lpData, hlULongLong *pSize, HLView **pView)
+{
+	*lpData = 0;
+	*pSize = 0;
+	*pView = 0;
+
+	if(static_cast<const CDirectoryItem *>(pItem)->GetType() == HL_ITEM_FILE)
+	{
+		CView *pTemp = 0;
+		if(static_cast<CDirectoryFile *>(pItem)->MapContents(pTemp))
+		{
+			*lpData = pTemp->GetView();
+			*pSize = pTemp->GetLength();
+			*pView = pTemp;
+
+			return hlTrue;
+		}
+	}
+
+	return hlFalse;
+}
+
+HLLIB_API hlVoid hlFileUnmapContents(HLDirectoryItem *pItem, HLView *pView)
+{
+	if(static_cast<const CDirectoryItem *>(pItem)->GetType() == HL_ITEM_FILE)
+	{
+		static_cast<CDirectoryFile *>(pItem)->UnmapContents(static_cast<CView *>(pView));
+	}
+}
+
 //
 // Stream
 //
@@ -420,6 +503,16 @@ HLLIB_API hlUInt hlStreamRead(HLStream *pStream, hlVoid *lpData, hlUInt uiBytes)
 	return static_cast<IStream *>(pStream)->Read(lpData, uiBytes);
 }
 
+HLLIB_API hlULongLong hlStreamReadV(HLStream *pStream, HLStreamSegment *lpSegments, hlUInt uiCount)
+{
+	return static_cast<IStream *>(pStream)->ReadV(lpSegments, uiCount);
+}
+
+HLLIB_API hlULongLong hlStreamReadVAt(HLStream *pStream, hlULongLong uiOffset, HLStreamSegment *lpSegments, hlUInt uiCount)
+{
+	return static_cast<IStream *>(pStream)->ReadVAt(uiOffset, lpSegments, uiCount);
+}
+
 HLLIB_API hlBool hlStreamWriteChar(HLStream *pStream, hlChar iChar)
 {
 	return static_cast<IStream *>(pStream)->Write(iChar);
@@ -736,6 +829,22 @@ HLLIB_API hlBool hlPackageOpenStream(HLStream *pStream, hlUInt uiMode)
 	return pPackage->Open(*static_cast<IStream *>(pStream), uiMode);
 }
 
+HLLIB_API hlBool hlPackageOpenItem(HLDirectoryItem *pItem, hlUInt uiMode)
+{
+	if(pPackage == 0)
+	{
+		return hlFalse;
+	}
+
+	if(static_cast<const CDirectoryItem *>(pItem)->GetType() != HL_ITEM_FILE)
+	{
+		LastError.SetErrorMessage("Item is not a file.");
+		return hlFalse;
+	}
+
+	return pPackage->Open(*static_cast<const CDirectoryFile *>(pItem), uiMode);
+}
+
 HLLIB_API hlVoid hlPackageClose()
 {
 	if(pPackage == 0)
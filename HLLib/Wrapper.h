@@ -53,6 +53,7 @@ HLLIB_API hlVoid hlFolderSort(HLDirectoryItem *pItem, HLSortField eField, HLSort
 
 HLLIB_API HLDirectoryItem *hlFolderFindFirst(HLDirectoryItem *pFolder, const hlChar *lpSearch, HLFindType eFind);
 HLLIB_API HLDirectoryItem *hlFolderFindNext(HLDirectoryItem *pFolder, HLDirectoryItem *pItem, const hlChar *lpSearch, HLFindType eFind);
+HLLIB_API hlUInt hlFolderFindAll(HLDirectoryItem *pFolder, const hlChar *lpSearch, HLFindType eFind, HLDirectoryItem **lpItems, hlUInt uiItemCount);
 
 HLLIB_API hlUInt hlFolderGetSize(const HLDirectoryItem *pItem, hlBool bRecurse);
 HLLIB_API hlULongLong hlFolderGetSizeEx(const HLDirectoryItem *pItem, hlBool bRecurse);
@@ -61,6 +62,19 @@ HLLIB_API hlULongLong hlFolderGetSizeOnDiskEx(const HLDirectoryItem *pItem, hlBo
 HLLIB_API hlUInt hlFolderGetFolderCount(const HLDirectoryItem *pItem, hlBool bRecurse);
 HLLIB_API hlUInt hlFolderGetFileCount(const HLDirectoryItem *pItem, hlBool bRecurse);
 
+//
+// Directory Iterator
+//
+
+HLLIB_API hlBool hlIteratorCreate(HLDirectoryItem *pFolder, const hlChar *lpSearch, HLFindType eFind, HLDirectoryIterator **pIterator);
+HLLIB_API hlVoid hlIteratorDelete(HLDirectoryIterator *pIterator);
+
+HLLIB_API HLDirectoryItem *hlIteratorGetItem(const HLDirectoryIterator *pIterator);
+
+HLLIB_API HLDirectoryItem *hlIteratorNext(HLDirectoryIterator *pIterator);
+HLLIB_API hlVoid hlIteratorSkipSubtree(HLDirectoryIterator *pIterator);
+HLLIB_API hlVoid hlIteratorReset(HLDirectoryIterator *pIterator);
+
 //
 // Directory File
 //
@@ -73,6 +87,11 @@ HLLIB_API hlUInt hlFileGetSizeOnDisk(const HLDirectoryItem *pItem);
 HLLIB_API hlBool hlFileCreateStream(HLDirectoryItem *pItem, HLStream **pStream);
 HLLIB_API hlVoid hlFileReleaseStream(HLDirectoryItem *pItem, HLStream *pStream);
 
+// Without file mapping *lpData is a copy of the file's data, not the package's
+// own memory; it stays valid until hlFileUnmapContents().
+HLLIB_API hlBool hlFileMapContents(HLDirectoryItem *pItem, const hlVoid **lpData, hlULongLong *pSize, HLView **pView);
+HLLIB_API hlVoid hlFileUnmapContents(HLDirectoryItem *pItem, HLView *pView);
+
 //
 // Stream
 //
@@ -95,6 +114,8 @@ HLLIB_API hlULongLong hlStreamSeekEx(HLStream *pStream, hlLongLong iOffset, HLSe
 
 HLLIB_API hlBool hlStreamReadChar(HLStream *pStream, hlChar *pChar);
 HLLIB_API hlUInt hlStreamRead(HLStream *pStream, hlVoid *lpData, hlUInt uiBytes);
+HLLIB_API hlULongLong hlStreamReadV(HLStream *pStream, HLStreamSegment *lpSegments, hlUInt uiCount);
+HLLIB_API hlULongLong hlStreamReadVAt(HLStream *pStream, hlULongLong uiOffset, HLStreamSegment *lpSegments, hlUInt uiCount);
 
 HLLIB_API hlBool hlStreamWriteChar(HLStream *pStream, hlChar iChar);
 HLLIB_API hlUInt hlStreamWrite(HLStream *pStream, const hlVoid *lpData, hlUInt uiBytes);
@@ -121,6 +142,7 @@ HLLIB_API hlBool hlPackageOpenFile(const hlChar *lpFileName, hlUInt uiMode);
 HLLIB_API hlBool hlPackageOpenMemory(hlVoid *lpData, hlUInt uiBufferSize, hlUInt uiMode);
 HLLIB_API hlBool hlPackageOpenProc(hlVoid *pUserData, hlUInt uiMode);
 HLLIB_API hlBool hlPackageOpenStream(HLStream *pStream, hlUInt uiMode);
+HLLIB_API hlBool hlPackageOpenItem(HLDirectoryItem *pItem, hlUInt uiMode);
 HLLIB_API hlVoid hlPackageClose();
 
 HLLIB_API hlBool hlPackageDefragment();
@@ -132,7 +132,7 @@ hlVoid CXZPFile::UnmapDataStructures()
 
 CDirectoryFolder *CXZPFile::CreateRoot()
 {
-	CDirectoryFolder *pRoot = new CDirectoryFolder(this);
+	CDirectoryFolder *pRoot = new CDirectoryFolder(this, &this->GetDirectoryArena());
 
 	if(this->pHeader->uiDirectoryItemCount != 0)
 	{
@@ -331,7 +331,14 @@ hlBool CXZPFile::CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStr
 {
 	const XZPDirectoryEntry *pDirectoryEntry = this->lpDirectoryEntries + pFile->GetID();
 
-	pStream = new Streams::CMappingStream(*this->pMapping, pDirectoryEntry->uiEntryOffset, pDirectoryEntry->uiEntryLength);
+	pStream = this->CreateMappingStream(*this->pMapping, pDirectoryEntry->uiEntryOffset, pDirectoryEntry->uiEntryLength);
 
 	return hlTrue;
 }
+
+hlBool CXZPFile::MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const
+{
+	const XZPDirectoryEntry *pDirectoryEntry = this->lpDirectoryEntries + pFile->GetID();
+
+	return this->pMapping->Map(pView, pDirectoryEntry->uiEntryOffset, pDirectoryEntry->uiEntryLength);
+}
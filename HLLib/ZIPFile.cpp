@@ -14,69 +14,6 @@
 #include "Streams.h"
 #include "Checksum.h"
 
-#if USE_ZLIB
-#	ifdef _WIN32
-#		define ZLIB_WINAPI
-#	endif
-#	include <zlib.h>
-
-struct OutDesc
-{
-	Bytef *dest;
-	uLongf destLen;
-};
-
-static unsigned in(void FAR *in_desc, unsigned char FAR * FAR *input)
-{
-	return 0;
-}
-
-static int out(void FAR *out_desc, unsigned char FAR *ouput, unsigned len)
-{
-	if(len <= ((OutDesc*)(out_desc))->destLen)
-	{
-		memcpy(((OutDesc*)(out_desc))->dest, ouput, len);
-		((OutDesc*)(out_desc))->dest += len;
-		((OutDesc*)(out_desc))->destLen -= len;
-		return 0;
-	}
-	return 1;
-}
-
-static int uncompressBack(Bytef *dest, uLongf *destLen, const Bytef *source, uLong sourceLen)
-{
-    z_stream stream;
-    int err;
-
-    stream.next_in = (Bytef*)source;
-    stream.avail_in = (uInt)sourceLen;
-
-    stream.next_out = dest;
-    stream.avail_out = (uInt)*destLen;
-
-    stream.zalloc = (alloc_func)0;
-    stream.zfree = (free_func)0;
-
-	unsigned char window[32768];
-    err = inflateBackInit(&stream, 15, window);
-    if (err != Z_OK) return err;
-
-	OutDesc out_desc = { dest, *destLen };
-    err = inflateBack(&stream, in, 0, out, &out_desc);
-    if (err != Z_STREAM_END) {
-        inflateBackEnd(&stream);
-        if (err == Z_NEED_DICT || (err == Z_BUF_ERROR && stream.avail_in == 0))
-            return Z_DATA_ERROR;
-        return err;
-    }
-    *destLen = *destLen - out_desc.destLen;
-
-    err = inflateBackEnd(&stream);
-    return err;
-}
-
-#endif
-
 using namespace HLLib;
 
 #define HL_ZIP_LOCAL_FILE_HEADER_SIGNATURE					0x04034b50
@@ -213,7 +150,7 @@ hlVoid CZIPFile::UnmapDataStructures()
 
 CDirectoryFolder *CZIPFile::CreateRoot()
 {
-	CDirectoryFolder *pRoot = new CDirectoryFolder(this);
+	CDirectoryFolder *pRoot = new CDirectoryFolder(this, &this->GetDirectoryArena());
 
 	hlUInt uiTest, uiOffset = 0;
 	while(uiOffset < this->pEndOfCentralDirectoryRecord->uiCentralDirectorySize - sizeof(uiTest))
@@ -442,6 +379,8 @@ hlBool CZIPFile::GetFileValidationInternal(const CDirectoryFile *pFile, HLValida
 	{
 		if(pStream->Open(HL_MODE_READ))
 		{
+			pStream->Advise(0, pStream->GetStreamSize(), HL_ACCESS_HINT_SEQUENTIAL);
+
 			hlULongLong uiTotalBytes = 0, uiFileBytes = pStream->GetStreamSize();
 			hlUInt uiBufferSize;
 			hlByte lpBuffer[HL_ZIP_CHECKSUM_LENGTH];
@@ -464,6 +403,7 @@ hlBool CZIPFile::GetFileValidationInternal(const CDirectoryFile *pFile, HLValida
 				hlValidateFileProgress(const_cast<CDirectoryFile *>(pFile), uiTotalBytes, uiFileBytes, &bCancel);
 			}
 
+			pStream->Advise(0, pStream->GetStreamSize(), HL_ACCESS_HINT_NORMAL);
 			pStream->Close();
 		}
 
@@ -553,45 +493,16 @@ hlBool CZIPFile::CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStr
 	{
 		case 0: // None.
 		{
-			pStream = new Streams::CMappingStream(*this->pMapping, pDirectoryItem->uiRelativeOffsetOfLocalHeader + sizeof(ZIPLocalFileHeader) + DirectoryEntry.uiFileNameLength + DirectoryEntry.uiExtraFieldLength, DirectoryEntry.uiUncompressedSize);
+			pStream = this->CreateMappingStream(*this->pMapping, pDirectoryItem->uiRelativeOffsetOfLocalHeader + sizeof(ZIPLocalFileHeader) + DirectoryEntry.uiFileNameLength + DirectoryEntry.uiExtraFieldLength, DirectoryEntry.uiUncompressedSize);
 			return hlTrue;
 		}
 #if USE_ZLIB
 		case 8: // Deflate.
 		{
-			Mapping::CView *pFileDataView = 0;
-			if(this->pMapping->Map(pFileDataView, pDirectoryItem->uiRelativeOffsetOfLocalHeader + sizeof(ZIPLocalFileHeader) + DirectoryEntry.uiFileNameLength + DirectoryEntry.uiExtraFieldLength, DirectoryEntry.uiCompressedSize))
-			{
-				hlBool bResult = hlFalse;
-				hlByte *lpInflateBuffer = new hlByte[DirectoryEntry.uiUncompressedSize];
-				uLongf iInflateSize = DirectoryEntry.uiUncompressedSize;
-				switch(uncompressBack(lpInflateBuffer, &iInflateSize, static_cast<const hlByte *>(pFileDataView->GetView()), (uLong)DirectoryEntry.uiCompressedSize))
-				{
-				case Z_OK:
-					pStream = new Streams::CMemoryStream(lpInflateBuffer, iInflateSize);
-					bResult = hlTrue;
-					break;
-				case Z_MEM_ERROR:
-					delete []lpInflateBuffer;
-					LastError.SetErrorMessage("Deflate Error: Z_MEM_ERROR.");
-					break;
-				case Z_BUF_ERROR:
-					delete []lpInflateBuffer;
-					LastError.SetErrorMessage("Deflate Error: Z_BUF_ERROR.");
-					break;
-				case Z_DATA_ERROR:
-					delete []lpInflateBuffer;
-					LastError.SetErrorMessage("Deflate Error: Z_DATA_ERROR.");
-					break;
-				default:
-					delete []lpInflateBuffer;
-					LastError.SetErrorMessage("Deflate Error: Unknown.");
-					break;
-				}
-				this->pMapping->Unmap(pFileDataView);
-				return bResult;
-			}
-			return hlFalse;
+			hlULongLong uiOffset = pDirectoryItem->uiRelativeOffsetOfLocalHeader + sizeof(ZIPLocalFileHeader) + DirectoryEntry.uiFileNameLength + DirectoryEntry.uiExtraFieldLength;
+			Streams::IStream *pDeflateStream = new Streams::CMappingStream(*this->pMapping, uiOffset, DirectoryEntry.uiCompressedSize);
+			pStream = new Streams::CInflateStream(pDeflateStream, hlTrue, DirectoryEntry.uiUncompressedSize, hlTrue, this->GetInflateIndex(uiOffset, DirectoryEntry.uiUncompressedSize));
+			return hlTrue;
 		}
 #endif
 		default:
@@ -599,10 +510,45 @@ hlBool CZIPFile::CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStr
 	}
 }
 
-hlVoid CZIPFile::ReleaseStreamInternal(Streams::IStream &Stream) const
+hlBool CZIPFile::MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const
 {
-	if(Stream.GetType() == HL_STREAM_MEMORY)
+	const ZIPFileHeader *pDirectoryItem = static_cast<const ZIPFileHeader *>(pFile->GetData());
+
+	if(pDirectoryItem->uiCompressionMethod != 0)
+	{
+		LastError.SetErrorMessage("File is compressed.");
+		return hlFalse;
+	}
+
+	if((pDirectoryItem->uiFlags & 0x01u) != 0)
+	{
+		LastError.SetErrorMessageFormated("File is encrypted.");
+		return hlFalse;
+	}
+
+	if(pDirectoryItem->uiDiskNumberStart != this->pEndOfCentralDirectoryRecord->uiNumberOfThisDisk)
+	{
+		LastError.SetErrorMessageFormated("File resides on disk %u.", pDirectoryItem->uiDiskNumberStart);
+		return hlFalse;
+	}
+
+	Mapping::CView *pDirectoryEntryView = 0;
+
+	if(!this->pMapping->Map(pDirectoryEntryView, pDirectoryItem->uiRelativeOffsetOfLocalHeader, sizeof(ZIPLocalFileHeader)))
 	{
-		delete []static_cast<const hlByte *>(static_cast<Streams::CMemoryStream &>(Stream).GetBuffer());
+		return hlFalse;
 	}
-}
+
+	const ZIPLocalFileHeader DirectoryEntry = *static_cast<const ZIPLocalFileHeader *>(pDirectoryEntryView->GetView());
+
+	this->pMapping->Unmap(pDirectoryEntryView);
+
+	if(DirectoryEntry.uiSignature != HL_ZIP_LOCAL_FILE_HEADER_SIGNATURE)
+	{
+		LastError.SetErrorMessageFormated("Invalid file data offset.");
+		return hlFalse;
+	}
+
+	// The central directory always holds the sizes, even when the local header defers them.
+	return this->pMapping->Map(pView, pDirectoryItem->uiRelativeOffsetOfLocalHeader + sizeof(ZIPLocalFileHeader) + DirectoryEntry.uiFileNameLength + DirectoryEntry.uiExtraFieldLength, pDirectoryItem->uiUncompressedSize);
+}
@@ -116,7 +116,8 @@ namespace HLLib
 		virtual hlBool GetFileSizeOnDiskInternal(const CDirectoryFile *pFile, hlUInt &uiSize) const;
 
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
-		virtual hlVoid ReleaseStreamInternal(Streams::IStream &Stream) const;
+
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
 	};
 }
 
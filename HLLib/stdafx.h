@@ -73,6 +73,20 @@ typedef hlSingle		hlFloat;
 #define HL_DEFAULT_PACKAGE_TEST_BUFFER_SIZE 8
 #define HL_DEFAULT_VIEW_SIZE 131072
 #define HL_DEFAULT_COPY_BUFFER_SIZE 131072
+#define HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE 65536
+#define HL_DEFAULT_STREAM_MAPPING_CACHE_SIZE 8388608
+#define HL_DEFAULT_FILE_MAPPING_WINDOW_SIZE 67108864
+#define HL_DEFAULT_FILE_MAPPING_WINDOW_COUNT 4
+#define HL_DEFAULT_IO_URING_DEPTH 64
+#define HL_DEFAULT_DIRECT_IO_BUFFER_SIZE 1048576
+#define HL_DEFAULT_DIRECT_IO_BUFFER_COUNT 4
+#define HL_DEFAULT_BUFFERED_STREAM_READ_SIZE 65536
+#define HL_DEFAULT_BUFFERED_STREAM_WRITE_SIZE 65536
+#define HL_DEFAULT_GCF_STREAM_RUN_SIZE 1048576
+#define HL_DEFAULT_INFLATE_STREAM_BUFFER_SIZE 65536
+#define HL_DEFAULT_INFLATE_CHECKPOINT_SPACING 1048576
+#define HL_INFLATE_WINDOW_SIZE 32768
+#define HL_DEFAULT_STREAM_POOL_SIZE 64
 
 #ifdef __cplusplus
 extern "C" {
@@ -109,7 +123,19 @@ typedef enum
 	HL_PROC_DEFRAGMENT_PROGRESS_EX,
 	HL_PROC_SEEK_EX,
 	HL_PROC_TELL_EX,
-	HL_PROC_SIZE_EX
+	HL_PROC_SIZE_EX,
+	HL_STREAM_MAPPING_CACHE_SIZE,
+	HL_PACKAGE_CACHE_HITS,
+	HL_PACKAGE_CACHE_MISSES,
+	HL_MAPPING_MEMORY_BUDGET,
+	HL_MAPPING_MEMORY_USED,
+	HL_PACKAGE_EVICTIONS,
+	HL_GCF_STREAM_RUN_SIZE,
+	HL_INFLATE_CHECKPOINT_SPACING,
+	HL_PROC_READ_AT,
+	HL_PROC_READ_V,
+	HL_PROC_GET_POINTER,
+	HL_STREAM_POOL_SIZE
 } HLOption;
 
 typedef enum
@@ -120,7 +146,11 @@ typedef enum
 	HL_MODE_CREATE = 0x04,
 	HL_MODE_VOLATILE = 0x08,
 	HL_MODE_NO_FILEMAPPING = 0x10,
-	HL_MODE_QUICK_FILEMAPPING = 0x20
+	HL_MODE_QUICK_FILEMAPPING = 0x20,
+	HL_MODE_ASYNC_IO = 0x40,
+	HL_MODE_PREFAULT = 0x80,
+	HL_MODE_HUGE_PAGES = 0x100,
+	HL_MODE_DIRECT_IO = 0x200
 } HLFileMode;
 
 typedef enum
@@ -158,6 +188,7 @@ typedef enum
 	HL_FIND_MODE_STRING = 0x10,
 	HL_FIND_MODE_SUBSTRING = 0x20,
 	HL_FIND_MODE_WILDCARD = 0x00,
+	HL_FIND_BREADTH_FIRST = 0x40,
 	HL_FIND_ALL = HL_FIND_FILES | HL_FIND_FOLDERS
 } HLFindType;
 
@@ -169,7 +200,9 @@ typedef enum
 	HL_STREAM_MAPPING,
 	HL_STREAM_MEMORY,
 	HL_STREAM_PROC,
-	HL_STREAM_NULL
+	HL_STREAM_NULL,
+	HL_STREAM_BUFFERED,
+	HL_STREAM_INFLATE
 } HLStreamType;
 
 typedef enum
@@ -177,9 +210,19 @@ typedef enum
 	HL_MAPPING_NONE = 0,
 	HL_MAPPING_FILE,
 	HL_MAPPING_MEMORY,
-	HL_MAPPING_STREAM
+	HL_MAPPING_STREAM,
+	HL_MAPPING_SUB
 } HLMappingType;
 
+typedef enum
+{
+	HL_ACCESS_HINT_NORMAL = 0,
+	HL_ACCESS_HINT_SEQUENTIAL,
+	HL_ACCESS_HINT_RANDOM,
+	HL_ACCESS_HINT_WILL_NEED,
+	HL_ACCESS_HINT_DONT_NEED
+} HLAccessHint;
+
 typedef enum
 {
 	HL_PACKAGE_NONE = 0,
@@ -351,8 +394,19 @@ typedef struct
 	} Value;
 } HLAttribute;
 
+// One segment of a scatter read, see hlStreamReadV().
+typedef struct
+{
+	hlULongLong uiOffset;
+	hlVoid *lpData;
+	hlUInt uiBytes;
+	hlUInt uiBytesRead;
+} HLStreamSegment;
+
 typedef hlVoid HLDirectoryItem;
 typedef hlVoid HLStream;
+typedef hlVoid HLView;
+typedef hlVoid HLDirectoryIterator;
 
 typedef hlBool (*POpenProc) (hlUInt, hlVoid *);
 typedef hlVoid (*PCloseProc)(hlVoid *);
@@ -364,6 +418,11 @@ typedef hlUInt (*PTellProc) (hlVoid *);
 typedef hlULongLong (*PTellExProc) (hlVoid *);
 typedef hlUInt (*PSizeProc) (hlVoid *);
 typedef hlULongLong (*PSizeExProc) (hlVoid *);
+// HL_PROC_READ_AT makes ReadAt() positional.  Without it ReadAt() seeks, reads
+// and seeks back, which is not safe to overlap with other reads on the stream.
+typedef hlULongLong (*PReadAtProc) (hlVoid *, hlULongLong, hlULongLong, hlVoid *);
+typedef hlBool (*PReadVProc) (HLStreamSegment *, hlUInt, hlVoid *);
+typedef const hlVoid *(*PGetPointerProc) (hlVoid *);
 
 typedef hlVoid (*PExtractItemStartProc) (const HLDirectoryItem *pItem);
 typedef hlVoid (*PExtractItemEndProc) (const HLDirectoryItem *pItem, hlBool bSuccess);
@@ -395,6 +454,8 @@ typedef hlVoid (*PDefragmentProgressExProc) (const HLDirectoryItem *pFile, hlUIn
 #	include <sys/mman.h>
 #	include <unistd.h>
 #	include <fcntl.h>
+#	include <limits.h>
+#	include <sys/uio.h>
 
 #	ifndef O_BINARY
 #		define O_BINARY 0
@@ -449,6 +510,7 @@ typedef hlVoid (*PDefragmentProgressExProc) (const HLDirectoryItem *pFile, hlUIn
 
 #include <algorithm>
 #include <list>
+#include <map>
 #include <vector>
 
 #ifdef _WIN32
@@ -73,6 +73,22 @@ typedef hlSingle		hlFloat;
 #define HL_DEFAULT_PACKAGE_TEST_BUFFER_SIZE 8
 #define HL_DEFAULT_VIEW_SIZE 131072
 #define HL_DEFAULT_COPY_BUFFER_SIZE 131072
+#define HL_DEFAULT_STREAM_MAPPING_BLOCK_SIZE 65536
+#define HL_DEFAULT_STREAM_MAPPING_CACHE_SIZE 8388608
+#define HL_DEFAULT_FILE_MAPPING_WINDOW_SIZE 67108864
+#define HL_DEFAULT_FILE_MAPPING_WINDOW_COUNT 4
+#define HL_DEFAULT_IO_URING_DEPTH 64
+#define HL_DEFAULT_DIRECT_IO_BUFFER_SIZE 1048576
+#define HL_DEFAULT_DIRECT_IO_BUFFER_COUNT 4
+#define HL_DEFAULT_BUFFERED_STREAM_READ_SIZE 65536
+#define HL_DEFAULT_BUFFERED_STREAM_WRITE_SIZE 65536
+#define HL_DEFAULT_GCF_STREAM_RUN_SIZE 1048576
+#define HL_DEFAULT_INFLATE_STREAM_BUFFER_SIZE 65536
+#define HL_DEFAULT_INFLATE_CHECKPOINT_SPACING 1048576
+#define HL_INFLATE_WINDOW_SIZE 32768
+#define HL_DEFAULT_STREAM_POOL_SIZE 64
+#define HL_SEARCH_PATTERN_BUFFER_SIZE 128
+#define HL_SEARCH_PATTERN_SEGMENT_COUNT 16
 
 //
 // C data types.
@@ -113,7 +129,19 @@ typedef enum
 	HL_PROC_DEFRAGMENT_PROGRESS_EX,
 	HL_PROC_SEEK_EX,
 	HL_PROC_TELL_EX,
-	HL_PROC_SIZE_EX
+	HL_PROC_SIZE_EX,
+	HL_STREAM_MAPPING_CACHE_SIZE,
+	HL_PACKAGE_CACHE_HITS,
+	HL_PACKAGE_CACHE_MISSES,
+	HL_MAPPING_MEMORY_BUDGET,
+	HL_MAPPING_MEMORY_USED,
+	HL_PACKAGE_EVICTIONS,
+	HL_GCF_STREAM_RUN_SIZE,
+	HL_INFLATE_CHECKPOINT_SPACING,
+	HL_PROC_READ_AT,
+	HL_PROC_READ_V,
+	HL_PROC_GET_POINTER,
+	HL_STREAM_POOL_SIZE
 } HLOption;
 
 typedef enum
@@ -124,7 +152,11 @@ typedef enum
 	HL_MODE_CREATE = 0x04,
 	HL_MODE_VOLATILE = 0x08,
 	HL_MODE_NO_FILEMAPPING = 0x10,
-	HL_MODE_QUICK_FILEMAPPING = 0x20
+	HL_MODE_QUICK_FILEMAPPING = 0x20,
+	HL_MODE_ASYNC_IO = 0x40,
+	HL_MODE_PREFAULT = 0x80,
+	HL_MODE_HUGE_PAGES = 0x100,
+	HL_MODE_DIRECT_IO = 0x200
 } HLFileMode;
 
 typedef enum
@@ -162,6 +194,7 @@ typedef enum
 	HL_FIND_MODE_STRING = 0x10,
 	HL_FIND_MODE_SUBSTRING = 0x20,
 	HL_FIND_MODE_WILDCARD = 0x00,
+	HL_FIND_BREADTH_FIRST = 0x40,
 	HL_FIND_ALL = HL_FIND_FILES | HL_FIND_FOLDERS
 } HLFindType;
 
@@ -173,7 +206,9 @@ typedef enum
 	HL_STREAM_MAPPING,
 	HL_STREAM_MEMORY,
 	HL_STREAM_PROC,
-	HL_STREAM_NULL
+	HL_STREAM_NULL,
+	HL_STREAM_BUFFERED,
+	HL_STREAM_INFLATE
 } HLStreamType;
 
 typedef enum
@@ -181,9 +216,19 @@ typedef enum
 	HL_MAPPING_NONE = 0,
 	HL_MAPPING_FILE,
 	HL_MAPPING_MEMORY,
-	HL_MAPPING_STREAM
+	HL_MAPPING_STREAM,
+	HL_MAPPING_SUB
 } HLMappingType;
 
+typedef enum
+{
+	HL_ACCESS_HINT_NORMAL = 0,
+	HL_ACCESS_HINT_SEQUENTIAL,
+	HL_ACCESS_HINT_RANDOM,
+	HL_ACCESS_HINT_WILL_NEED,
+	HL_ACCESS_HINT_DONT_NEED
+} HLAccessHint;
+
 typedef enum
 {
 	HL_PACKAGE_NONE = 0,
@@ -355,8 +400,19 @@ typedef struct
 	} Value;
 } HLAttribute;
 
+// One segment of a scatter read, see hlStreamReadV().
+typedef struct
+{
+	hlULongLong uiOffset;
+	hlVoid *lpData;
+	hlUInt uiBytes;
+	hlUInt uiBytesRead;
+} HLStreamSegment;
+
 typedef hlVoid HLDirectoryItem;
 typedef hlVoid HLStream;
+typedef hlVoid HLView;
+typedef hlVoid HLDirectoryIterator;
 
 typedef hlBool (*POpenProc) (hlUInt, hlVoid *);
 typedef hlVoid (*PCloseProc)(hlVoid *);
@@ -367,6 +423,11 @@ typedef hlUInt (*PTellProc) (hlVoid *);
 typedef hlULongLong (*PTellExProc) (hlVoid *);
 typedef hlUInt (*PSizeProc) (hlVoid *);
 typedef hlULongLong (*PSizeExProc) (hlVoid *);
+// HL_PROC_READ_AT makes ReadAt() positional.  Without it ReadAt() seeks, reads
+// and seeks back, which is not safe to overlap with other reads on the stream.
+typedef hlULongLong (*PReadAtProc) (hlVoid *, hlULongLong, hlULongLong, hlVoid *);
+typedef hlBool (*PReadVProc) (HLStreamSegment *, hlUInt, hlVoid *);
+typedef const hlVoid *(*PGetPointerProc) (hlVoid *);
 
 typedef hlVoid (*PExtractItemStartProc) (const HLDirectoryItem *pItem);
 typedef hlVoid (*PExtractItemEndProc) (const HLDirectoryItem *pItem, hlBool bSuccess);
@@ -480,6 +541,7 @@ HLLIB_API hlVoid hlFolderSort(HLDirectoryItem *pItem, HLSortField eField, HLSort
 
 HLLIB_API HLDirectoryItem *hlFolderFindFirst(HLDirectoryItem *pFolder, const hlChar *lpSearch, HLFindType eFind);
 HLLIB_API HLDirectoryItem *hlFolderFindNext(HLDirectoryItem *pFolder, HLDirectoryItem *pItem, const hlChar *lpSearch, HLFindType eFind);
+HLLIB_API hlUInt hlFolderFindAll(HLDirectoryItem *pFolder, const hlChar *lpSearch, HLFindType eFind, HLDirectoryItem **lpItems, hlUInt uiItemCount);
 
 HLLIB_API hlUInt hlFolderGetSize(const HLDirectoryItem *pItem, hlBool bRecurse);
 HLLIB_API hlULongLong hlFolderGetSizeEx(const HLDirectoryItem *pItem, hlBool bRecurse);
@@ -488,6 +550,19 @@ HLLIB_API hlULongLong hlFolderGetSizeOnDiskEx(const HLDirectoryItem *pItem, hlBo
 HLLIB_API hlUInt hlFolderGetFolderCount(const HLDirectoryItem *pItem, hlBool bRecurse);
 HLLIB_API hlUInt hlFolderGetFileCount(const HLDirectoryItem *pItem, hlBool bRecurse);
 
+//
+// Directory Iterator
+//
+
+HLLIB_API hlBool hlIteratorCreate(HLDirectoryItem *pFolder, const hlChar *lpSearch, HLFindType eFind, HLDirectoryIterator **pIterator);
+HLLIB_API hlVoid hlIteratorDelete(HLDirectoryIterator *pIterator);
+
+HLLIB_API HLDirectoryItem *hlIteratorGetItem(const HLDirectoryIterator *pIterator);
+
+HLLIB_API HLDirectoryItem *hlIteratorNext(HLDirectoryIterator *pIterator);
+HLLIB_API hlVoid hlIteratorSkipSubtree(HLDirectoryIterator *pIterator);
+HLLIB_API hlVoid hlIteratorReset(HLDirectoryIterator *pIterator);
+
 //
 // Directory File
 //
@@ -500,6 +575,11 @@ HLLIB_API hlUInt hlFileGetSizeOnDisk(const HLDirectoryItem *pItem);
 HLLIB_API hlBool hlFileCreateStream(HLDirectoryItem *pItem, HLStream **pStream);
 HLLIB_API hlVoid hlFileReleaseStream(HLDirectoryItem *pItem, HLStream *pStream);
 
+// Without file mapping *lpData is a copy of the file's data, not the package's
+// own memory; it stays valid until hlFileUnmapContents().
+HLLIB_API hlBool hlFileMapContents(HLDirectoryItem *pItem, const hlVoid **lpData, hlULongLong *pSize, HLView **pView);
+HLLIB_API hlVoid hlFileUnmapContents(HLDirectoryItem *pItem, HLView *pView);
+
 //
 // Stream
 //
@@ -522,6 +602,8 @@ HLLIB_API hlULongLong hlStreamSeekEx(HLStream *pStream, hlLongLong iOffset, HLSe
 
 HLLIB_API hlBool hlStreamReadChar(HLStream *pStream, hlChar *pChar);
 HLLIB_API hlUInt hlStreamRead(HLStream *pStream, hlVoid *lpData, hlUInt uiBytes);
+HLLIB_API hlULongLong hlStreamReadV(HLStream *pStream, HLStreamSegment *lpSegments, hlUInt uiCount);
+HLLIB_API hlULongLong hlStreamReadVAt(HLStream *pStream, hlULongLong uiOffset, HLStreamSegment *lpSegments, hlUInt uiCount);
 
 HLLIB_API hlBool hlStreamWriteChar(HLStream *pStream, hlChar iChar);
 HLLIB_API hlUInt hlStreamWrite(HLStream *pStream, const hlVoid *lpData, hlUInt uiBytes);
@@ -548,6 +630,7 @@ HLLIB_API hlBool hlPackageOpenFile(const hlChar *lpFileName, hlUInt uiMode);
 HLLIB_API hlBool hlPackageOpenMemory(hlVoid *lpData, hlUInt uiBufferSize, hlUInt uiMode);
 HLLIB_API hlBool hlPackageOpenProc(hlVoid *pUserData, hlUInt uiMode);
 HLLIB_API hlBool hlPackageOpenStream(HLStream *pStream, hlUInt uiMode);
+HLLIB_API hlBool hlPackageOpenItem(HLDirectoryItem *pItem, hlUInt uiMode);
 HLLIB_API hlVoid hlPackageClose();
 
 HLLIB_API hlBool hlPackageDefragment();
@@ -583,35 +666,51 @@ HLLIB_API hlBool hlWADFileGetImageData(const HLDirectoryItem *pFile, hlUInt *uiW
 #ifdef __cplusplus
 
 #	include <list>
+#	include <map>
+#	include <vector>
 
 namespace HLLib
 {
+	class CMutex;
+
+	class HLLIB_API CDirectoryArena;
+	class HLLIB_API CSearchPattern;
 	class HLLIB_API CDirectoryItem;
 	class HLLIB_API CDirectoryFile;
 	class HLLIB_API CDirectoryFolder;
+	class HLLIB_API CDirectoryIterator;
 
 	namespace Streams
 	{
 		class HLLIB_API IStream;
+		class HLLIB_API CBufferedStream;
 		class HLLIB_API CFileStream;
 		class HLLIB_API CGCFStream;
+		class HLLIB_API CInflateIndex;
+		class HLLIB_API CInflateStream;
 		class HLLIB_API CMappingStream;
 		class HLLIB_API CMemoryStream;
 		class HLLIB_API CNullStream;
 		class HLLIB_API CProcStream;
+
+		class CIOUring;
 	}
 
 	namespace Mapping
 	{
 		class HLLIB_API CView;
-		class HLLIB_API CViewList;
+		class HLLIB_API CViewVector;
+		class HLLIB_API CViewSlotVector;
 		class HLLIB_API CMapping;
 		class HLLIB_API CFileMapping;
 		class HLLIB_API CMemoryMapping;
 		class HLLIB_API CStreamMapping;
+		class HLLIB_API CSubMapping;
 	}
 
-	class HLLIB_API CStreamList;
+	class HLLIB_API CStreamVector;
+	class HLLIB_API CStreamSlotVector;
+	class HLLIB_API CInflateIndexMap;
 	class HLLIB_API CPackage;
 	class HLLIB_API CBSPFile;
 	class HLLIB_API CGCFFile;
@@ -626,14 +725,105 @@ namespace HLLib
 
 namespace HLLib
 {
+	//
+	// CDirectoryArena
+	//
+
+	class HLLIB_API CDirectoryArena
+	{
+	private:
+		struct DirectoryArenaBlock
+		{
+			DirectoryArenaBlock *pNext;
+			hlUInt uiSize;
+		};
+
+		struct DirectoryArenaString
+		{
+			const hlChar *lpString;
+			hlUInt uiHash;
+		};
+
+	private:
+		DirectoryArenaBlock *pBlocks;
+
+		hlByte *lpPointer;
+		hlByte *lpEnd;
+
+		DirectoryArenaString *lpStrings;
+		hlUInt uiStringCount;
+		hlUInt uiStringTableSize;
+
+	public:
+		CDirectoryArena();
+		~CDirectoryArena();
+
+		hlVoid *Allocate(hlUInt uiSize);
+
+		const hlChar *CopyString(const hlChar *lpString);
+		const hlChar *CopyString(const hlChar *lpString, hlUInt uiLength);
+		const hlChar *InternString(const hlChar *lpString);
+
+		hlVoid Release();
+
+	private:
+		hlByte *AllocateBlock(hlUInt uiSize);
+		hlVoid GrowStringTable();
+	};
+
+	//
+	// CSearchPattern
+	//
+
+	class HLLIB_API CSearchPattern
+	{
+	private:
+		struct SearchPatternSegment
+		{
+			hlUInt uiOffset;
+			hlUInt uiLength;
+			hlBool bWildcard;
+		};
+
+	private:
+		hlBool bCaseSensitive;
+
+		hlBool bExact;
+		hlBool bAnchorStart;
+		hlBool bAnchorEnd;
+
+		hlChar *lpPattern;
+		SearchPatternSegment *lpSegments;
+		hlUInt uiSegmentCount;
+
+		hlChar lpPatternBuffer[HL_SEARCH_PATTERN_BUFFER_SIZE];
+		SearchPatternSegment lpSegmentBuffer[HL_SEARCH_PATTERN_SEGMENT_COUNT];
+
+	public:
+		CSearchPattern(const hlChar *lpSearch, HLFindType eFind);
+		~CSearchPattern();
+
+		hlBool Match(const hlChar *lpString) const;
+
+	private:
+		hlBool MatchSegment(const hlChar *lpString, const SearchPatternSegment &Segment) const;
+		const hlChar *FindSegment(const hlChar *lpBegin, const hlChar *lpEnd, const SearchPatternSegment &Segment) const;
+
+		// lpPattern and lpSegments may point into the object itself.
+		CSearchPattern(const CSearchPattern &);
+		CSearchPattern &operator=(const CSearchPattern &);
+	};
+
 	//
 	// CDirectoryItem
 	//
 
 	class HLLIB_API CDirectoryItem
 	{
+		friend class CDirectoryFolder;
+
 	private:
-		hlChar *lpName;
+		const hlChar *lpName;
 		hlUInt uiID;
 		hlVoid *pData;
 		CPackage *pPackage;
@@ -689,6 +879,9 @@ namespace HLLib
 		hlBool CreateStream(Streams::IStream *&pStream) const;
 		hlVoid ReleaseStream(Streams::IStream *pStream) const;
 
+		hlBool MapContents(Mapping::CView *&pView) const;
+		hlVoid UnmapContents(Mapping::CView *pView) const;
+
 		virtual hlBool Extract(const hlChar *lpPath);
 	};
 
@@ -699,20 +892,47 @@ namespace HLLib
 	class HLLIB_API CDirectoryFolder : public CDirectoryItem
 	{
 	private:
-		class CDirectoryItemVector;
+		struct DirectoryItemIndexEntry
+		{
+			hlUInt uiHash;
+			hlUInt uiItem;
+		};
+
+		struct DirectoryPathIndexEntry
+		{
+			hlUInt uiHash;
+			CDirectoryItem *pItem;
+		};
+
+		struct DirectoryPathIndex
+		{
+			DirectoryPathIndexEntry *lpEntries;
+			hlUInt uiSize;
+			hlBool bAmbiguous;
+		};
 
 	private:
-		CDirectoryItemVector *pDirectoryItemVector;
+		CDirectoryArena *pArena;
+		hlBool bDeleteArena;
+
+		CDirectoryItem **lpItems;
+		hlUInt uiItemCount;
+		hlUInt uiItemCapacity;
+
+		DirectoryItemIndexEntry *lpItemIndex;
+		hlUInt uiItemIndexSize;
+
+		DirectoryPathIndex *pPathIndex;
 
 	public:
-		CDirectoryFolder(CPackage *pPackage);
-		CDirectoryFolder(const hlChar *lpName, hlUInt uiID, hlVoid *pData, CPackage *pPackage, CDirectoryFolder *pParent);
+		CDirectoryFolder(CPackage *pPackage, CDirectoryArena *pArena = 0);
+		CDirectoryFolder(const hlChar *lpName, hlUInt uiID, hlVoid *pData, CPackage *pPackage, CDirectoryFolder *pParent, CDirectoryArena *pArena = 0);
 		virtual ~CDirectoryFolder();
 
 		virtual HLDirectoryItemType GetType() const;
 
-		CDirectoryFolder *AddFolder(const hlChar *lpName, hlUInt uiID = HL_ID_INVALID, hlVoid *lpData = 0);
-		CDirectoryFile *AddFile(const hlChar *lpName, hlUInt uiID = HL_ID_INVALID, hlVoid *lpData = 0);
+		CDirectoryFolder *AddFolder(const hlChar *lpName, hlUInt uiID = HL_ID_INVALID, hlVoid *lpData = 0, hlBool bCopyName = hlTrue);
+		CDirectoryFile *AddFile(const hlChar *lpName, hlUInt uiID = HL_ID_INVALID, hlVoid *lpData = 0, hlBool bCopyName = hlTrue);
 
 		hlUInt GetCount() const;
 		CDirectoryItem *GetItem(hlUInt uiIndex);
@@ -724,10 +944,14 @@ namespace HLLib
 
 		hlVoid Sort(HLSortField eField = HL_FIELD_NAME, HLSortOrder eOrder = HL_ORDER_ASCENDING, hlBool bRecurse = hlTrue);
 
+		hlVoid BuildPathIndex();
+
 		CDirectoryItem *FindFirst(const hlChar *lpSearch, HLFindType eFind = HL_FIND_ALL);
 		const CDirectoryItem *FindFirst(const hlChar *lpSearch, HLFindType eFind = HL_FIND_ALL) const;
 		CDirectoryItem *FindNext(const CDirectoryItem *pItem, const hlChar *lpSearch, HLFindType eFind = HL_FIND_ALL);
 		const CDirectoryItem *FindNext(const CDirectoryItem *pItem, const hlChar *lpSearch, HLFindType eFind = HL_FIND_ALL) const;
+		hlUInt FindAll(const hlChar *lpSearch, CDirectoryItem **lpItems, hlUInt uiItemCount, HLFindType eFind = HL_FIND_ALL);
+		hlUInt FindAll(const hlChar *lpSearch, const CDirectoryItem **lpItems, hlUInt uiItemCount, HLFindType eFind = HL_FIND_ALL) const;
 
 		hlUInt GetSize(hlBool bRecurse = hlTrue) const;
 		hlULongLong GetSizeEx(hlBool bRecurse = hlTrue) const;
@@ -739,19 +963,89 @@ namespace HLLib
 		virtual hlBool Extract(const hlChar *lpPath);
 
 	private:
-		hlBool Match(const hlChar *lpString, const hlChar *lpSearch) const;
-		const CDirectoryItem *FindNext(const CDirectoryFolder *pFolder, const CDirectoryItem *pRelative, const hlChar *lpSearch, HLFindType eFind = HL_FIND_ALL) const;
+		hlVoid AddItem(CDirectoryItem *pItem);
+
+		const CDirectoryItem *FindNext(const CDirectoryFolder *pFolder, const CDirectoryItem *pRelative, const CSearchPattern &Pattern, HLFindType eFind) const;
+		hlVoid FindAll(const CSearchPattern &Pattern, HLFindType eFind, const CDirectoryItem **lpItems, hlUInt uiItemCount, hlUInt &uiCount) const;
+
+		hlVoid BuildItemIndex();
+		hlVoid InsertItemIndex(hlUInt uiItem);
+		hlVoid ClearItemIndex();
+		static hlUInt HashName(const hlChar *lpName);
+
+		hlVoid BuildPathIndex(CDirectoryFolder *pFolder, hlUInt uiHash);
+		hlBool GetPathIndexItem(const hlChar *lpPath, HLFindType eFind, const CDirectoryItem *&pItem) const;
+		const CDirectoryItem *GetPathIndexItem(const hlChar **lpSegments, const hlUInt *lpLengths, hlUInt uiSegments, HLFindType eFind) const;
+		hlVoid ClearPathIndex();
+	};
+
+	//
+	// CDirectoryIterator
+	//
+
+	class HLLIB_API CDirectoryIterator
+	{
+	private:
+		struct DirectoryIteratorFrame
+		{
+			const CDirectoryFolder *pFolder;
+			hlUInt uiItem;
+		};
+
+		typedef std::vector<DirectoryIteratorFrame> CDirectoryIteratorFrameVector;
+
+	private:
+		const CDirectoryFolder *pFolder;
+		HLFindType eFind;
+		CSearchPattern *pPattern;
+
+		CDirectoryIteratorFrameVector Frames;
+		hlUInt uiFrame;
+
+		const CDirectoryItem *pItem;
+		const CDirectoryFolder *pDescend;
+
+	public:
+		CDirectoryIterator(const CDirectoryFolder *pFolder, const hlChar *lpSearch = 0, HLFindType eFind = HL_FIND_ALL);
+		~CDirectoryIterator();
+
+		const CDirectoryFolder *GetFolder() const;
+		const CDirectoryItem *GetItem() const;
+
+		const CDirectoryItem *Next();
+		hlVoid SkipSubtree();
+		hlVoid Reset();
+
+	private:
+		hlVoid Push(const CDirectoryFolder *pFolder);
+
+		// Owns pPattern.
+		CDirectoryIterator(const CDirectoryIterator &);
+		CDirectoryIterator &operator=(const CDirectoryIterator &);
 	};
 
 	namespace Streams
 	{
+		//
+		// StreamReadRequest
+		//
+
+		// One range of a batched positional read.
+		typedef HLStreamSegment StreamReadRequest;
+
 		//
 		// IStream
 		//
 
 		class HLLIB_API IStream
 		{
+			friend class HLLib::CPackage;
+
+		private:
+			hlUInt uiSlot;
+
 		public:
+			IStream();
 			virtual ~IStream();
 
 			virtual HLStreamType GetType() const = 0;
@@ -774,6 +1068,86 @@ namespace HLLib
 
 			virtual hlBool Write(hlChar iChar) = 0;
 			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes) = 0;
+
+			// Positional I/O; does not use or move the stream pointer.
+			virtual hlUInt ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			virtual hlUInt WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes);
+
+			// Reads many ranges at once.  Streams that can keep several reads in flight
+			// override this; the default issues them one at a time with ReadAt().
+			virtual hlBool ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount);
+
+			// Scatter reads built on ReadBatch(); segment offsets are relative to the stream
+			// pointer or to uiOffset.  Return the total number of bytes read, 0 if the
+			// batch failed.
+			hlULongLong ReadV(StreamReadRequest *lpSegments, hlUInt uiCount);
+			hlULongLong ReadVAt(hlULongLong uiOffset, StreamReadRequest *lpSegments, hlUInt uiCount);
+
+			// Access pattern hint for a range of the stream; ignored by default.
+			virtual hlVoid Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+		};
+
+		//
+		// CBufferedStream
+		//
+
+		class HLLIB_API CBufferedStream : public IStream
+		{
+		private:
+			IStream *pStream;
+			hlBool bDeleteStream;
+
+			hlULongLong uiPointer;
+
+			hlByte *lpReadBuffer;
+			hlUInt uiReadBufferSize;
+			hlULongLong uiReadBufferOffset;
+			hlUInt uiReadBufferLength;
+
+			hlByte *lpWriteBuffer;
+			hlUInt uiWriteBufferSize;
+			hlULongLong uiWriteBufferOffset;
+			hlUInt uiWriteBufferLength;
+
+		public:
+			CBufferedStream(IStream *pStream, hlBool bDeleteStream, hlUInt uiReadBufferSize = HL_DEFAULT_BUFFERED_STREAM_READ_SIZE, hlUInt uiWriteBufferSize = HL_DEFAULT_BUFFERED_STREAM_WRITE_SIZE);
+			~CBufferedStream();
+
+			virtual HLStreamType GetType() const;
+
+			const IStream &GetStream() const;
+			virtual const hlChar *GetFileName() const;
+
+			virtual hlBool GetOpened() const;
+			virtual hlUInt GetMode() const;
+
+			virtual hlBool Open(hlUInt uiMode);
+			virtual hlVoid Close();
+
+			virtual hlULongLong GetStreamSize() const;
+			virtual hlULongLong GetStreamPointer() const;
+
+			virtual hlULongLong Seek(hlLongLong iOffset, HLSeekMode eSeekMode);
+
+			virtual hlBool Read(hlChar &cChar);
+			virtual hlUInt Read(hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlBool Write(hlChar cChar);
+			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlUInt ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			virtual hlUInt WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlBool ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount);
+
+			virtual hlVoid Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
+			// Writes the write-behind buffer out to the underlying stream.
+			hlBool Flush();
+
+		private:
+			hlUInt ReadBuffered(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			hlBool FillReadBuffer(hlULongLong uiOffset);
 		};
 
 		//
@@ -792,6 +1166,17 @@ namespace HLLib
 
 			hlChar *lpFileName;
 
+			// Only set when opened with HL_MODE_ASYNC_IO and the kernel supports it.
+			CIOUring *pIOUring;
+
+			// Only set when opened with HL_MODE_DIRECT_IO and the file system supports it.
+			// Unaligned reads bounce through the buffer; writes are gathered in it until
+			// whole blocks can be written.
+			hlByte *lpDirectBuffer;
+			hlUInt uiDirectAlignment;
+			hlULongLong uiDirectBufferOffset;
+			hlUInt uiDirectBufferLength;
+
 		public:
 			CFileStream(const hlChar *lpFileName);
 			~CFileStream();
@@ -800,6 +1185,9 @@ namespace HLLib
 
 			virtual const hlChar *GetFileName() const;
 
+			const hlVoid *GetBuffer() const;
+			hlULongLong GetBufferSize() const;
+
 			virtual hlBool GetOpened() const;
 			virtual hlUInt GetMode() const;
 
@@ -816,6 +1204,26 @@ namespace HLLib
 
 			virtual hlBool Write(hlChar iChar);
 			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes);
+
+			// On Windows these pass the offset in an OVERLAPPED, which still leaves the file
+			// pointer after the range; Seek() before going back to Read() or Write().
+			virtual hlUInt ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			virtual hlUInt WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlBool ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount);
+
+			virtual hlVoid Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
+		private:
+			hlBool OpenDirect();
+			hlBool CloseDirect();
+
+			hlUInt ReadDirect(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			hlUInt WriteDirect(const hlVoid *lpData, hlUInt uiBytes);
+
+			hlBool ReadVector(StreamReadRequest *lpRequests, hlUInt uiCount);
+			hlBool FlushDirect();
+			hlVoid SyncDirect();
 		};
 
 		//
@@ -844,6 +1252,8 @@ namespace HLLib
 			CGCFStream(CGCFFile &GCFFile, hlUInt uiFileID);
 			~CGCFStream();
 
+			hlVoid Reset(hlUInt uiFileID);
+
 			virtual HLStreamType GetType() const;
 
 			const CGCFFile &GetPackage() const;
@@ -866,10 +1276,113 @@ namespace HLLib
 			virtual hlBool Write(hlChar iChar);
 			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes);
 
+			virtual hlBool ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount);
+
+			virtual hlVoid Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
 		private:
 			hlBool Map(hlUInt uiPointer);
 		};
 
+		//
+		// CInflateIndex
+		//
+
+		class HLLIB_API CInflateIndex
+		{
+		public:
+			struct InflateCheckpoint
+			{
+				hlULongLong uiOutputOffset;
+				hlULongLong uiInputOffset;
+				hlUInt uiBits;
+				hlUInt uiWindowSize;
+				hlByte lpWindow[HL_INFLATE_WINDOW_SIZE];
+			};
+
+			typedef std::vector<InflateCheckpoint *> CInflateCheckpointVector;
+
+		private:
+			CInflateCheckpointVector Checkpoints;
+
+		public:
+			CInflateIndex();
+			~CInflateIndex();
+
+			hlUInt GetCount() const;
+
+			const InflateCheckpoint *Find(hlULongLong uiOutputOffset) const;
+			const InflateCheckpoint *GetLast() const;
+
+			// Returns 0 if the checkpoint doesn't fit in HL_MAPPING_MEMORY_BUDGET.
+			InflateCheckpoint *Add();
+		};
+
+		//
+		// CInflateStream
+		//
+
+		class HLLIB_API CInflateStream : public IStream
+		{
+		private:
+			IStream *pStream;
+			hlBool bDeleteStream;
+			hlBool bRaw;
+
+			CInflateIndex *pIndex;
+
+			hlBool bOpened;
+			hlUInt uiMode;
+
+			hlVoid *pZStream;
+			hlBool bStreamEnd;
+
+			hlByte *lpInputBuffer;
+			hlByte *lpOutputBuffer;
+			hlUInt uiBufferSize;
+
+			hlULongLong uiInputOffset;
+
+			hlULongLong uiOutputOffset;
+			hlUInt uiOutputLength;
+
+			hlULongLong uiPointer;
+			hlULongLong uiLength;
+
+		public:
+			CInflateStream(IStream *pStream, hlBool bDeleteStream, hlULongLong uiLength, hlBool bRaw, CInflateIndex *pIndex = 0, hlUInt uiBufferSize = HL_DEFAULT_INFLATE_STREAM_BUFFER_SIZE);
+			~CInflateStream();
+
+			virtual HLStreamType GetType() const;
+
+			const IStream &GetStream() const;
+			virtual const hlChar *GetFileName() const;
+
+			virtual hlBool GetOpened() const;
+			virtual hlUInt GetMode() const;
+
+			virtual hlBool Open(hlUInt uiMode);
+			virtual hlVoid Close();
+
+			virtual hlULongLong GetStreamSize() const;
+			virtual hlULongLong GetStreamPointer() const;
+
+			virtual hlULongLong Seek(hlLongLong iOffset, HLSeekMode eSeekMode);
+
+			virtual hlBool Read(hlChar &cChar);
+			virtual hlUInt Read(hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlBool Write(hlChar cChar);
+			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlVoid Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
+		private:
+			hlBool Reset();
+			hlBool Restore(const CInflateIndex::InflateCheckpoint &Checkpoint);
+			hlBool Inflate();
+		};
+
 		//
 		// CMappingStream
 		//
@@ -880,7 +1393,7 @@ namespace HLLib
 			hlBool bOpened;
 			hlUInt uiMode;
 
-			Mapping::CMapping &Mapping;
+			Mapping::CMapping *pMapping;
 			Mapping::CView *pView;
 
 			hlULongLong uiMappingOffset;
@@ -894,6 +1407,8 @@ namespace HLLib
 			CMappingStream(Mapping::CMapping &Mapping, hlULongLong uiMappingOffset, hlULongLong uiMappingSize, hlULongLong uiViewSize = HL_DEFAULT_VIEW_SIZE);
 			~CMappingStream();
 
+			hlVoid Reset(Mapping::CMapping &Mapping, hlULongLong uiMappingOffset, hlULongLong uiMappingSize, hlULongLong uiViewSize = HL_DEFAULT_VIEW_SIZE);
+
 			virtual HLStreamType GetType() const;
 
 			const Mapping::CMapping &GetMapping() const;
@@ -916,6 +1431,13 @@ namespace HLLib
 			virtual hlBool Write(hlChar iChar);
 			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes);
 
+			virtual hlUInt ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			virtual hlUInt WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlBool ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount);
+
+			virtual hlVoid Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
 		private:
 			hlBool Map(hlULongLong uiPointer);
 		};
@@ -940,6 +1462,8 @@ namespace HLLib
 			CMemoryStream(hlVoid *lpData, hlUInt uiBufferSize);
 			~CMemoryStream();
 
+			hlVoid Reset(hlVoid *lpData, hlULongLong uiBufferSize);
+
 			virtual HLStreamType GetType() const;
 
 			const hlVoid *GetBuffer() const;
@@ -962,6 +1486,9 @@ namespace HLLib
 
 			virtual hlBool Write(hlChar iChar);
 			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlUInt ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			virtual hlUInt WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes);
 		};
 
 		//
@@ -1012,6 +1539,9 @@ namespace HLLib
 
 			hlVoid *pUserData;
 
+			const hlVoid *lpData;
+			hlULongLong uiBufferSize;
+
 		public:
 			CProcStream(hlVoid *pUserData);
 			~CProcStream();
@@ -1020,6 +1550,12 @@ namespace HLLib
 
 			virtual const hlChar *GetFileName() const;
 
+			// The data of a memory resident backend (see HL_PROC_GET_POINTER) or 0.
+			// The buffer is the whole stream, so its size is the stream size; a
+			// backend without a size proc isn't treated as memory resident.
+			const hlVoid *GetBuffer() const;
+			hlULongLong GetBufferSize() const;
+
 			virtual hlBool GetOpened() const;
 			virtual hlUInt GetMode() const;
 
@@ -1036,6 +1572,11 @@ namespace HLLib
 
 			virtual hlBool Write(hlChar iChar);
 			virtual hlUInt Write(const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlUInt ReadAt(hlULongLong uiOffset, hlVoid *lpData, hlUInt uiBytes);
+			virtual hlUInt WriteAt(hlULongLong uiOffset, const hlVoid *lpData, hlUInt uiBytes);
+
+			virtual hlBool ReadBatch(StreamReadRequest *lpRequests, hlUInt uiCount);
 		};
 	}
 
@@ -1048,6 +1589,7 @@ namespace HLLib
 		class HLLIB_API CView
 		{
 			friend class CMapping;
+			friend class HLLib::CPackage;
 
 		private:
 			CMapping *pMapping;
@@ -1058,6 +1600,13 @@ namespace HLLib
 			hlULongLong uiAllocationOffset;
 			hlULongLong uiAllocationLength;
 
+			// Index of the view in its mapping's registry.
+			hlUInt uiSlot;
+
+			// Index of the view in its package's registry, if it was handed out by
+			// CPackage::MapContents().
+			hlUInt uiPackageSlot;
+
 		public:
 			CView(CMapping *pMapping, hlVoid *lpView, hlULongLong uiAllocationOffset, hlULongLong uiAllocationLength, hlULongLong uiOffset = 0, hlULongLong uiLength = 0);
 			~CView();
@@ -1072,6 +1621,14 @@ namespace HLLib
 			hlULongLong GetAllocationLength() const;
 		};
 
+		struct MappingCacheEntry
+		{
+			CMapping *pMapping;
+			hlVoid *pItem;
+		};
+
+		typedef std::list<MappingCacheEntry> CMappingCacheList;
+
 		//
 		// CMapping
 		//
@@ -1079,7 +1636,19 @@ namespace HLLib
 		class HLLIB_API CMapping
 		{
 		private:
-			CViewList *pViews;
+			// Live views by slot; unused slots are null and listed in pFreeSlots.
+			CViewVector *pViews;
+			CViewSlotVector *pFreeSlots;
+
+			hlUInt uiTotalAllocations;
+			hlULongLong uiTotalMemoryAllocated;
+			hlULongLong uiTotalMemoryUsed;
+			hlULongLong uiEvictions;
+
+		protected:
+			// Guards the views and anything a mapping shares between them, so views
+			// may be mapped and unmapped from several threads at once.
+			CMutex *pMutex;
 
 		public:
 			CMapping();
@@ -1095,6 +1664,15 @@ namespace HLLib
 			hlUInt GetTotalAllocations() const;
 			hlULongLong GetTotalMemoryAllocated() const;
 			hlULongLong GetTotalMemoryUsed() const;
+			hlULongLong GetEvictions() const;
+
+			// Memory held by all mappings in the process, and the budget it is held to.
+			static hlULongLong GetGlobalMemoryUsed();
+			static hlVoid EnforceMemoryBudget();
+
+			// Count memory held on behalf of mappings, such as inflate checkpoints, against the budget.
+			static hlVoid AllocateMemory(hlULongLong uiLength);
+			static hlVoid FreeMemory(hlULongLong uiLength);
 
 			hlBool Open(hlUInt uiMode);
 			hlVoid Close();
@@ -1107,6 +1685,14 @@ namespace HLLib
 			hlBool Commit(CView &View);
 			hlBool Commit(CView &View, hlULongLong uiOffset, hlULongLong uiLength);
 
+			// Tell the operating system how a range of the mapping is about to be accessed.
+			hlBool Advise(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
+		protected:
+			CMappingCacheList::iterator InsertCacheEntry(hlVoid *pItem);
+			hlVoid TouchCacheEntry(CMappingCacheList::iterator Position);
+			hlVoid RemoveCacheEntry(CMappingCacheList::iterator Position);
+
 		private:
 			virtual hlBool OpenInternal(hlUInt uiMode) = 0;
 			virtual hlVoid CloseInternal() = 0;
@@ -1115,6 +1701,10 @@ namespace HLLib
 			virtual hlVoid UnmapInternal(CView &View);
 
 			virtual hlBool CommitInternal(CView &View, hlULongLong uiOffset, hlULongLong uiLength);
+
+			virtual hlVoid AdviseInternal(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
+			virtual hlVoid EvictInternal(hlVoid *pItem);
 		};
 
 		//
@@ -1124,6 +1714,22 @@ namespace HLLib
 		class HLLIB_API CFileMapping : public CMapping
 		{
 		private:
+			struct FileMappingWindow;
+
+			typedef std::list<FileMappingWindow *> CFileMappingWindowList;
+			typedef std::map<hlULongLong, FileMappingWindow *> CFileMappingWindowMap;
+
+			struct FileMappingWindow
+			{
+				hlULongLong uiIndex;
+				hlVoid *lpView;
+				hlULongLong uiLength;
+				hlUInt uiReferences;
+				CFileMappingWindowList::iterator Position;
+				CMappingCacheList::iterator CachePosition;
+			};
+
+		private:
 #ifdef _WIN32
 			HANDLE hFile;
 			HANDLE hFileMapping;
@@ -1138,6 +1744,10 @@ namespace HLLib
 
 			hlChar *lpFileName;
 
+			// Large shared windows that views are carved out of.
+			CFileMappingWindowList *pWindowList;
+			CFileMappingWindowMap *pWindowMap;
+
 		public:
 			CFileMapping(const hlChar *lpFileName);
 			virtual ~CFileMapping();
@@ -1157,6 +1767,18 @@ namespace HLLib
 
 			virtual hlBool MapInternal(CView *&pView, hlULongLong uiOffset, hlULongLong uiLength);
 			virtual hlVoid UnmapInternal(CView &View);
+
+			virtual hlVoid AdviseInternal(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
+			virtual hlVoid EvictInternal(hlVoid *pItem);
+
+			hlVoid *MapFile(hlULongLong uiOffset, hlULongLong uiLength);
+			hlVoid UnmapFile(hlVoid *lpView, hlULongLong uiLength);
+
+			FileMappingWindow *GetWindow(hlULongLong uiIndex, hlULongLong uiMappingSize);
+			hlVoid EvictWindows();
+			hlVoid EvictWindow(FileMappingWindow *pWindow);
+			hlVoid ClearWindows();
 		};
 
 		//
@@ -1199,9 +1821,37 @@ namespace HLLib
 
 		class HLLIB_API CStreamMapping : public CMapping
 		{
+		private:
+			struct StreamMappingBlock;
+
+			typedef std::list<StreamMappingBlock *> CStreamMappingBlockList;
+			typedef std::map<hlULongLong, StreamMappingBlock *> CStreamMappingBlockMap;
+
+			struct StreamMappingBlock
+			{
+				hlULongLong uiIndex;
+				hlByte *lpData;
+				hlUInt uiLength;
+				hlUInt uiReferences;
+				CStreamMappingBlockList::iterator Position;
+				CMappingCacheList::iterator CachePosition;
+			};
+
 		private:
 			Streams::IStream &Stream;
 
+			// Block cache, only used in read-only, non-volatile mode.  Guarded by pMutex.
+			hlULongLong uiCacheSize;
+			hlULongLong uiCacheUsed;
+			hlULongLong uiCacheHits;
+			hlULongLong uiCacheMisses;
+			CStreamMappingBlockList *pCacheBlockList;
+			CStreamMappingBlockMap *pCacheBlockMap;
+
+			// Range last declared sequential; misses inside it read ahead in a batch.
+			hlULongLong uiReadAheadOffset;
+			hlULongLong uiReadAheadEnd;
+
 		public:
 			CStreamMapping(Streams::IStream &Stream);
 			virtual ~CStreamMapping();
@@ -1216,6 +1866,10 @@ namespace HLLib
 
 			virtual hlULongLong GetMappingSize() const;
 
+			hlULongLong GetCacheMemoryUsed() const;
+			hlULongLong GetCacheHits() const;
+			hlULongLong GetCacheMisses() const;
+
 		private:
 			virtual hlBool OpenInternal(hlUInt uiMode);
 			virtual hlVoid CloseInternal();
@@ -1223,7 +1877,61 @@ namespace HLLib
 			virtual hlBool MapInternal(CView *&pView, hlULongLong uiOffset, hlULongLong uiLength);
 			virtual hlVoid UnmapInternal(CView &View);
 
+			virtual hlVoid AdviseInternal(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
+
 			virtual hlBool CommitInternal(CView &View, hlULongLong uiOffset, hlULongLong uiLength);
+
+			virtual hlVoid EvictInternal(hlVoid *pItem);
+
+			StreamMappingBlock *GetBlock(hlULongLong uiIndex, hlULongLong uiMappingSize);
+			StreamMappingBlock *InsertBlock(hlULongLong uiIndex, hlByte *lpData, hlUInt uiLength);
+			hlVoid FetchBlocks(hlULongLong uiFirstBlock, hlULongLong uiLastBlock, hlULongLong uiMappingSize);
+			hlVoid EvictBlocks();
+			hlVoid EvictBlock(StreamMappingBlock *pBlock);
+			hlVoid ClearCache();
+		};
+
+		//
+		// CSubMapping
+		//
+
+		class HLLIB_API CSubMapping : public CMapping
+		{
+		private:
+			typedef std::map<const CView *, CView *> CSubViewMap;
+
+		private:
+			hlBool bOpened;
+			hlUInt uiMode;
+
+			CMapping &Mapping;
+			hlULongLong uiMappingOffset;
+			hlULongLong uiMappingSize;
+
+			CSubViewMap *pSubViews;
+
+		public:
+			CSubMapping(CMapping &Mapping, hlULongLong uiMappingOffset, hlULongLong uiMappingSize);
+			virtual ~CSubMapping();
+
+			virtual HLMappingType GetType() const;
+
+			const CMapping &GetMapping() const;
+			hlULongLong GetMappingOffset() const;
+
+			virtual hlBool GetOpened() const;
+			virtual hlUInt GetMode() const;
+
+			virtual hlULongLong GetMappingSize() const;
+
+		private:
+			virtual hlBool OpenInternal(hlUInt uiMode);
+			virtual hlVoid CloseInternal();
+
+			virtual hlBool MapInternal(CView *&pView, hlULongLong uiOffset, hlULongLong uiLength);
+			virtual hlVoid UnmapInternal(CView &View);
+
+			virtual hlVoid AdviseInternal(hlULongLong uiOffset, hlULongLong uiLength, HLAccessHint eHint);
 		};
 	}
 
@@ -1231,12 +1939,15 @@ namespace HLLib
 	// CPackage
 	//
 
+	#define HL_PACKAGE_STREAM_POOL_COUNT 4
+
 	class HLLIB_API CPackage
 	{
 	private:
 		hlBool bDeleteStream;
 		hlBool bDeleteMapping;
 		Streams::IStream *pStream;
+		const CPackage *pStreamPackage;
 
 	protected:
 		Mapping::CMapping *pMapping;
@@ -1244,7 +1955,16 @@ namespace HLLib
 		CDirectoryFolder *pRoot;
 
 	private:
-		CStreamList *pStreams;
+		CDirectoryArena *pDirectoryArena;
+
+		CStreamVector *pStreams;
+		CStreamSlotVector *pFreeStreamSlots;
+
+		CStreamVector *lpStreamPools[HL_PACKAGE_STREAM_POOL_COUNT];
+
+		Mapping::CViewVector *pViews;
+		Mapping::CViewSlotVector *pFreeViewSlots;
+		CInflateIndexMap *pInflateIndices;
 
 	public:
 		CPackage();
@@ -1261,6 +1981,7 @@ namespace HLLib
 		hlBool Open(const hlChar *lpFileName, hlUInt uiMode);
 		hlBool Open(hlVoid *lpData, hlUInt uiBufferSize, hlUInt uiMode);
 		hlBool Open(hlVoid *pUserData, hlUInt uiMode);
+		hlBool Open(const CDirectoryFile &File, hlUInt uiMode);
 		hlVoid Close();
 
 		hlBool Defragment();
@@ -1285,6 +2006,9 @@ namespace HLLib
 		hlBool CreateStream(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
 		hlVoid ReleaseStream(Streams::IStream *pStream) const;
 
+		hlBool MapContents(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
+		hlVoid UnmapContents(Mapping::CView *pView) const;
+
 	protected:
 		virtual hlBool MapDataStructures() = 0;
 		virtual hlVoid UnmapDataStructures() = 0;
@@ -1310,9 +2034,23 @@ namespace HLLib
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const = 0;
 		virtual hlVoid ReleaseStreamInternal(Streams::IStream &Stream) const;
 
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
+
+		Streams::CInflateIndex *GetInflateIndex(hlULongLong uiOffset, hlULongLong uiLength) const;
+
+		Streams::IStream *CreateMappingStream(Mapping::CMapping &Mapping, hlULongLong uiMappingOffset, hlULongLong uiMappingSize) const;
+		Streams::IStream *CreateMemoryStream(hlVoid *lpData, hlULongLong uiBufferSize) const;
+		Streams::IStream *CreateNullStream() const;
+
+		Streams::IStream *GetPooledStream(HLStreamType eType) const;
+
+		CDirectoryArena &GetDirectoryArena();
+
 	private:
 		hlBool Open(Streams::IStream *pStream, hlUInt uiMode, hlBool bDeleteStream);
 		hlBool Open(Mapping::CMapping *pMapping, hlUInt uiMode, hlBool bDeleteMapping);
+
+		hlVoid DeleteStream(Streams::IStream *pStream) const;
 	};
 
 	//
@@ -1392,6 +2130,8 @@ namespace HLLib
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
 		virtual hlVoid ReleaseStreamInternal(Streams::IStream &Stream) const;
 
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
+
 	private:
 		hlVoid GetFileName(hlChar *lpBuffer, hlUInt uiBufferSize);
 
@@ -1579,6 +2319,20 @@ namespace HLLib
 
 		#pragma pack()
 
+		//
+		// One entry per data block of a file, in file order, so that a stream can
+		// binary search for the block holding any offset.
+		//
+		struct GCFBlockIndexEntry
+		{
+			hlULongLong uiOffset;				// Offset of the data block in the file.
+			hlULongLong uiBlockEntryOffset;		// Offset of the data block's block entry in the file.
+			hlUInt uiBlockEntryIndex;
+			hlUInt uiDataBlockIndex;
+		};
+
+		typedef std::vector<GCFBlockIndexEntry> GCFBlockIndex;
+
 	private:
 		static const char *lpAttributeNames[];
 		static const char *lpItemAttributeNames[];
@@ -1617,6 +2371,8 @@ namespace HLLib
 
 		CDirectoryItem **lpDirectoryItems;
 
+		mutable GCFBlockIndex **lpBlockIndices;
+
 	public:
 		CGCFFile();
 		virtual ~CGCFFile();
@@ -1648,10 +2404,15 @@ namespace HLLib
 
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
 
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
+
 	private:
 		hlVoid CreateRoot(CDirectoryFolder *pFolder);
 
 		hlVoid GetItemFragmentation(hlUInt uiDirectoryItemIndex, hlUInt &uiBlocksFragmented, hlUInt &uiBlocksUsed) const;
+
+		const GCFBlockIndex &GetBlockIndex(hlUInt uiDirectoryItemIndex) const;
+		hlVoid FreeBlockIndices();
 	};
 
 	//
@@ -1879,6 +2640,8 @@ namespace HLLib
 		virtual hlBool GetFileSizeOnDiskInternal(const CDirectoryFile *pFile, hlUInt &uiSize) const;
 
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
+
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
 	};
 
 	//
@@ -2023,7 +2786,8 @@ namespace HLLib
 			virtual hlBool GetFileSizeOnDiskInternal(const CDirectoryFile *pFile, hlUInt &uiSize) const = 0;
 
 			virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const = 0;
-			virtual hlVoid ReleaseStreamInternal(Streams::IStream &Stream) const = 0;
+
+			virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const = 0;
 		};
 
 		// Specialization SGAFile7 and up where the CRC moved to the header and the CRC is of the compressed data and there are stronger hashes.
@@ -2139,7 +2903,8 @@ namespace HLLib
 			virtual hlBool GetFileSizeOnDiskInternal(const CDirectoryFile *pFile, hlUInt &uiSize) const;
 
 			virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
-			virtual hlVoid ReleaseStreamInternal(Streams::IStream &Stream) const;
+
+			virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
 
 		private:
 			hlVoid CreateFolder(CDirectoryFolder *pParent, hlUInt uiFolderIndex);
@@ -2193,7 +2958,8 @@ namespace HLLib
 		virtual hlBool GetFileSizeOnDiskInternal(const CDirectoryFile *pFile, hlUInt &uiSize) const;
 
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
-		virtual hlVoid ReleaseStreamInternal(Streams::IStream &Stream) const;
+
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
 	};
 
 	//
@@ -2320,6 +3086,8 @@ namespace HLLib
 
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
 
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
+
 	private:
 		hlVoid GetFileName(hlChar *lpBuffer, hlUInt uiBufferSize);
 	};
@@ -2389,7 +3157,7 @@ namespace HLLib
 			const hlVoid *lpPreloadData;
 		};
 
-		typedef std::list<VPKDirectoryItem *> CDirectoryItemList;
+		typedef std::vector<VPKDirectoryItem *> CDirectoryItemList;
 
 	private:
 		static const char *lpAttributeNames[];
@@ -2435,6 +3203,8 @@ namespace HLLib
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
 		virtual hlVoid ReleaseStreamInternal(Streams::IStream &Stream) const;
 
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
+
 	private:
 		hlBool MapString(const hlChar *&lpViewData, const hlChar *lpViewDirectoryDataEnd, const hlChar *&lpString);
 	};
@@ -2618,6 +3388,8 @@ namespace HLLib
 		virtual hlBool GetFileSizeOnDiskInternal(const CDirectoryFile *pFile, hlUInt &uiSize) const;
 
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
+
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
 	};
 
 	//
@@ -2723,6 +3495,8 @@ namespace HLLib
 		virtual hlBool GetFileSizeOnDiskInternal(const CDirectoryFile *pFile, hlUInt &uiSize) const;
 
 		virtual hlBool CreateStreamInternal(const CDirectoryFile *pFile, Streams::IStream *&pStream) const;
+
+		virtual hlBool MapContentsInternal(const CDirectoryFile *pFile, Mapping::CView *&pView) const;
 	};
 }
 #endif